@@ -0,0 +1,24 @@
+# Benchmarks count heap allocations by wrapping the allocator
+BENCH_LDFLAGS = -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+
+../bench/bench.o: ../bench/bench.h $(HEADERS)
+
+../bench/serialbench.o: ../bench/bench.h $(HEADERS) $(LIB)
+serialbench: ../bench/serialbench.o ../bench/bench.o $(LIB)
+	$(CC) $(CFLAGS) $(BENCH_LDFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)
+
+../bench/llrpbench.o: ../bench/bench.h $(HEADERS) $(LIB)
+llrpbench: ../bench/llrpbench.o ../bench/bench.o $(LIB)
+	$(CC) $(CFLAGS) $(BENCH_LDFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)
+
+../bench/queuebench.o: ../bench/bench.h $(HEADERS) $(LIB)
+queuebench: ../bench/queuebench.o ../bench/bench.o $(LIB)
+	$(CC) $(CFLAGS) $(BENCH_LDFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)
+
+../bench/dedupbench.o: ../bench/bench.h $(HEADERS) $(LIB)
+dedupbench: ../bench/dedupbench.o ../bench/bench.o $(LIB)
+	$(CC) $(CFLAGS) $(BENCH_LDFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)
+
+../bench/crcbench.o: ../bench/bench.h $(HEADERS) $(LIB)
+crcbench: ../bench/crcbench.o ../bench/bench.o $(LIB)
+	$(CC) $(CFLAGS) $(BENCH_LDFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)
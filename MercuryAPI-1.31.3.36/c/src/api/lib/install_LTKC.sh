@@ -44,6 +44,10 @@ patch -p0 -d ${INSTALL_DIR} < ${PATCH_DIR}/llrp_shared_lib.patch
 patch -p0 -d ${INSTALL_DIR} < ${PATCH_DIR}/llrp_ltkc_add_custom_access_command_opspec.patch
 patch -p0 -d ${INSTALL_DIR} < ${PATCH_DIR}/llrp_ltkc_add_loopSpec_ROSpec.patch
 patch -p0 -d ${INSTALL_DIR} < ${PATCH_DIR}/llrp_ltk_shared_libs.patch
+#Apply patch that lets a connection decode each received message into a single arena
+patch -p0 -d ${INSTALL_DIR} < ${PATCH_DIR}/llrp_ltkc_message_arena.patch
+#Apply patch that lets a connection keep chosen frames undecoded
+patch -p0 -d ${INSTALL_DIR} < ${PATCH_DIR}/llrp_ltkc_raw_frame.patch
 #Apply patch that provides specific error messages related to read function. This doesnt cover any additional functionality.
 #patch -p0 -d ${INSTALL_DIR} < ${PATCH_DIR}/llrp_ltkc_read_specific_errors.patch
 
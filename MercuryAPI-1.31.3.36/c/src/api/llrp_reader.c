@@ -211,6 +211,8 @@ TMR_LLRP_boot(TMR_Reader *reader)
   BITSET(lr->paramPresent, TMR_PARAM_READ_PLAN);
   BITSET(lr->paramPresent, TMR_PARAM_URI);
   BITSET(lr->paramPresent, TMR_PARAM_TRANSPORTTIMEOUT);
+  BITSET(lr->paramPresent, TMR_PARAM_TRANSPORT_TRACE_RAW);
+  BITSET(lr->paramPresent, TMR_PARAM_READER_METRICS);
   BITSET(lr->paramPresent, TMR_PARAM_COMMANDTIMEOUT);
   BITSET(lr->paramPresent, TMR_PARAM_GPIO_INPUTLIST);
   BITSET(lr->paramPresent, TMR_PARAM_GPIO_OUTPUTLIST);
@@ -261,6 +263,12 @@ TMR_LLRP_boot(TMR_Reader *reader)
   BITSET(lr->paramPresent, TMR_PARAM_REGULATORY_ENABLE);
   BITSET(lr->paramPresent, TMR_PARAM_REGION_HOPTABLE);
   BITSET(lr->paramPresent, TMR_PARAM_READ_ASYNCONTIME);
+#ifdef TMR_ENABLE_BACKGROUND_READS
+  BITSET(lr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_DEPTH);
+  BITSET(lr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_POLICY);
+  BITSET(lr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_HIGHWATER);
+  BITSET(lr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_DROPS);
+#endif
   BITSET(lr->paramPresent, TMR_PARAM_ANTENNA_RETURNLOSS);
   BITSET(lr->paramPresent, TMR_PARAM_METADATAFLAG);
   BITSET(lr->paramPresent, TMR_PARAM_READER_STATS_ENABLE);
@@ -337,6 +345,11 @@ TMR_LLRP_paramProbe(struct TMR_Reader *reader, TMR_Param key)
   lr = &reader->u.llrpReader;
 
   ret = TMR_paramGet(reader, key, &buf);
+  if (TMR_ERROR_BATCH_ABORTED == ret)
+  {
+    /* Never asked: says nothing about the parameter */
+    return;
+  }
   if (TMR_SUCCESS == ret)
   {
     BITSET(lr->paramPresent, key);
@@ -1951,7 +1964,8 @@ TMR_LLRP_paramGet(struct TMR_Reader *reader, TMR_Param key, void *value)
       ret = TMR_ERROR_NOT_FOUND;
   }
 
-  if (0 == BITGET(lr->paramConfirmed, key))
+  /* An aborted batch never asked the reader */
+  if ((0 == BITGET(lr->paramConfirmed, key)) && (TMR_ERROR_BATCH_ABORTED != ret))
   {
     if (TMR_SUCCESS == ret)
     {
@@ -1994,6 +2008,8 @@ TMR_LLRP_LlrpReader_init(TMR_Reader *reader)
   reader->destroy     = TMR_LLRP_destroy;
   reader->paramSet    = TMR_LLRP_paramSet;
   reader->paramGet    = TMR_LLRP_paramGet;
+  reader->paramBatchFlush = TMR_LLRP_flushParamBatch;
+  reader->batchOps    = NULL;
   reader->read        = TMR_LLRP_read;
   reader->hasMoreTags = TMR_LLRP_hasMoreTags;
   reader->getNextTag  = TMR_LLRP_getNextTag;
@@ -2048,6 +2064,9 @@ TMR_LLRP_LlrpReader_init(TMR_Reader *reader)
   reader->u.llrpReader.receiverEnabled = false;
   reader->u.llrpReader.numOfROSpecEvents = 0;
   reader->u.llrpReader.bufResponse = NULL;
+  reader->u.llrpReader.bufSize = 0;
+  reader->u.llrpReader.bufPointer = 0;
+  reader->u.llrpReader.bufIndex = 0;
 
   /* Initialize llrp transmitter thread params */
   pthread_mutex_init(&reader->u.llrpReader.transmitterLock, NULL);
@@ -2060,6 +2079,17 @@ TMR_LLRP_LlrpReader_init(TMR_Reader *reader)
   reader->u.llrpReader.reportReceived = false;
   reader->u.llrpReader.isResponsePending = false;
   reader->u.llrpReader.threadCancel = false;
+  reader->u.llrpReader.roSpecCached = false;
+  reader->u.llrpReader.cachedROSpec = NULL;
+  reader->u.llrpReader.cachedROSpecLength = 0;
+  reader->u.llrpReader.roSpecReuseAllowed = false;
+  reader->u.llrpReader.roSpecReused = false;
+  reader->u.llrpReader.batchConfig = NULL;
+  reader->u.llrpReader.batchConfigOpCount = 0;
+#if !defined(WIN32) && !defined(WINCE)
+  reader->u.llrpReader.receiverWake[0] = -1;
+  reader->u.llrpReader.receiverWake[1] = -1;
+#endif
   return TMR_reader_init_internal(reader);
 }
 
@@ -2224,6 +2254,8 @@ TMR_LLRP_connect(TMR_Reader *reader)
     return TMR_ERROR_INVALID;
   }
   ret = TMR_SUCCESS;
+  /* Whatever ROSpecs the reader holds, they are not ones we installed */
+  reader->u.llrpReader.roSpecCached = false;
   /*
    * Construct a connection (LLRP_tSConnection).
    * Using a 32kb max frame size for send/recv.
@@ -2236,6 +2268,10 @@ TMR_LLRP_connect(TMR_Reader *reader)
     sprintf(reader->u.llrpReader.errMsg, "Error: Connection initialization failed");
     return TMR_ERROR_LLRP_CONNECTIONFAILED;
   }
+  LLRP_Conn_setDecodeArena(reader->u.llrpReader.pConn, TMR_LLRP_DECODE_ARENA);
+#if TMR_LLRP_FAST_REPORT_DECODE
+  LLRP_Conn_setRawFrameFilter(reader->u.llrpReader.pConn, TMR_LLRP_isPlainTagReport, NULL);
+#endif
 
   /*
    * Open the connection to the reader
@@ -2335,7 +2371,6 @@ TMR_Status
 TMR_LLRP_destroy(TMR_Reader *reader)
 {
   LLRP_tSMessage *pRspMsg = NULL;
-  uint8_t i;
 
   if (NULL == reader)
   {
@@ -2368,10 +2403,20 @@ TMR_LLRP_destroy(TMR_Reader *reader)
   reader->u.llrpReader.receiverEnabled = true;
   pthread_cond_broadcast(&reader->u.llrpReader.receiverCond);
   pthread_mutex_unlock(&reader->u.llrpReader.receiverLock);
+  TMR_LLRP_wakeBackgroundReceiver(reader);
 
   /** wait for the thread to exit */
   pthread_join(reader->u.llrpReader.llrpReceiver, NULL);
   reader->u.llrpReader.threadCancel = false;
+#if !defined(WIN32) && !defined(WINCE)
+  if (-1 != reader->u.llrpReader.receiverWake[0])
+  {
+    close(reader->u.llrpReader.receiverWake[0]);
+    close(reader->u.llrpReader.receiverWake[1]);
+    reader->u.llrpReader.receiverWake[0] = -1;
+    reader->u.llrpReader.receiverWake[1] = -1;
+  }
+#endif
 
   pthread_mutex_lock(&reader->u.llrpReader.receiverLock);
   if (true == reader->u.llrpReader.receiverSetup)
@@ -2394,12 +2439,10 @@ TMR_LLRP_destroy(TMR_Reader *reader)
   if (NULL != reader->u.llrpReader.bufResponse)
   {
     /* free this before leaking the memory */
-    for (i = 0; i < reader->u.llrpReader.bufPointer; i++)
-    {
-      TMR_LLRP_freeMessage(reader->u.llrpReader.bufResponse[i]);
-    }
+    TMR_LLRP_resetReportBuffer(reader);
     free(reader->u.llrpReader.bufResponse);
     reader->u.llrpReader.bufResponse=NULL;
+    reader->u.llrpReader.bufSize = 0;
   }
 
   if (true == reader->connected)
@@ -2430,6 +2473,9 @@ TMR_LLRP_destroy(TMR_Reader *reader)
     LLRP_Conn_destruct(reader->u.llrpReader.pConn);
     reader->u.llrpReader.pConn=NULL;
   }
+  free(reader->u.llrpReader.cachedROSpec);
+  reader->u.llrpReader.cachedROSpec = NULL;
+  reader->u.llrpReader.roSpecCached = false;
   if (NULL != reader->u.llrpReader.pTypeRegistry)
   {
     LLRP_TypeRegistry_destruct(reader->u.llrpReader.pTypeRegistry);
@@ -2577,12 +2623,20 @@ TMR_LLRP_read_internal(TMR_Reader *reader,
   if (false == tagopPresent)
   {
     /**
-     * Prepare the reader to perform Read operation
+     * Prepare the reader to perform Read operation.
+     * Rebuild under the cached ROSpec's ID so that it can match.
      **/
-    lr->roSpecId++;
-    if (TMR_LLRP_SYNC_MAX_ROSPECS <= lr->roSpecId)
+    if (lr->roSpecReuseAllowed && lr->roSpecCached)
     {
-      lr->roSpecId = 1;
+      lr->roSpecId = lr->cachedROSpecId;
+    }
+    else
+    {
+      lr->roSpecId++;
+      if (TMR_LLRP_SYNC_MAX_ROSPECS <= lr->roSpecId)
+      {
+        lr->roSpecId = 1;
+      }
     }
     lr->readPlanProtocol[lr->roSpecId].rospecProtocol = rp->u.simple.protocol;
     lr->readPlanProtocol[lr->roSpecId].rospecID = (uint8_t)lr->roSpecId;
@@ -2702,7 +2756,7 @@ TMR_LLRP_read(TMR_Reader *reader, uint32_t timeoutMs, int32_t *tagCount)
 {
   TMR_Status ret;
   TMR_ReadPlan *rp;
-  uint8_t i;
+  bool reuseROSpec;
 
   if (NULL == reader)
   {
@@ -2717,26 +2771,18 @@ TMR_LLRP_read(TMR_Reader *reader, uint32_t timeoutMs, int32_t *tagCount)
   }
 
   /**
-   * Allocate memory for bufResponse, to atleast hold one RO_ACCESS_REPORT,
-   * Depending on number of reports received, can be reallocated later.
+   * Empty bufResponse, freeing any RO_ACCESS_REPORT left from the last
+   * read. The array is kept, and grows as reports are received.
    **/
-  if (NULL != reader->u.llrpReader.bufResponse)
+  ret = TMR_LLRP_resetReportBuffer(reader);
+  if (TMR_SUCCESS != ret)
   {
-    /* free this before leaking the memory */
-    for (i = 0; i < reader->u.llrpReader.bufPointer; i++)
-    {
-      TMR_LLRP_freeMessage(reader->u.llrpReader.bufResponse[i]);
-    }
-    free(reader->u.llrpReader.bufResponse);
-    reader->u.llrpReader.bufResponse=NULL;
+    return ret;
   }
 
   reader->u.llrpReader.tagsRemaining = 0;
-  reader->u.llrpReader.bufPointer = 0;
-  reader->u.llrpReader.bufIndex = 0;
- 
-  reader->u.llrpReader.bufResponse = (LLRP_tSMessage **) malloc( 1 * sizeof(LLRP_tSMessage *));
   reader->u.llrpReader.pTagReportData = NULL;
+  reader->u.llrpReader.rawTagOffset = 0;
    
   /**
    * Enable EventsAndReports on the reader, so that the
@@ -2750,27 +2796,40 @@ TMR_LLRP_read(TMR_Reader *reader, uint32_t timeoutMs, int32_t *tagCount)
   }
 
   /**
-   * DELETE_ROSPECs
-   * Delete all ROSpecs, so we don't have to worry about the reader's
-   * prior configuration
+   * A plain sync read (simple plan, no embedded tag operation) may
+   * reuse the ROSpec installed by the previous one. The reader then
+   * holds nothing else of ours, so the deletes below can be skipped;
+   * TMR_LLRP_cmdAddROSpec replaces the ROSpec if it has changed.
    **/
-  ret = TMR_LLRP_cmdDeleteAllROSpecs(reader, true);
-  /*FIXME:
-   * If there are no rospecs on reader, it will throw an exception
-   * Do we really need to care about the error here?
-  if (TMR_SUCCESS != ret)
+  reuseROSpec = (false == reader->continuousReading)
+    && (TMR_READ_PLAN_TYPE_SIMPLE == rp->type)
+    && (NULL == rp->u.simple.tagop);
+
+  if ((false == reuseROSpec) || (false == reader->u.llrpReader.roSpecCached))
   {
-    return ret;
-  }*/
-  /**
-   * DELETE_ACCESSSPECs
-   * Delete all AccessSpecs, so we don't have to worry about reader's
-   * prior configuration
-   **/
-  ret = TMR_LLRP_cmdDeleteAllAccessSpecs(reader);
-  /**
-   * FIXME: do we really need to care about the error here?
-   **/
+    /**
+     * DELETE_ROSPECs
+     * Delete all ROSpecs, so we don't have to worry about the reader's
+     * prior configuration
+     **/
+    ret = TMR_LLRP_cmdDeleteAllROSpecs(reader, true);
+    /*FIXME:
+     * If there are no rospecs on reader, it will throw an exception
+     * Do we really need to care about the error here?
+    if (TMR_SUCCESS != ret)
+    {
+      return ret;
+    }*/
+    /**
+     * DELETE_ACCESSSPECs
+     * Delete all AccessSpecs, so we don't have to worry about reader's
+     * prior configuration
+     **/
+    ret = TMR_LLRP_cmdDeleteAllAccessSpecs(reader);
+    /**
+     * FIXME: do we really need to care about the error here?
+     **/
+  }
 
   if (!reader->continuousReading)
   {
@@ -2791,9 +2850,13 @@ TMR_LLRP_read(TMR_Reader *reader, uint32_t timeoutMs, int32_t *tagCount)
    **/
   reader->u.llrpReader.numOfROSpecEvents = 1;
 
+  reader->u.llrpReader.roSpecReuseAllowed = reuseROSpec;
   ret = TMR_LLRP_read_internal(reader, timeoutMs, rp);
+  reader->u.llrpReader.roSpecReuseAllowed = false;
   if (TMR_SUCCESS != ret)
   {
+    /* Don't trust the reader's ROSpec state after a failed read */
+    reader->u.llrpReader.roSpecCached = false;
     return ret;
   }
 
@@ -2806,6 +2869,7 @@ TMR_LLRP_read(TMR_Reader *reader, uint32_t timeoutMs, int32_t *tagCount)
     ret = TMR_LLRP_verifyReadOperation(reader, tagCount);
     if (TMR_SUCCESS != ret)
     {
+      reader->u.llrpReader.roSpecCached = false;
 #ifdef TMR_ENABLE_BACKGROUND_READS      
       notify_exception_listeners(reader, ret);
 #endif
@@ -2988,8 +3052,7 @@ TMR_LLRP_hasMoreTags(TMR_Reader *reader)
       {
         reader->finishedReading = true;
         TMR_LLRP_freeMessage(lr->bufResponse[0]);
-        free(lr->bufResponse);
-        lr->bufResponse = NULL;
+        lr->bufResponse[0] = NULL;
         return TMR_ERROR_END_OF_READING;
       }
       else
@@ -3021,13 +3084,19 @@ TMR_LLRP_hasMoreTags(TMR_Reader *reader)
       {
         lr->pTagReportData = (LLRP_tSTagReportData *)lr->pTagReportData->hdr.pNextSubParameter;
       }
+      else if (0 != lr->rawTagOffset)
+      {
+        /* Raw report, the one the previous tag came from */
+        lr->rawTagOffset = TMR_LLRP_nextRawTagReport(lr->bufResponse[lr->bufIndex - 1],
+                                                     lr->rawTagOffset);
+      }
 
       /**
        * pTagReportData->hdr.pNextSubParameter can be null when there
        * are no more tags. i.e., we are done with this RO_ACCESS_REPORT.
        * Move to next one.
        **/
-      if (NULL == lr->pTagReportData)
+      if ((NULL == lr->pTagReportData) && (0 == lr->rawTagOffset))
       {
         /**
        * For the very first time, and in the above case
@@ -3038,6 +3107,7 @@ TMR_LLRP_hasMoreTags(TMR_Reader *reader)
     
         pReport = (LLRP_tSRO_ACCESS_REPORT *)lr->bufResponse[lr->bufIndex];
         lr->pTagReportData = pReport->listTagReportData;
+        lr->rawTagOffset = TMR_LLRP_nextRawTagReport(&pReport->hdr, 0);
           lr->bufIndex ++;
         }
     }
@@ -3045,21 +3115,12 @@ TMR_LLRP_hasMoreTags(TMR_Reader *reader)
     {
       /**
        * At this point it is assured that all tags in all RO_ACCESS_REPORTS
-       * are processed. Free RO_ACCESS_REPORTS that were buffered.
-       **/
-      uint8_t i;
-
-      for (i = 0; i < lr->bufIndex; i ++)
-      {
-        TMR_LLRP_freeMessage(lr->bufResponse[i]);
-      }
-      
-      /**
-       * No more RO_ACCESS_REPORTS left, safe to free the bufResponse array
-       * which was allocated in TMR_LLRP_read().
+       * are processed. Free RO_ACCESS_REPORTS that were buffered,
+       * keeping bufResponse for the next read.
        **/
-      free(lr->bufResponse);
-      lr->bufResponse = NULL;
+      TMR_LLRP_resetReportBuffer(reader);
+      lr->pTagReportData = NULL;
+      lr->rawTagOffset = 0;
     }
   }
     return ret;
@@ -3101,10 +3162,22 @@ TMR_LLRP_getNextTag(TMR_Reader *reader, TMR_TagReadData *data)
   TMR_TRD_init(data);
 
   /* Parse the response message */
-  ret = TMR_LLRP_parseMetadataFromMessage(reader, data, lr->pTagReportData);
+  if (0 != lr->rawTagOffset)
+  {
+    ret = TMR_LLRP_parseMetadataFromFrame(reader, data, lr->bufResponse[lr->bufIndex - 1],
+                                          lr->rawTagOffset);
+  }
+  else
+  {
+    ret = TMR_LLRP_parseMetadataFromMessage(reader, data, lr->pTagReportData);
+  }
   if (TMR_SUCCESS != ret)
   {
-    TMR_LLRP_freeMessage(pMsg);
+    /* A sync read report stays in bufResponse until it is reset */
+    if (reader->continuousReading)
+    {
+      TMR_LLRP_freeMessage(pMsg);
+    }
     return ret;
   }
 
@@ -3167,18 +3240,15 @@ TMR_LLRP_executeTagOp(TMR_Reader *reader, TMR_TagOp *tagop,
   ret = TMR_SUCCESS;
   isStandaloneTagop = true;
  
-  reader->u.llrpReader.bufPointer = 0;
   /**
-   * Allocate memory for bufResponse, to atleast hold one RO_ACCESS_REPORT,
-   * We only expect one RO_ACCESS_REPORT in case of standalone tag operation.
+   * Empty bufResponse, we only expect one RO_ACCESS_REPORT in case
+   * of standalone tag operation.
    **/
-  if (NULL != reader->u.llrpReader.bufResponse)
+  ret = TMR_LLRP_resetReportBuffer(reader);
+  if (TMR_SUCCESS != ret)
   {
-    /* free this before leaking the memory */
-    free(reader->u.llrpReader.bufResponse);
-    reader->u.llrpReader.bufResponse=NULL;
+    return ret;
   }
-  reader->u.llrpReader.bufResponse = (LLRP_tSMessage **) malloc(1 * sizeof(LLRP_tSMessage *));
 
 
   /**
@@ -3349,20 +3419,16 @@ TMR_LLRP_executeTagOp(TMR_Reader *reader, TMR_TagOp *tagop,
         TMR_LLRP_parseTagOpSpecData(pOpSpec, data);
       }
     }
+    else if (NULL != pReport->hdr.pRawFrame)
+    {
+      /* A plain tag report, the tag was seen but the OpSpec did not run */
+      ret = TMR_ERROR_NO_TAGS_FOUND;
+    }
 
     /**
      * Done with the response. Free allocated memory
      **/
-    {
-      uint8_t i;
-
-      for (i = 0; i < lr->bufPointer; i ++)
-      {
-        TMR_LLRP_freeMessage(lr->bufResponse[i]);
-      }
-      free(lr->bufResponse);
-      lr->bufResponse = NULL;
-    }
+    TMR_LLRP_resetReportBuffer(reader);
   }
   return ret;
 }
@@ -3471,6 +3537,7 @@ TMR_LLRP_reboot(TMR_Reader *reader)
   {
     return TMR_ERROR_INVALID;
   }
+  reader->u.llrpReader.roSpecCached = false;
   ret = TMR_LLRP_cmdrebootReader(reader);
 
   return ret;
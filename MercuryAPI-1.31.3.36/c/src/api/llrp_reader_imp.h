@@ -177,6 +177,7 @@ TMR_Status TMR_LLRP_sendMessage(TMR_Reader *reader, LLRP_tSMessage *pMsg, int ti
 TMR_Status TMR_LLRP_receiveMessage(TMR_Reader *reader, LLRP_tSMessage **pMsg, int timeoutMs);
 TMR_Status TMR_LLRP_sendTimeout(TMR_Reader *reader, LLRP_tSMessage *pMsg, LLRP_tSMessage **pRsp, int timeoutMs);
 TMR_Status TMR_LLRP_send(TMR_Reader *reader, LLRP_tSMessage *pMsg, LLRP_tSMessage **pRsp);
+TMR_Status TMR_LLRP_flushParamBatch(TMR_Reader *reader);
 void TMR_LLRP_freeMessage(LLRP_tSMessage *pMsg);
 TMR_Status TMR_LLRP_checkLLRPStatus(LLRP_tSLLRPStatus *pLLRPStatus);
 
@@ -302,6 +303,10 @@ TMR_Status TMR_LLRP_cmdStartROSpec(TMR_Reader *reader, llrp_u32_t roSpecId);
 TMR_Status TMR_LLRP_cmdStopROSpec(TMR_Reader *reader, bool receiveResponse);
 TMR_Status TMR_LLRP_cmdDeleteAllROSpecs(TMR_Reader *reader, bool receiveResponse);
 TMR_Status TMR_LLRP_parseMetadataFromMessage(TMR_Reader *reader, TMR_TagReadData *data, LLRP_tSTagReportData *msg);
+int TMR_LLRP_isPlainTagReport(void *pContext, const unsigned char *pFrame, unsigned int nFrame);
+uint32_t TMR_LLRP_nextRawTagReport(const LLRP_tSMessage *pMsg, uint32_t offset);
+TMR_Status TMR_LLRP_parseMetadataFromFrame(TMR_Reader *reader, TMR_TagReadData *data,
+                                           const LLRP_tSMessage *pMsg, uint32_t offset);
 TMR_Status TMR_LLRP_verifyReadOperation(TMR_Reader *reader, int32_t *tagCount);
 TMR_Status TMR_LLRP_cmdStopReading(struct TMR_Reader *reader);
 void TMR_LLRP_parseCustomStatsValues(LLRP_tSCustomStatsValue *customStats, TMR_Reader_StatsValues *statsValue);
@@ -320,8 +325,10 @@ TMR_Status TMR_LLRP_handleKeepAlive(TMR_Reader *reader, LLRP_tSMessage *pMsg);
 TMR_Status TMR_LLRP_startBackgroundReceiver(TMR_Reader *reader);
 TMR_Status TMR_LLRP_cmdSetEventNotificationSpec(TMR_Reader *reader, bool state);
 TMR_Status TMR_LLRP_handleReaderEvents(TMR_Reader *reader, LLRP_tSMessage *pMsg);
+TMR_Status TMR_LLRP_resetReportBuffer(TMR_Reader *reader);
 TMR_Status TMR_LLRP_processReceivedMessage(TMR_Reader *reader, LLRP_tSMessage *pMsg);
 void TMR_LLRP_setBackgroundReceiverState(TMR_Reader *reader, bool state);
+void TMR_LLRP_wakeBackgroundReceiver(TMR_Reader *reader);
 
 /* Access Spec */
 TMR_Status TMR_LLRP_cmdEnableAccessSpec(TMR_Reader *reader, llrp_u32_t accessSpecId);
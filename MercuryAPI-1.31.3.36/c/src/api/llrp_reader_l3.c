@@ -44,14 +44,20 @@
 #include <string.h>
 #if !defined(WIN32) && !defined(WINCE)
 #include <sys/select.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include <time.h>	
 #include "llrp_reader_imp.h"
 #include "tmr_utils.h"
 
+/* Select period of the receiver thread where it cannot block on a wake pipe */
 #define BACKGROUND_RECEIVER_LOOP_PERIOD 1
 #define MAX_KEEP_ALIVE_ACK_MISSES 3
+/* Slots the sync read report buffer starts with, it doubles when full */
+#define REPORT_BUFFER_INITIAL_SIZE 16
 #define TMMP_CUSTOM_RFPHASE        143
 #define TMMP_CUSTOM_PROTOCOL_ID    175
 #define TMMP_CUSTOM_TAGOP_RESPONSE 216
@@ -161,8 +167,9 @@ TMR_LLRP_tmToLlrpGpo(uint32_t model, uint8_t tmNum, llrp_u16_t *llrpNum)
 }
 
 /**
- * Notify transport listener,
- * Called from SendMessage and ReceiveMessage
+ * Notify transport listener with the XML rendering of a message.
+ * Called from SendMessage and ReceiveMessage. Only call this when
+ * transport listeners are registered, since the encoding is costly.
  *
  * @param reader The reader
  * @param pMsg Pointer to Message to send (of type LLRP_tSMessage * for llrp reader)
@@ -173,14 +180,38 @@ TMR_Status
 TMR_LLRP_notifyTransportListener(TMR_Reader *reader, LLRP_tSMessage *pMsg, bool tx, int timeout)
 {
   char buf[100*1024];
+  LLRP_tSMessage *pDecoded = NULL;
+  LLRP_tResultCode rc;
 
-  if (LLRP_RC_OK != LLRP_toXMLString(&pMsg->elementHdr, buf, sizeof(buf)))
+  if (NULL != pMsg->pRawFrame)
   {
-    TMR__notifyTransportListeners(reader, tx, 0, (uint8_t *)buf, timeout);
-    return TMR_ERROR_LLRP_MSG_PARSE_ERROR; 
+    /* A report kept as received, decode it only to render it */
+    LLRP_tSFrameDecoder *pDecoder;
+
+    pDecoder = LLRP_FrameDecoder_construct(reader->u.llrpReader.pTypeRegistry,
+                 (unsigned char *)pMsg->pRawFrame, pMsg->nRawFrame);
+    if (NULL != pDecoder)
+    {
+      pDecoded = LLRP_Decoder_decodeMessage(&pDecoder->decoderHdr);
+      LLRP_Decoder_destruct(&pDecoder->decoderHdr);
+    }
+    if (NULL == pDecoded)
+    {
+      return TMR_ERROR_LLRP_MSG_PARSE_ERROR;
+    }
+    pMsg = pDecoded;
   }
 
+  rc = LLRP_toXMLString(&pMsg->elementHdr, buf, sizeof(buf));
+  if (NULL != pDecoded)
+  {
+    LLRP_Element_destruct(&pDecoded->elementHdr);
+  }
   TMR__notifyTransportListeners(reader, tx, 0, (uint8_t *)buf, timeout);
+  if (LLRP_RC_OK != rc)
+  {
+    return TMR_ERROR_LLRP_MSG_PARSE_ERROR; 
+  }
 
   return TMR_SUCCESS;
 }
@@ -205,7 +236,7 @@ TMR_LLRP_sendMessage(TMR_Reader *reader, LLRP_tSMessage *pMsg, int timeoutMs)
 
   pMsg->MessageID = reader->u.llrpReader.msgId ++;
 
-  if (NULL != reader->transportListeners)
+  if ((NULL != reader->transportListeners) && (false == reader->transportTraceRaw))
   {
     TMR_LLRP_notifyTransportListener(reader, pMsg, true, timeoutMs);
   }
@@ -232,6 +263,12 @@ TMR_LLRP_sendMessage(TMR_Reader *reader, LLRP_tSMessage *pMsg, int timeoutMs)
     }
     return TMR_ERROR_LLRP_SENDIO_ERROR;
   }
+  if ((NULL != reader->transportListeners) && (true == reader->transportTraceRaw))
+  {
+    /* The encoded frame is still in the send buffer */
+    TMR__notifyTransportListeners(reader, true, pConn->Send.nBuffer,
+                                  pConn->Send.pBuffer, timeoutMs);
+  }
   if(true == tx_mutex_lock_enabled)
   {
     pthread_mutex_unlock(&reader->u.llrpReader.transmitterLock);
@@ -243,6 +280,10 @@ TMR_LLRP_sendMessage(TMR_Reader *reader, LLRP_tSMessage *pMsg, int timeoutMs)
 /**
  * Receive a response.
  *
+ * With TMR_LLRP_DECODE_ARENA the connection decodes the message into
+ * a single arena, so it must be released whole with
+ * TMR_LLRP_freeMessage() and none of its parameters kept past that.
+ *
  * @param reader The reader
  * @param[out] pMsg Message received.
  * @param timeoutMs Timeout value.
@@ -251,6 +292,7 @@ TMR_Status
 TMR_LLRP_receiveMessage(TMR_Reader *reader, LLRP_tSMessage **pMsg, int timeoutMs)
 {
   LLRP_tSConnection *pConn = reader->u.llrpReader.pConn;
+  bool queued;
   timeoutMs += reader->u.llrpReader.transportTimeout;
 
   if (NULL == pConn)
@@ -259,8 +301,11 @@ TMR_LLRP_receiveMessage(TMR_Reader *reader, LLRP_tSMessage **pMsg, int timeoutMs
   }
 
   /*
-   * Receive the message subject to a time limit
+   * Receive the message subject to a time limit.
+   * A message taken from the connection's input queue was not the
+   * last frame read, so its raw bytes are no longer in the buffer.
    */
+  queued = (NULL != pConn->pInputQueue);
   *pMsg = LLRP_Conn_recvMessage(pConn, timeoutMs);
   /*
    * If LLRP_Conn_recvMessage() returns NULL then there was
@@ -276,8 +321,27 @@ TMR_LLRP_receiveMessage(TMR_Reader *reader, LLRP_tSMessage **pMsg, int timeoutMs
     
     return TMR_ERROR_LLRP_RECEIVEIO_ERROR;
   }
+  TMR__metrics(reader, &reader->metricsIo)->framesReceived++;
 #ifndef WINCE
-  TMR_LLRP_notifyTransportListener(reader, *pMsg, false, timeoutMs);
+  if (NULL != reader->transportListeners)
+  {
+    if ((true == reader->transportTraceRaw) && (NULL != (*pMsg)->pRawFrame))
+    {
+      TMR__notifyTransportListeners(reader, false, (*pMsg)->nRawFrame,
+                                    (uint8_t *)(*pMsg)->pRawFrame, timeoutMs);
+    }
+    else if ((true == reader->transportTraceRaw) && (false == queued)
+        && pConn->Recv.bFrameValid)
+    {
+      TMR__notifyTransportListeners(reader, false,
+                                    pConn->Recv.FrameExtract.MessageLength,
+                                    pConn->Recv.pBuffer, timeoutMs);
+    }
+    else
+    {
+      TMR_LLRP_notifyTransportListener(reader, *pMsg, false, timeoutMs);
+    }
+  }
 #endif
   return TMR_SUCCESS;
 }
@@ -290,8 +354,8 @@ TMR_LLRP_receiveMessage(TMR_Reader *reader, LLRP_tSMessage **pMsg, int timeoutMs
  * @param[out] pRsp Message received.
  * @param timeoutMs Timeout value.
  */
-TMR_Status
-TMR_LLRP_sendTimeout(TMR_Reader *reader, LLRP_tSMessage *pMsg, LLRP_tSMessage **pRsp, int timeoutMs)
+static TMR_Status
+exchange(TMR_Reader *reader, LLRP_tSMessage *pMsg, LLRP_tSMessage **pRsp, int timeoutMs)
 {
   TMR_Status ret;
   bool rx_mutex_lock_enabled = false;
@@ -378,6 +442,265 @@ out:
   return ret;
 }
 
+/**
+ * Whether the settings of one SET_READER_CONFIG can be added to
+ * another's without either overriding the other: no single parameter
+ * in both, and no antenna, GPO, GPI or custom parameter type twice.
+ */
+static bool
+canMergeReaderConfig(LLRP_tSSET_READER_CONFIG *into, LLRP_tSSET_READER_CONFIG *from)
+{
+  LLRP_tSAntennaProperties *pProp, *pIntoProp;
+  LLRP_tSAntennaConfiguration *pConf, *pIntoConf;
+  LLRP_tSGPOWriteData *pGpo, *pIntoGpo;
+  LLRP_tSGPIPortCurrentState *pGpi, *pIntoGpi;
+  LLRP_tSParameter *pCustom, *pIntoCustom;
+
+  if (from->ResetToFactoryDefault
+      || ((NULL != into->pReaderEventNotificationSpec) && (NULL != from->pReaderEventNotificationSpec))
+      || ((NULL != into->pROReportSpec) && (NULL != from->pROReportSpec))
+      || ((NULL != into->pAccessReportSpec) && (NULL != from->pAccessReportSpec))
+      || ((NULL != into->pKeepaliveSpec) && (NULL != from->pKeepaliveSpec))
+      || ((NULL != into->pEventsAndReports) && (NULL != from->pEventsAndReports)))
+  {
+    return false;
+  }
+
+  /* Antenna ID 0 stands for all of them */
+  for (pProp = from->listAntennaProperties; NULL != pProp;
+       pProp = (LLRP_tSAntennaProperties *)pProp->hdr.pNextSubParameter)
+  {
+    for (pIntoProp = into->listAntennaProperties; NULL != pIntoProp;
+         pIntoProp = (LLRP_tSAntennaProperties *)pIntoProp->hdr.pNextSubParameter)
+    {
+      if ((pProp->AntennaID == pIntoProp->AntennaID) || (0 == pProp->AntennaID)
+          || (0 == pIntoProp->AntennaID))
+      {
+        return false;
+      }
+    }
+  }
+  for (pConf = from->listAntennaConfiguration; NULL != pConf;
+       pConf = (LLRP_tSAntennaConfiguration *)pConf->hdr.pNextSubParameter)
+  {
+    for (pIntoConf = into->listAntennaConfiguration; NULL != pIntoConf;
+         pIntoConf = (LLRP_tSAntennaConfiguration *)pIntoConf->hdr.pNextSubParameter)
+    {
+      if ((pConf->AntennaID == pIntoConf->AntennaID) || (0 == pConf->AntennaID)
+          || (0 == pIntoConf->AntennaID))
+      {
+        return false;
+      }
+    }
+  }
+  for (pGpo = from->listGPOWriteData; NULL != pGpo;
+       pGpo = (LLRP_tSGPOWriteData *)pGpo->hdr.pNextSubParameter)
+  {
+    for (pIntoGpo = into->listGPOWriteData; NULL != pIntoGpo;
+         pIntoGpo = (LLRP_tSGPOWriteData *)pIntoGpo->hdr.pNextSubParameter)
+    {
+      if (pGpo->GPOPortNumber == pIntoGpo->GPOPortNumber)
+      {
+        return false;
+      }
+    }
+  }
+  for (pGpi = from->listGPIPortCurrentState; NULL != pGpi;
+       pGpi = (LLRP_tSGPIPortCurrentState *)pGpi->hdr.pNextSubParameter)
+  {
+    for (pIntoGpi = into->listGPIPortCurrentState; NULL != pIntoGpi;
+         pIntoGpi = (LLRP_tSGPIPortCurrentState *)pIntoGpi->hdr.pNextSubParameter)
+    {
+      if (pGpi->GPIPortNum == pIntoGpi->GPIPortNum)
+      {
+        return false;
+      }
+    }
+  }
+  for (pCustom = from->listCustom; NULL != pCustom; pCustom = pCustom->pNextSubParameter)
+  {
+    for (pIntoCustom = into->listCustom; NULL != pIntoCustom;
+         pIntoCustom = pIntoCustom->pNextSubParameter)
+    {
+      if (pCustom->elementHdr.pType == pIntoCustom->elementHdr.pType)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * Move a sub-parameter from one message to another. The caller still
+ * frees the message it came from, which only frees what it holds.
+ */
+#define MOVE_PARAM(into, from, field, set) \
+  if (NULL != (from)->field) \
+  { \
+    LLRP_tSParameter *pParam = (LLRP_tSParameter *)(from)->field; \
+    (from)->field = NULL; \
+    LLRP_Element_removeSubParameterFromAllList(&(from)->hdr.elementHdr, pParam); \
+    set((into), (void *)pParam); \
+  }
+#define MOVE_LIST(into, from, field, add) \
+  while (NULL != (from)->field) \
+  { \
+    LLRP_tSParameter *pParam = (LLRP_tSParameter *)(from)->field; \
+    (from)->field = (void *)pParam->pNextSubParameter; \
+    LLRP_Element_removeSubParameterFromAllList(&(from)->hdr.elementHdr, pParam); \
+    add((into), (void *)pParam); \
+  }
+
+static void
+mergeReaderConfig(LLRP_tSSET_READER_CONFIG *into, LLRP_tSSET_READER_CONFIG *from)
+{
+  MOVE_PARAM(into, from, pReaderEventNotificationSpec, LLRP_SET_READER_CONFIG_setReaderEventNotificationSpec);
+  MOVE_LIST(into, from, listAntennaProperties, LLRP_SET_READER_CONFIG_addAntennaProperties);
+  MOVE_LIST(into, from, listAntennaConfiguration, LLRP_SET_READER_CONFIG_addAntennaConfiguration);
+  MOVE_PARAM(into, from, pROReportSpec, LLRP_SET_READER_CONFIG_setROReportSpec);
+  MOVE_PARAM(into, from, pAccessReportSpec, LLRP_SET_READER_CONFIG_setAccessReportSpec);
+  MOVE_PARAM(into, from, pKeepaliveSpec, LLRP_SET_READER_CONFIG_setKeepaliveSpec);
+  MOVE_LIST(into, from, listGPOWriteData, LLRP_SET_READER_CONFIG_addGPOWriteData);
+  MOVE_LIST(into, from, listGPIPortCurrentState, LLRP_SET_READER_CONFIG_addGPIPortCurrentState);
+  MOVE_PARAM(into, from, pEventsAndReports, LLRP_SET_READER_CONFIG_setEventsAndReports);
+  MOVE_LIST(into, from, listCustom, LLRP_SET_READER_CONFIG_addCustom);
+}
+
+/**
+ * Send the SET_READER_CONFIG the settings of a TMR_paramSetMany()
+ * batch have been merged into, if any, and give its outcome to the
+ * batch entries they were sent for.
+ *
+ * @param reader The reader
+ */
+TMR_Status
+TMR_LLRP_flushParamBatch(TMR_Reader *reader)
+{
+  TMR_LLRP_LlrpReader *lr;
+  TMR_Status ret;
+  LLRP_tSMessage *pRspMsg;
+  uint8_t i;
+
+  lr = &reader->u.llrpReader;
+  if (NULL == lr->batchConfig)
+  {
+    return TMR_SUCCESS;
+  }
+
+  ret = exchange(reader, &lr->batchConfig->hdr, &pRspMsg,
+                 lr->commandTimeout + lr->transportTimeout);
+  TMR_LLRP_freeMessage(&lr->batchConfig->hdr);
+  lr->batchConfig = NULL;
+  if (TMR_SUCCESS == ret)
+  {
+    ret = TMR_LLRP_checkLLRPStatus(((LLRP_tSSET_READER_CONFIG_RESPONSE *)pRspMsg)->pLLRPStatus);
+    TMR_LLRP_freeMessage(pRspMsg);
+  }
+
+  for (i = 0; i < lr->batchConfigOpCount; i++)
+  {
+    if ((TMR_SUCCESS != ret) && (TMR_SUCCESS == reader->batchOps[lr->batchConfigOps[i]].status))
+    {
+      reader->batchOps[lr->batchConfigOps[i]].status = ret;
+    }
+  }
+  lr->batchConfigOpCount = 0;
+  return ret;
+}
+
+/**
+ * Within a TMR_paramSetMany() batch, add a SET_READER_CONFIG to the
+ * one being collected instead of sending it, and answer it with
+ * success; the real outcome goes to the batch entry when the
+ * collected message is sent. A setting whose handler updates a copy
+ * of its own from the answer is not collected, so that it sees the
+ * reader's.
+ *
+ * @return Whether the message was taken
+ */
+static bool
+collectReaderConfig(TMR_Reader *reader, LLRP_tSMessage *pMsg, LLRP_tSMessage **pRsp)
+{
+  TMR_LLRP_LlrpReader *lr;
+  LLRP_tSSET_READER_CONFIG *pCmd;
+  LLRP_tSSET_READER_CONFIG_RESPONSE *pResponse;
+  LLRP_tSLLRPStatus *pStatus;
+
+  lr = &reader->u.llrpReader;
+  pCmd = (LLRP_tSSET_READER_CONFIG *)pMsg;
+  if ((&LLRP_tdSET_READER_CONFIG != pMsg->elementHdr.pType) || pCmd->ResetToFactoryDefault
+      || (TMR_PARAM_READER_STATS_ENABLE == reader->batchOps[reader->batchIndex].key))
+  {
+    return false;
+  }
+  if ((NULL != lr->batchConfig)
+      && ((TMR_LLRP_BATCH_CONFIG_OPS == lr->batchConfigOpCount)
+          || !canMergeReaderConfig(lr->batchConfig, pCmd)))
+  {
+    if (TMR_SUCCESS != TMR_LLRP_flushParamBatch(reader))
+    {
+      return false;
+    }
+  }
+  if (NULL == lr->batchConfig)
+  {
+    lr->batchConfig = LLRP_SET_READER_CONFIG_construct();
+  }
+
+  pResponse = LLRP_SET_READER_CONFIG_RESPONSE_construct();
+  pStatus = LLRP_LLRPStatus_construct();
+  pStatus->eStatusCode = LLRP_StatusCode_M_Success;
+  LLRP_SET_READER_CONFIG_RESPONSE_setLLRPStatus(pResponse, pStatus);
+  *pRsp = &pResponse->hdr;
+
+  mergeReaderConfig(lr->batchConfig, pCmd);
+  if ((0 == lr->batchConfigOpCount)
+      || (lr->batchConfigOps[lr->batchConfigOpCount - 1] != reader->batchIndex))
+  {
+    lr->batchConfigOps[lr->batchConfigOpCount++] = reader->batchIndex;
+  }
+  return true;
+}
+
+/**
+ * Send a message and receive a response with timeout. Within a
+ * TMR_paramSetMany() batch, SET_READER_CONFIG messages are collected
+ * into one, which is sent before anything else is.
+ *
+ * @param reader The reader
+ * @param[in] pMsg Message to send
+ * @param[out] pRsp Message received.
+ * @param timeoutMs Timeout value.
+ */
+TMR_Status
+TMR_LLRP_sendTimeout(TMR_Reader *reader, LLRP_tSMessage *pMsg, LLRP_tSMessage **pRsp, int timeoutMs)
+{
+  TMR_Status ret;
+  uint32_t i;
+
+  if (NULL != reader->batchOps)
+  {
+    if (collectReaderConfig(reader, pMsg, pRsp))
+    {
+      return TMR_SUCCESS;
+    }
+    ret = TMR_LLRP_flushParamBatch(reader);
+    for (i = 0; i <= reader->batchIndex; i++)
+    {
+      if (TMR_SUCCESS != reader->batchOps[i].status)
+      {
+        return TMR_ERROR_BATCH_ABORTED;
+      }
+    }
+    if (TMR_SUCCESS != ret)
+    {
+      return ret;
+    }
+  }
+  return exchange(reader, pMsg, pRsp, timeoutMs);
+}
+
 /**
  * Send a message and receive a response.
  *
@@ -394,7 +717,8 @@ TMR_LLRP_send(TMR_Reader *reader, LLRP_tSMessage *pMsg, LLRP_tSMessage **pRsp)
 }
 
 /**
- * Free LLRP message
+ * Free LLRP message. A message decoded into an arena is released
+ * with a single free of its arena, whatever its size.
  *
  * @param pMsg Message to free
  */
@@ -2801,6 +3125,7 @@ TMR_LLRP_cmdDeleteAllROSpecs(TMR_Reader *reader, bool receiveResponse)
   LLRP_tSDELETE_ROSPEC_RESPONSE *pRsp;
 
   ret = TMR_SUCCESS;
+  reader->u.llrpReader.roSpecCached = false;
 
   /**
    * Create delete rospec message
@@ -3294,6 +3619,47 @@ TMR_LLRP_addFastSearch(LLRP_tSInventoryParameterSpec *ipSpec, bool fastSearch)
   return ret;
 }
 
+/**
+ * Encode an ADD_ROSPEC message into a newly allocated buffer, so that
+ * it can be compared with the ROSpec already installed on the reader.
+ *
+ * @param reader Reader pointer
+ * @param pCmdMsg The message to encode
+ * @param[out] length Length of the encoding
+ * @return The encoding (to be freed by the caller), or NULL on failure
+ */
+static uint8_t *
+TMR_LLRP_encodeROSpec(TMR_Reader *reader, LLRP_tSMessage *pCmdMsg, uint32_t *length)
+{
+  LLRP_tSFrameEncoder *pEncoder;
+  uint8_t *buf;
+  unsigned int size;
+  bool ok;
+
+  size = reader->u.llrpReader.pConn->nBufferSize;
+  buf = malloc(size);
+  if (NULL == buf)
+  {
+    return NULL;
+  }
+  pEncoder = LLRP_FrameEncoder_construct(buf, size);
+  if (NULL == pEncoder)
+  {
+    free(buf);
+    return NULL;
+  }
+  LLRP_Encoder_encodeElement(&pEncoder->encoderHdr, &pCmdMsg->elementHdr);
+  ok = (LLRP_RC_OK == pEncoder->encoderHdr.ErrorDetails.eResultCode);
+  *length = pEncoder->iNext;
+  LLRP_Encoder_destruct(&pEncoder->encoderHdr);
+  if (!ok)
+  {
+    free(buf);
+    return NULL;
+  }
+  return buf;
+}
+
 /**
  * Command to Add an ROSpec
  *
@@ -3977,6 +4343,41 @@ TMR_LLRP_cmdAddROSpec(TMR_Reader *reader, uint16_t readDuration,
   LLRP_ADD_ROSPEC_setROSpec(pCmd, pROSpec);
 
   pCmdMsg = &pCmd->hdr;
+
+  /**
+   * For a reusable sync read, compare with the ROSpec left on the
+   * reader by the previous one. If it is unchanged there is nothing to
+   * send; otherwise remove it and remember the new one.
+   **/
+  reader->u.llrpReader.roSpecReused = false;
+  if (reader->u.llrpReader.roSpecReuseAllowed)
+  {
+    uint8_t *encoded;
+    uint32_t length = 0;
+    TMR_LLRP_LlrpReader *lr = &reader->u.llrpReader;
+
+    encoded = TMR_LLRP_encodeROSpec(reader, pCmdMsg, &length);
+    if (lr->roSpecCached && (NULL != encoded)
+        && (lr->cachedROSpecId == lr->roSpecId)
+        && (lr->cachedROSpecLength == length)
+        && (0 == memcmp(lr->cachedROSpec, encoded, length)))
+    {
+      free(encoded);
+      TMR_LLRP_freeMessage((LLRP_tSMessage *)pCmd);
+      lr->roSpecReused = true;
+      return TMR_SUCCESS;
+    }
+    if (lr->roSpecCached)
+    {
+      /* Read plan or parameters changed: replace the installed ROSpec */
+      TMR_LLRP_cmdDeleteAllROSpecs(reader, true);
+    }
+    free(lr->cachedROSpec);
+    lr->cachedROSpec = encoded;
+    lr->cachedROSpecLength = length;
+    lr->cachedROSpecId = lr->roSpecId;
+  }
+
   /**
    * Now the message is framed completely and send the message
    **/
@@ -4073,6 +4474,7 @@ TMR_LLRP_cmdDisableROSpec(TMR_Reader *reader)
   LLRP_tSDISABLE_ROSPEC_RESPONSE *pRsp;
   
   ret = TMR_SUCCESS;
+  reader->u.llrpReader.roSpecCached = false;
 
   /**
    * Initialize EnableROSpec message
@@ -4291,11 +4693,22 @@ TMR_LLRP_cmdPrepareROSpec(TMR_Reader *reader, uint16_t timeout,
   {
     return ret;
   }
+  if (reader->u.llrpReader.roSpecReused)
+  {
+    /* Already installed and enabled */
+    return TMR_SUCCESS;
+  }
 
   /**
    * 2. Enable ROSpec
    **/
-  return TMR_LLRP_cmdEnableROSpec(reader);
+  ret = TMR_LLRP_cmdEnableROSpec(reader);
+  if ((TMR_SUCCESS == ret) && reader->u.llrpReader.roSpecReuseAllowed
+      && (NULL != reader->u.llrpReader.cachedROSpec))
+  {
+    reader->u.llrpReader.roSpecCached = true;
+  }
+  return ret;
 }
 
 TMR_Status
@@ -4304,7 +4717,7 @@ TMR_LLRP_verifyReadOperation(TMR_Reader *reader, int32_t *tagCount)
   LLRP_tSTagReportData    *pTagReportData;
   LLRP_tSRO_ACCESS_REPORT *pReport;
   TMR_LLRP_LlrpReader *lr;
-  uint32_t count, i;
+  uint32_t count, i, offset;
 
   lr = &reader->u.llrpReader;
   /**
@@ -4355,6 +4768,12 @@ TMR_LLRP_verifyReadOperation(TMR_Reader *reader, int32_t *tagCount)
       {
         count ++;
       }
+      for (offset = TMR_LLRP_nextRawTagReport(&pReport->hdr, 0);
+           0 != offset;
+           offset = TMR_LLRP_nextRawTagReport(&pReport->hdr, offset))
+      {
+        count ++;
+      }
 
     lr->tagsRemaining += count;
       if (NULL != tagCount)
@@ -4664,36 +5083,664 @@ TMR_LLRP_parseMetadataFromMessage(TMR_Reader *reader, TMR_TagReadData *data, LLR
                   data->metadataFlags |= TMR_TRD_METADATA_FLAG_GPIO_STATUS;
                 }
                 break;
-              case TMMPD_CUSTOM_GEN2:
-                /**
-                 * Currently GEN2 Q, LF and TARGET is coming as custom parameter
-                 * in TagReportData
-                 **/ 
-                if(reader->u.llrpReader.metadata & TMR_TRD_METADATA_FLAG_GEN2_Q)
+              case TMMPD_CUSTOM_GEN2:
+                /**
+                 * Currently GEN2 Q, LF and TARGET is coming as custom parameter
+                 * in TagReportData
+                 **/ 
+                if(reader->u.llrpReader.metadata & TMR_TRD_METADATA_FLAG_GEN2_Q)
+                {
+                  LLRP_tSGen2QResponse *pGen2QResponse;
+                  pGen2QResponse = LLRP_ThingMagicMetadataGen2_getGen2QResponse(
+                           (LLRP_tSThingMagicMetadataGen2 *)pParameter);
+                  data->u.gen2.q.u.staticQ.initialQ = LLRP_Gen2QResponse_getQValue(
+                           (LLRP_tSGen2QResponse *)pGen2QResponse);
+                  data->metadataFlags |= TMR_TRD_METADATA_FLAG_GEN2_Q;
+                }
+                if(reader->u.llrpReader.metadata & TMR_TRD_METADATA_FLAG_GEN2_LF)
+                {
+                  LLRP_tSGen2LFResponse *pGen2LFResponse;
+                  pGen2LFResponse = LLRP_ThingMagicMetadataGen2_getGen2LFResponse(
+                           (LLRP_tSThingMagicMetadataGen2 *)pParameter);
+                  data->u.gen2.lf = LLRP_Gen2LFResponse_getLFValue(
+                           (LLRP_tSGen2LFResponse *)pGen2LFResponse);
+                  data->metadataFlags |= TMR_TRD_METADATA_FLAG_GEN2_LF;
+                }
+                if(reader->u.llrpReader.metadata & TMR_TRD_METADATA_FLAG_GEN2_TARGET)
+                {
+                  LLRP_tSGen2TargetResponse *pGen2TargetResponse;
+                  pGen2TargetResponse = LLRP_ThingMagicMetadataGen2_getGen2TargetResponse(
+                           (LLRP_tSThingMagicMetadataGen2 *)pParameter);
+                  data->u.gen2.target = LLRP_Gen2TargetResponse_getTargetValue(
+                           (LLRP_tSGen2TargetResponse *)pGen2TargetResponse);
+                  data->metadataFlags |= TMR_TRD_METADATA_FLAG_GEN2_TARGET;
+                }
+                break;
+              default:
+                break;
+            }
+          }
+        }
+        else
+        {
+          for (pParameter = pTagReportData->listCustom;
+            NULL != pParameter;
+            pParameter = (LLRP_tSParameter *)pParameter->pNextSubParameter)
+          {
+            /**
+             * Currently phase is coming as custom parameter
+             **/ 
+            phase = LLRP_ThingMagicRFPhase_getPhase(
+                (LLRP_tSThingMagicRFPhase *)pParameter);
+
+            /* Copy the value to tagReport */
+            data->phase = phase;
+          }
+        }
+      }
+    }
+
+    if (TMR_TAG_PROTOCOL_GEN2 == data->tag.protocol)
+    {
+      LLRP_tSParameter *pParameter;
+
+      /**
+       * If protocol is Gen2, extract CRC and PCBits
+       **/
+      for(pParameter = pTagReportData->listAirProtocolTagData;
+          NULL != pParameter;
+          pParameter = (LLRP_tSParameter *)pParameter->pNextSubParameter)
+      {
+        if (&LLRP_tdC1G2_PC == pParameter->elementHdr.pType)
+        {
+          llrp_u16_t pc;
+
+          pc = LLRP_C1G2_PC_getPC_Bits((LLRP_tSC1G2_PC *)pParameter);
+          data->tag.u.gen2.pc[0] = pc & 0xFF;
+          data->tag.u.gen2.pc[1] = (pc & 0xFF00) >> 8;
+
+          data->tag.u.gen2.pcByteCount = 2;
+
+          /** TODO: Add support for XPC bits */
+        }
+        else if (&LLRP_tdC1G2_CRC == pParameter->elementHdr.pType)
+        {
+          data->tag.crc = LLRP_C1G2_CRC_getCRC((LLRP_tSC1G2_CRC *)pParameter);
+        }
+      } /* End of for loop */
+    }
+
+    /**
+     * Extract OpSpecResults if any. 
+     **/
+    {
+      LLRP_tSParameter *pParameter;
+
+      for (pParameter = pTagReportData->listAccessCommandOpSpecResult;
+           NULL != pParameter;
+           pParameter = (LLRP_tSParameter *)pParameter->pNextSubParameter)
+      {
+        /**
+         * Each airProtocol's OpSpecResult is expressed as a different
+         * LLRP parameter. Verify the OpSpecResult status, if not success,
+         * then notify the exception to user.
+         **/
+        TMR_Status retVal;
+
+        retVal = TMR_LLRP_verifyOpSpecResultStatus(reader, pParameter);
+        if (TMR_SUCCESS != retVal)
+        {
+          /**
+           * The OpSpec has failed to execute, notify the execption to 
+           * user.
+           * FIXME: Notifying the error through exception listener.
+           * This is exact behavior in case of continuous reading, 
+           * How do we handle this for sync reads? We can not return
+           * Error though..
+           **/
+#ifdef TMR_ENABLE_BACKGROUND_READS
+          notify_exception_listeners(reader, retVal);
+#endif
+
+          /**
+           * Continue with next OpSpecResult parameter.
+           **/
+          continue;
+        }
+
+        /**
+         * At this point, we have verified the OpSpecResult status,
+         * and it is success.
+         * But currently, only for ReadData (i.e., C1G2ReadOpSpecResult),
+         * we extract the read data and place it in TMR_TagReadData->data
+         * TODO: For other tag operations which return tagop data,
+         * where do we store that?
+         **/
+        if (NULL != &data->data)
+        {
+          TMR_LLRP_parseTagOpSpecData(pParameter, &data->data);
+          data->metadataFlags |= TMR_TRD_METADATA_FLAG_DATA;
+        }
+      } /* End of for loop */
+    } /* End of parsing OpSpecResults */
+  }
+  else
+  {
+    return TMR_ERROR_LLRP;
+  }
+
+  return ret;
+}
+
+/**
+ * Fast path for plain tag reports.
+ *
+ * The RO_ACCESS_REPORTs of an inventory are by far the most frequent
+ * message while reading, and decoding each of them into an LTKC
+ * object tree only for TMR_LLRP_parseMetadataFromMessage() to copy
+ * the fields out again dominates the host side cost of a read.
+ * The connection's raw frame filter keeps the reports that carry
+ * nothing but tag reads as the received frame
+ * (LLRP_tSMessage.pRawFrame), and the functions below decode their
+ * TagReportData parameters straight into TMR_TagReadData.  Reports
+ * with OpSpec results, tagop responses or any parameter not listed
+ * here still go through LTKC.
+ */
+
+/* Type of each TV parameter allowed in a plain TagReportData */
+#define TMR_LLRP_RAW_TV_ANTENNA_ID      1
+#define TMR_LLRP_RAW_TV_LAST_SEEN_UTC   4
+#define TMR_LLRP_RAW_TV_PEAK_RSSI       6
+#define TMR_LLRP_RAW_TV_CHANNEL_INDEX   7
+#define TMR_LLRP_RAW_TV_TAG_SEEN_COUNT  8
+#define TMR_LLRP_RAW_TV_ROSPEC_ID       9
+#define TMR_LLRP_RAW_TV_C1G2_CRC        11
+#define TMR_LLRP_RAW_TV_C1G2_PC         12
+#define TMR_LLRP_RAW_TV_EPC_96          13
+/* TLV parameters and messages */
+#define TMR_LLRP_RAW_RO_ACCESS_REPORT   61
+#define TMR_LLRP_RAW_TAG_REPORT_DATA    240
+#define TMR_LLRP_RAW_EPC_DATA           241
+#define TMR_LLRP_RAW_CUSTOM             1023
+#define TMR_LLRP_RAW_THINGMAGIC_VENDOR  26554
+#define TMR_LLRP_RAW_MESSAGE_HEADER     10
+/* Custom parameters nested in the ThingMagic metadata ones */
+#define TMMPD_CUSTOM_GPIO_PIN           225
+#define TMMPD_CUSTOM_GEN2_Q             227
+#define TMMPD_CUSTOM_GEN2_LF            228
+#define TMMPD_CUSTOM_GEN2_TARGET        229
+
+/**
+ * Encoded length of the TV parameters, indexed by type. Zero for the
+ * ones the fast path leaves to LTKC: type 15, ClientRequestOpSpecResult,
+ * belongs to a tag operation.
+ */
+static const uint8_t rawTVLength[] = {
+  0, 3, 9, 9, 9, 9, 2, 3, 3, 5, 3, 3, 3, 13, 3, 0, 5
+};
+
+/* The ThingMagic custom parameters have a 12 byte header: TLV, vendor, subtype */
+#define RAW_TLV_TYPE(p)        (GETU16AT((p), 0) & 0x3FF)
+#define RAW_TLV_LENGTH(p)      GETU16AT((p), 2)
+#define RAW_CUSTOM_VENDOR(p)   GETU32AT((p), 4)
+#define RAW_CUSTOM_SUBTYPE(p)  GETU32AT((p), 8)
+
+/**
+ * Length of the TLV parameter at the start of p, or 0 if it is a TV
+ * parameter or does not fit in the avail bytes left.
+ */
+static uint32_t
+rawTLVLength(const uint8_t *p, uint32_t avail)
+{
+  uint32_t len;
+
+  if ((avail < 4) || (p[0] & 0x80))
+  {
+    return 0;
+  }
+  len = RAW_TLV_LENGTH(p);
+  return ((len < 4) || (len > avail)) ? 0 : len;
+}
+
+/**
+ * Check that the custom parameters nested in a ThingMagic metadata
+ * parameter all have one of the given subtypes and lengths.
+ */
+static bool
+rawCustomChildrenAre(const uint8_t *p, uint32_t len, const uint32_t *subtypes,
+                     const uint32_t *lengths, int count)
+{
+  uint32_t i, plen;
+  int j;
+
+  for (i = 12; i < len; i += plen)
+  {
+    plen = rawTLVLength(&p[i], len - i);
+    if ((0 == plen) || (TMR_LLRP_RAW_CUSTOM != RAW_TLV_TYPE(&p[i])) || (plen < 12)
+        || (TMR_LLRP_RAW_THINGMAGIC_VENDOR != RAW_CUSTOM_VENDOR(&p[i])))
+    {
+      return false;
+    }
+    for (j = 0; j < count; j++)
+    {
+      if ((subtypes[j] == RAW_CUSTOM_SUBTYPE(&p[i])) && (lengths[j] == plen))
+      {
+        break;
+      }
+    }
+    if (j == count)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Check a custom parameter of a TagReportData against the metadata
+ * ones TMR_LLRP_parseMetadataFromFrame() knows.
+ */
+static bool
+rawCustomIsMetadata(const uint8_t *p, uint32_t len)
+{
+  static const uint32_t gpioSubtypes[] = {TMMPD_CUSTOM_GPIO_PIN};
+  static const uint32_t gpioLengths[] = {14};
+  static const uint32_t gen2Subtypes[] = {TMMPD_CUSTOM_GEN2_Q, TMMPD_CUSTOM_GEN2_LF,
+                                          TMMPD_CUSTOM_GEN2_TARGET};
+  static const uint32_t gen2Lengths[] = {13, 14, 13};
+
+  if ((len < 12) || (TMR_LLRP_RAW_THINGMAGIC_VENDOR != RAW_CUSTOM_VENDOR(p)))
+  {
+    return false;
+  }
+  switch (RAW_CUSTOM_SUBTYPE(p))
+  {
+    case TMMP_CUSTOM_RFPHASE:
+      return (14 == len);
+    case TMMP_CUSTOM_PROTOCOL_ID:
+      return (13 == len);
+    case TMMPD_CUSTOM_GPIO_STATUS:
+      return rawCustomChildrenAre(p, len, gpioSubtypes, gpioLengths, 1);
+    case TMMPD_CUSTOM_GEN2:
+      return rawCustomChildrenAre(p, len, gen2Subtypes, gen2Lengths, 3);
+    default:
+      return false;
+  }
+}
+
+/**
+ * Check that a TagReportData holds an EPC and nothing but read metadata.
+ */
+static bool
+rawTagReportIsPlain(const uint8_t *p, uint32_t len)
+{
+  uint32_t i, plen;
+  bool hasEpc = false;
+
+  for (i = 4; i < len; i += plen)
+  {
+    if (p[i] & 0x80)
+    {
+      uint8_t type = p[i] & 0x7F;
+
+      plen = (type < sizeof(rawTVLength)) ? rawTVLength[type] : 0;
+      if ((0 == plen) || (plen > len - i))
+      {
+        return false;
+      }
+      if (TMR_LLRP_RAW_TV_EPC_96 == type)
+      {
+        hasEpc = true;
+      }
+      continue;
+    }
+
+    plen = rawTLVLength(&p[i], len - i);
+    if (0 == plen)
+    {
+      return false;
+    }
+    switch (RAW_TLV_TYPE(&p[i]))
+    {
+      case TMR_LLRP_RAW_EPC_DATA:
+        {
+          uint32_t epcBytes;
+
+          if (plen < 6)
+          {
+            return false;
+          }
+          epcBytes = (GETU16AT(p, i + 4) + 7u) / 8u;
+          if ((epcBytes > TMR_MAX_EPC_BYTE_COUNT) || (6 + epcBytes != plen))
+          {
+            return false;
+          }
+          hasEpc = true;
+          break;
+        }
+      case TMR_LLRP_RAW_CUSTOM:
+        if (false == rawCustomIsMetadata(&p[i], plen))
+        {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return hasEpc;
+}
+
+/**
+ * Raw frame filter of the LLRP connection. Accepts an RO_ACCESS_REPORT
+ * when every TagReportData in it can be decoded by
+ * TMR_LLRP_parseMetadataFromFrame().
+ *
+ * @param pContext Unused
+ * @param pFrame The received frame, header included
+ * @param nFrame Length of the frame
+ */
+int
+TMR_LLRP_isPlainTagReport(void *pContext, const unsigned char *pFrame, unsigned int nFrame)
+{
+  uint32_t i, len;
+
+  if ((nFrame <= TMR_LLRP_RAW_MESSAGE_HEADER)
+      || (TMR_LLRP_RAW_RO_ACCESS_REPORT != RAW_TLV_TYPE(pFrame)))
+  {
+    return 0;
+  }
+  for (i = TMR_LLRP_RAW_MESSAGE_HEADER; i < nFrame; i += len)
+  {
+    len = rawTLVLength(&pFrame[i], nFrame - i);
+    if ((0 == len) || (TMR_LLRP_RAW_TAG_REPORT_DATA != RAW_TLV_TYPE(&pFrame[i]))
+        || (false == rawTagReportIsPlain(&pFrame[i], len)))
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Iterate over the TagReportData parameters of a raw RO_ACCESS_REPORT.
+ * Returns 0 after the last one, and straight away for a message LTKC
+ * decoded, so callers can run it on every report.
+ *
+ * @param pMsg The report
+ * @param offset 0 for the first TagReportData, else the offset returned for the previous one
+ */
+uint32_t
+TMR_LLRP_nextRawTagReport(const LLRP_tSMessage *pMsg, uint32_t offset)
+{
+  if (0 == offset)
+  {
+    offset = TMR_LLRP_RAW_MESSAGE_HEADER;
+  }
+  else
+  {
+    offset += RAW_TLV_LENGTH(&pMsg->pRawFrame[offset]);
+  }
+  return (offset < pMsg->nRawFrame) ? offset : 0;
+}
+
+/**
+ * Internal method to parse metadata from a raw RO_ACCESS_REPORT.
+ * Same as TMR_LLRP_parseMetadataFromMessage(), for a TagReportData
+ * accepted by TMR_LLRP_isPlainTagReport().
+ *
+ * @param reader Reader pointer
+ * @param data[out] Pointer to TMR_TagReadData
+ * @param pMsg[in] The raw report
+ * @param offset[in] Offset of the TagReportData, from TMR_LLRP_nextRawTagReport()
+ */
+TMR_Status
+TMR_LLRP_parseMetadataFromFrame(TMR_Reader *reader, TMR_TagReadData *data,
+                                const LLRP_tSMessage *pMsg, uint32_t offset)
+{
+  TMR_LLRP_LlrpReader *lr = &reader->u.llrpReader;
+  const uint8_t *p = &pMsg->pRawFrame[offset];
+  uint32_t len = RAW_TLV_LENGTH(p);
+  uint32_t i, plen;
+  uint32_t present = 0;
+  uint64_t lastSeen = 0;
+  uint32_t roSpecId = 0;
+  uint16_t antenna = 0, seenCount = 0, channelIndex = 0, pc = 0, crc = 0;
+  int8_t rssi = 0;
+
+  for (i = 4; i < len; i += plen)
+  {
+    if (p[i] & 0x80)
+    {
+      uint8_t type = p[i] & 0x7F;
+
+      plen = rawTVLength[type];
+      present |= 1u << type;
+      switch (type)
+      {
+        case TMR_LLRP_RAW_TV_EPC_96:
+          data->tag.epcByteCount = 12;
+          memcpy(data->tag.epc, &p[i + 1], data->tag.epcByteCount);
+          break;
+        case TMR_LLRP_RAW_TV_LAST_SEEN_UTC:
+          lastSeen = ((uint64_t)GETU32AT(p, i + 1) << 32) | GETU32AT(p, i + 5);
+          break;
+        case TMR_LLRP_RAW_TV_ANTENNA_ID:
+          antenna = GETU16AT(p, i + 1);
+          break;
+        case TMR_LLRP_RAW_TV_TAG_SEEN_COUNT:
+          seenCount = GETU16AT(p, i + 1);
+          break;
+        case TMR_LLRP_RAW_TV_PEAK_RSSI:
+          rssi = (int8_t)p[i + 1];
+          break;
+        case TMR_LLRP_RAW_TV_CHANNEL_INDEX:
+          channelIndex = GETU16AT(p, i + 1);
+          break;
+        case TMR_LLRP_RAW_TV_ROSPEC_ID:
+          roSpecId = GETU32AT(p, i + 1);
+          break;
+        case TMR_LLRP_RAW_TV_C1G2_PC:
+          pc = GETU16AT(p, i + 1);
+          break;
+        case TMR_LLRP_RAW_TV_C1G2_CRC:
+          crc = GETU16AT(p, i + 1);
+          break;
+        default:
+          break;
+      }
+    }
+    else
+    {
+      plen = RAW_TLV_LENGTH(&p[i]);
+      if (TMR_LLRP_RAW_EPC_DATA == RAW_TLV_TYPE(&p[i]))
+      {
+        data->tag.epcByteCount = (GETU16AT(p, i + 4) + 7u) / 8u;
+        memcpy(data->tag.epc, &p[i + 6], data->tag.epcByteCount);
+      }
+    }
+  }
+
+  if (lr->metadata & TMR_TRD_METADATA_FLAG_TIMESTAMP)
+  {
+    uint64_t msSinceEpoch;
+
+    if (0 == (present & (1u << TMR_LLRP_RAW_TV_LAST_SEEN_UTC)))
+    {
+      return TMR_ERROR_LLRP;
+    }
+    msSinceEpoch = lastSeen / 1000;
+    data->dspMicros = (uint32_t)(msSinceEpoch % 1000);
+    data->timestampHigh = (uint32_t)(msSinceEpoch>>32) & 0xFFFFFFFF;
+    data->timestampLow  = (uint32_t)(msSinceEpoch>> 0) & 0xFFFFFFFF;
+    data->metadataFlags |= TMR_TRD_METADATA_FLAG_TIMESTAMP;
+  }
+
+  if (lr->metadata & TMR_TRD_METADATA_FLAG_ANTENNAID)
+  {
+    if (0 == (present & (1u << TMR_LLRP_RAW_TV_ANTENNA_ID)))
+    {
+      return TMR_ERROR_LLRP;
+    }
+    data->antenna = (uint8_t)antenna;
+    data->metadataFlags |= TMR_TRD_METADATA_FLAG_ANTENNAID;
+  }
+
+  if (lr->metadata & TMR_TRD_METADATA_FLAG_READCOUNT)
+  {
+    if (0 == (present & (1u << TMR_LLRP_RAW_TV_TAG_SEEN_COUNT)))
+    {
+      return TMR_ERROR_LLRP;
+    }
+    data->readCount = seenCount;
+    data->metadataFlags |= TMR_TRD_METADATA_FLAG_READCOUNT;
+  }
+
+  if (lr->metadata & TMR_TRD_METADATA_FLAG_RSSI)
+  {
+    if (0 == (present & (1u << TMR_LLRP_RAW_TV_PEAK_RSSI)))
+    {
+      return TMR_ERROR_LLRP;
+    }
+    data->rssi = rssi;
+    data->metadataFlags |= TMR_TRD_METADATA_FLAG_RSSI;
+  }
+
+  if (lr->metadata & TMR_TRD_METADATA_FLAG_FREQUENCY)
+  {
+    if (0 == (present & (1u << TMR_LLRP_RAW_TV_CHANNEL_INDEX)))
+    {
+      return TMR_ERROR_LLRP;
+    }
+    /* LLRP channel indexes start at one */
+    if ((NULL != lr->capabilities.freqTable.list) && (0 != channelIndex)
+        && (channelIndex <= lr->capabilities.freqTable.len))
+    {
+      data->frequency = lr->capabilities.freqTable.list[channelIndex - 1];
+      data->metadataFlags |= TMR_TRD_METADATA_FLAG_FREQUENCY;
+    }
+  }
+
+  /* The protocol comes from the read plan the ROSpec was built for */
+  if (0 == (present & (1u << TMR_LLRP_RAW_TV_ROSPEC_ID)))
+  {
+    return TMR_ERROR_LLRP;
+  }
+  if (roSpecId < sizeof(lr->readPlanProtocol) / sizeof(lr->readPlanProtocol[0]))
+  {
+    data->tag.protocol = lr->readPlanProtocol[roSpecId].rospecProtocol;
+  }
+  data->metadataFlags |= TMR_TRD_METADATA_FLAG_PROTOCOL;
+
+  if ((lr->metadata & (TMR_TRD_METADATA_FLAG_PHASE | TMR_TRD_METADATA_FLAG_PROTOCOL
+                       | TMR_TRD_METADATA_FLAG_DATA | TMR_TRD_METADATA_FLAG_GPIO_STATUS
+                       | TMR_TRD_METADATA_FLAG_GEN2_Q | TMR_TRD_METADATA_FLAG_GEN2_LF
+                       | TMR_TRD_METADATA_FLAG_GEN2_TARGET))
+      && (((atoi(&lr->capabilities.softwareVersion[0]) == 4)
+           && (atoi(&lr->capabilities.softwareVersion[2]) >= 17))
+          || (atoi(&lr->capabilities.softwareVersion[0]) > 4)))
+  {
+    /* ThingMagic custom metadata, in the order the reader sent it */
+    for (i = 4; i < len; i += plen)
+    {
+      const uint8_t *c = &p[i];
+      uint32_t j;
+      uint8_t n;
+
+      if (c[0] & 0x80)
+      {
+        plen = rawTVLength[c[0] & 0x7F];
+        continue;
+      }
+      plen = RAW_TLV_LENGTH(c);
+      if (TMR_LLRP_RAW_CUSTOM != RAW_TLV_TYPE(c))
+      {
+        continue;
+      }
+
+      if (false == isPerAntennaEnabled)
+      {
+        if (TMMP_CUSTOM_RFPHASE == RAW_CUSTOM_SUBTYPE(c))
+        {
+          data->phase = GETU16AT(c, 12);
+        }
+        continue;
+      }
+
+      switch (RAW_CUSTOM_SUBTYPE(c))
+      {
+        case TMMP_CUSTOM_RFPHASE:
+          if (lr->metadata & TMR_TRD_METADATA_FLAG_PHASE)
+          {
+            data->phase = GETU16AT(c, 12);
+            data->metadataFlags |= TMR_TRD_METADATA_FLAG_PHASE;
+          }
+          break;
+        case TMMP_CUSTOM_PROTOCOL_ID:
+          if (lr->metadata & TMR_TRD_METADATA_FLAG_PROTOCOL)
+          {
+            switch (c[12])
+            {
+              case LLRP_ThingMagicCustomProtocol_Gen2:
+                data->tag.protocol = TMR_TAG_PROTOCOL_GEN2;
+                break;
+              case LLRP_ThingMagicCustomProtocol_Iso180006b:
+                data->tag.protocol = TMR_TAG_PROTOCOL_ISO180006B;
+                break;
+              case LLRP_ThingMagicCustomProtocol_IPX64:
+                data->tag.protocol = TMR_TAG_PROTOCOL_IPX64;
+                break;
+              case LLRP_ThingMagicCustomProtocol_IPX256:
+                data->tag.protocol = TMR_TAG_PROTOCOL_IPX256;
+                break;
+              case LLRP_ThingMagicCustomProtocol_Ata:
+                data->tag.protocol = TMR_TAG_PROTOCOL_ATA;
+                break;
+              default:
+                break;
+            }
+            data->metadataFlags |= TMR_TRD_METADATA_FLAG_PROTOCOL;
+          }
+          break;
+        case TMMPD_CUSTOM_GPIO_STATUS:
+          if (lr->metadata & TMR_TRD_METADATA_FLAG_GPIO_STATUS)
+          {
+            /* GPIOStatus: pin id, then Status and Direction in the top bits */
+            for (j = 12, n = 0;
+                 (j < plen) && (n < sizeof(data->gpio) / sizeof(data->gpio[0]));
+                 j += RAW_TLV_LENGTH(&c[j]), n++)
+            {
+              data->gpio[n].id = c[j + 12];
+              data->gpio[n].high = (c[j + 13] >> 7) & 1;
+              data->gpio[n].output = (c[j + 13] >> 6) & 1;
+            }
+            data->gpioCount = n;
+            data->metadataFlags |= TMR_TRD_METADATA_FLAG_GPIO_STATUS;
+          }
+          break;
+        case TMMPD_CUSTOM_GEN2:
+          for (j = 12; j < plen; j += RAW_TLV_LENGTH(&c[j]))
+          {
+            switch (RAW_CUSTOM_SUBTYPE(&c[j]))
+            {
+              case TMMPD_CUSTOM_GEN2_Q:
+                if (lr->metadata & TMR_TRD_METADATA_FLAG_GEN2_Q)
                 {
-                  LLRP_tSGen2QResponse *pGen2QResponse;
-                  pGen2QResponse = LLRP_ThingMagicMetadataGen2_getGen2QResponse(
-                           (LLRP_tSThingMagicMetadataGen2 *)pParameter);
-                  data->u.gen2.q.u.staticQ.initialQ = LLRP_Gen2QResponse_getQValue(
-                           (LLRP_tSGen2QResponse *)pGen2QResponse);
+                  data->u.gen2.q.u.staticQ.initialQ = c[j + 12];
                   data->metadataFlags |= TMR_TRD_METADATA_FLAG_GEN2_Q;
                 }
-                if(reader->u.llrpReader.metadata & TMR_TRD_METADATA_FLAG_GEN2_LF)
+                break;
+              case TMMPD_CUSTOM_GEN2_LF:
+                if (lr->metadata & TMR_TRD_METADATA_FLAG_GEN2_LF)
                 {
-                  LLRP_tSGen2LFResponse *pGen2LFResponse;
-                  pGen2LFResponse = LLRP_ThingMagicMetadataGen2_getGen2LFResponse(
-                           (LLRP_tSThingMagicMetadataGen2 *)pParameter);
-                  data->u.gen2.lf = LLRP_Gen2LFResponse_getLFValue(
-                           (LLRP_tSGen2LFResponse *)pGen2LFResponse);
+                  data->u.gen2.lf = GETU16AT(c, j + 12);
                   data->metadataFlags |= TMR_TRD_METADATA_FLAG_GEN2_LF;
                 }
-                if(reader->u.llrpReader.metadata & TMR_TRD_METADATA_FLAG_GEN2_TARGET)
+                break;
+              case TMMPD_CUSTOM_GEN2_TARGET:
+                if (lr->metadata & TMR_TRD_METADATA_FLAG_GEN2_TARGET)
                 {
-                  LLRP_tSGen2TargetResponse *pGen2TargetResponse;
-                  pGen2TargetResponse = LLRP_ThingMagicMetadataGen2_getGen2TargetResponse(
-                           (LLRP_tSThingMagicMetadataGen2 *)pParameter);
-                  data->u.gen2.target = LLRP_Gen2TargetResponse_getTargetValue(
-                           (LLRP_tSGen2TargetResponse *)pGen2TargetResponse);
+                  data->u.gen2.target = c[j + 12];
                   data->metadataFlags |= TMR_TRD_METADATA_FLAG_GEN2_TARGET;
                 }
                 break;
@@ -4701,116 +5748,28 @@ TMR_LLRP_parseMetadataFromMessage(TMR_Reader *reader, TMR_TagReadData *data, LLR
                 break;
             }
           }
-        }
-        else
-        {
-          for (pParameter = pTagReportData->listCustom;
-            NULL != pParameter;
-            pParameter = (LLRP_tSParameter *)pParameter->pNextSubParameter)
-          {
-            /**
-             * Currently phase is coming as custom parameter
-             **/ 
-            phase = LLRP_ThingMagicRFPhase_getPhase(
-                (LLRP_tSThingMagicRFPhase *)pParameter);
-
-            /* Copy the value to tagReport */
-            data->phase = phase;
-          }
-        }
+          break;
+        default:
+          break;
       }
     }
+  }
 
-    if (TMR_TAG_PROTOCOL_GEN2 == data->tag.protocol)
+  if (TMR_TAG_PROTOCOL_GEN2 == data->tag.protocol)
+  {
+    if (present & (1u << TMR_LLRP_RAW_TV_C1G2_PC))
     {
-      LLRP_tSParameter *pParameter;
-
-      /**
-       * If protocol is Gen2, extract CRC and PCBits
-       **/
-      for(pParameter = pTagReportData->listAirProtocolTagData;
-          NULL != pParameter;
-          pParameter = (LLRP_tSParameter *)pParameter->pNextSubParameter)
-      {
-        if (&LLRP_tdC1G2_PC == pParameter->elementHdr.pType)
-        {
-          llrp_u16_t pc;
-
-          pc = LLRP_C1G2_PC_getPC_Bits((LLRP_tSC1G2_PC *)pParameter);
-          data->tag.u.gen2.pc[0] = pc & 0xFF;
-          data->tag.u.gen2.pc[1] = (pc & 0xFF00) >> 8;
-
-          data->tag.u.gen2.pcByteCount = 2;
-
-          /** TODO: Add support for XPC bits */
-        }
-        else if (&LLRP_tdC1G2_CRC == pParameter->elementHdr.pType)
-        {
-          data->tag.crc = LLRP_C1G2_CRC_getCRC((LLRP_tSC1G2_CRC *)pParameter);
-        }
-      } /* End of for loop */
+      data->tag.u.gen2.pc[0] = pc & 0xFF;
+      data->tag.u.gen2.pc[1] = (pc & 0xFF00) >> 8;
+      data->tag.u.gen2.pcByteCount = 2;
     }
-
-    /**
-     * Extract OpSpecResults if any. 
-     **/
+    if (present & (1u << TMR_LLRP_RAW_TV_C1G2_CRC))
     {
-      LLRP_tSParameter *pParameter;
-
-      for (pParameter = pTagReportData->listAccessCommandOpSpecResult;
-           NULL != pParameter;
-           pParameter = (LLRP_tSParameter *)pParameter->pNextSubParameter)
-      {
-        /**
-         * Each airProtocol's OpSpecResult is expressed as a different
-         * LLRP parameter. Verify the OpSpecResult status, if not success,
-         * then notify the exception to user.
-         **/
-        TMR_Status retVal;
-
-        retVal = TMR_LLRP_verifyOpSpecResultStatus(reader, pParameter);
-        if (TMR_SUCCESS != retVal)
-        {
-          /**
-           * The OpSpec has failed to execute, notify the execption to 
-           * user.
-           * FIXME: Notifying the error through exception listener.
-           * This is exact behavior in case of continuous reading, 
-           * How do we handle this for sync reads? We can not return
-           * Error though..
-           **/
-#ifdef TMR_ENABLE_BACKGROUND_READS
-          notify_exception_listeners(reader, retVal);
-#endif
-
-          /**
-           * Continue with next OpSpecResult parameter.
-           **/
-          continue;
-        }
-
-        /**
-         * At this point, we have verified the OpSpecResult status,
-         * and it is success.
-         * But currently, only for ReadData (i.e., C1G2ReadOpSpecResult),
-         * we extract the read data and place it in TMR_TagReadData->data
-         * TODO: For other tag operations which return tagop data,
-         * where do we store that?
-         **/
-        if (NULL != &data->data)
-        {
-          TMR_LLRP_parseTagOpSpecData(pParameter, &data->data);
-          data->metadataFlags |= TMR_TRD_METADATA_FLAG_DATA;
-        }
-      } /* End of for loop */
-    } /* End of parsing OpSpecResults */
-  }
-  else
-  {
-    return TMR_ERROR_LLRP;
+      data->tag.crc = crc;
+    }
   }
 
-  return ret;
+  return TMR_SUCCESS;
 }
 
 /**
@@ -10278,6 +11237,32 @@ TMR_LLRP_handleKeepAlive(TMR_Reader *reader, LLRP_tSMessage *pMsg)
   return TMR_SUCCESS;
 }
 
+#if !defined(WIN32) && !defined(WINCE)
+/**
+ * Milliseconds until the next keepalive deadline: the next missed
+ * keepalive, or the point at which the connection is declared lost.
+ */
+static int
+receiver_wait_ms(TMR_LLRP_LlrpReader *lr)
+{
+  uint64_t deadline, now;
+
+  if (lr->keepAliveAckMissCnt < MAX_KEEP_ALIVE_ACK_MISSES)
+  {
+    deadline = lr->ka_start
+      + ((uint64_t)TMR_LLRP_KEEP_ALIVE_TIMEOUT * (lr->keepAliveAckMissCnt + 1));
+  }
+  else
+  {
+    deadline = lr->ka_start + ((uint64_t)TMR_LLRP_KEEP_ALIVE_TIMEOUT * 4);
+  }
+  now = tmr_gettime();
+
+  /* The checks below compare strictly, so wake just past the deadline */
+  return (deadline >= now) ? (int)(deadline - now) + 1 : 0;
+}
+#endif
+
 static void *
 llrp_receiver_thread(void *arg)
 {
@@ -10286,8 +11271,13 @@ llrp_receiver_thread(void *arg)
   TMR_LLRP_LlrpReader *lr;
   LLRP_tSMessage *pMsg;
   LLRP_tSConnection *pConn;
+#if !defined(WIN32) && !defined(WINCE)
+  struct pollfd fds[2];
+  uint8_t drain[16];
+#else
   struct timeval tv;
   fd_set set;
+#endif
   bool ka_start_flag = true;
   bool receive_failed = false;
   static bool mutex_lock_enabled = false;
@@ -10316,6 +11306,48 @@ llrp_receiver_thread(void *arg)
       lr->receiverRunning = true;
       pthread_mutex_unlock(&lr->receiverLock);
 
+      if (true == lr->threadCancel)
+      {
+        /** Time to exit */
+        pthread_exit(NULL);
+      }
+
+      if (ka_start_flag)
+      {
+        lr->ka_start = tmr_gettime();
+        pthread_mutex_lock(&lr->receiverLock);
+        lr->keepAliveAckMissCnt = 0;
+        pthread_mutex_unlock(&lr->receiverLock);
+        ka_start_flag = false;
+      }
+
+#if !defined(WIN32) && !defined(WINCE)
+      /**
+       * Sleep until the reader sends something, we are woken through
+       * the wake pipe, or the next keepalive deadline passes.
+       **/
+      fds[0].fd = pConn->fd;
+      fds[0].events = POLLIN;
+      fds[0].revents = 0;
+      fds[1].fd = lr->receiverWake[0];
+      fds[1].events = POLLIN;
+      fds[1].revents = 0;
+      ret = poll(fds, 2, receiver_wait_ms(lr));
+      if ((0 < ret) && (0 != fds[1].revents))
+      {
+        while (0 < read(lr->receiverWake[0], drain, sizeof(drain)))
+          ;
+        if (0 == fds[0].revents)
+        {
+          /* Woken up only to re-check the receiver state */
+          continue;
+        }
+      }
+      if ((0 < ret) && (0 == fds[0].revents))
+      {
+        ret = 0;
+      }
+#else
       FD_ZERO(&set);
       FD_SET(pConn->fd, &set);
       tv.tv_sec = 0;
@@ -10328,6 +11360,7 @@ llrp_receiver_thread(void *arg)
 #endif
         ret = select(nfds, &set, NULL, NULL, &tv);
 	  }
+#endif
       if (0 < ret)
       {
         if(true == reader->continuousReading)
@@ -10370,8 +11403,8 @@ llrp_receiver_thread(void *arg)
       else
       {
         /**
-         * The select call returns 0. Could be that there is no data
-         * to read because of connection problem.
+         * Nothing to read before the wait expired. Could be that
+         * there is no data because of connection problem.
          **/
         receive_failed = true;
       }
@@ -10386,7 +11419,7 @@ llrp_receiver_thread(void *arg)
     if(true == receive_failed)
     {
       /**
-       * The select call has failed. Could be that there is no data
+       * Nothing arrived. Could be that there is no data
        * to read because of connection problem. Wait to see if
        * the connection recovers back.
        **/
@@ -10446,14 +11479,85 @@ llrp_receiver_thread(void *arg)
   return NULL;
 }
 
+/**
+ * Empty the buffer of RO_ACCESS_REPORTs received during a sync read,
+ * freeing the reports still in it. The array itself is kept for the
+ * next read on this reader, and allocated here on first use.
+ *
+ * @param reader The reader
+ */
+TMR_Status
+TMR_LLRP_resetReportBuffer(TMR_Reader *reader)
+{
+  TMR_LLRP_LlrpReader *lr = &reader->u.llrpReader;
+  uint32_t i;
+
+  for (i = 0; i < lr->bufPointer; i++)
+  {
+    TMR_LLRP_freeMessage(lr->bufResponse[i]);
+  }
+  lr->bufPointer = 0;
+  lr->bufIndex = 0;
+
+  if (NULL == lr->bufResponse)
+  {
+    lr->bufResponse = (LLRP_tSMessage **) malloc(REPORT_BUFFER_INITIAL_SIZE * sizeof(lr->bufResponse[0]));
+    if (NULL == lr->bufResponse)
+    {
+      lr->bufSize = 0;
+      return TMR_ERROR_OUT_OF_MEMORY;
+    }
+    lr->bufSize = REPORT_BUFFER_INITIAL_SIZE;
+  }
+  /* Continuous reading receives into the first slot */
+  lr->bufResponse[0] = NULL;
+
+  return TMR_SUCCESS;
+}
+
+/**
+ * Append a received RO_ACCESS_REPORT to the report buffer, doubling
+ * the buffer when it is full so a long read costs a logarithmic
+ * number of reallocations.
+ *
+ * @param reader The reader
+ * @param pMsg The report, owned by the buffer from now on
+ */
+static TMR_Status
+TMR_LLRP_appendReport(TMR_Reader *reader, LLRP_tSMessage *pMsg)
+{
+  TMR_LLRP_LlrpReader *lr = &reader->u.llrpReader;
+
+  if ((NULL == lr->bufResponse) && (TMR_SUCCESS != TMR_LLRP_resetReportBuffer(reader)))
+  {
+    TMR_LLRP_freeMessage(pMsg);
+    return TMR_ERROR_OUT_OF_MEMORY;
+  }
+  if (lr->bufPointer == lr->bufSize)
+  {
+    LLRP_tSMessage **newResponse;
+
+    newResponse = (LLRP_tSMessage **) realloc(lr->bufResponse, 2 * lr->bufSize * sizeof(lr->bufResponse[0]));
+    if (NULL == newResponse)
+    {
+      /* Drop the report rather than lose the ones already held */
+      TMR_LLRP_freeMessage(pMsg);
+      return TMR_ERROR_OUT_OF_MEMORY;
+    }
+    lr->bufResponse = newResponse;
+    lr->bufSize *= 2;
+  }
+  lr->bufResponse[lr->bufPointer++] = pMsg;
+
+  return TMR_SUCCESS;
+}
+
 TMR_Status
 TMR_LLRP_processReceivedMessage(TMR_Reader *reader, LLRP_tSMessage *pMsg)
 {
   TMR_Status ret;
-  TMR_LLRP_LlrpReader *lr;
 
   ret = TMR_SUCCESS;
-  lr = &reader->u.llrpReader;
 
   /* Check if it is a keepalive */
   if (&LLRP_tdKEEPALIVE == pMsg->elementHdr.pType)
@@ -10474,41 +11578,11 @@ TMR_LLRP_processReceivedMessage(TMR_Reader *reader, LLRP_tSMessage *pMsg)
      * Handle RO_ACCESS_REPORTS,
      * We receive RO_ACCESS_REPORTS here only incase of sync read.
      * Buffer the message pointer, so that it can be used later.
-     **/
-    if (NULL == lr->bufResponse)
-    {
-      /* We haven't had opportunity to allocate the buffer yet, so allocate the
-       * first
-       */
-      lr->bufResponse = (LLRP_tSMessage **) malloc( 1 * sizeof(LLRP_tSMessage *));
-      lr->bufPointer = 0;
-    }
-    lr->bufResponse[lr->bufPointer ] = pMsg;
-
-    /**
-     * Reallocate the memory for bufResponse, so that it can hold the
-     * pointer to next RO_ACCESS_REPORT in case if it is received.
-     **/
-    {
-      LLRP_tSMessage **newResponse;
-
-      newResponse = realloc(lr->bufResponse, (lr->bufPointer + 2) * sizeof(lr->bufResponse[0]));
-      if (NULL == newResponse)
-      {
-        /**
-         * FIXME: How to handle this error. This would'nt happen
-         * in general, but can expect when running on reader.
-         * How to handle this.
-         **/
-      }
-      lr->bufResponse = newResponse;
-    }
-
-    /**
+     *
      * Do not free pMsg here. We hold that memory for further
      * processing of tagReads, and will be freed later.
      **/
-    lr->bufPointer += 1;
+    ret = TMR_LLRP_appendReport(reader, pMsg);
   }
 
   /**
@@ -10551,6 +11625,7 @@ TMR_LLRP_setBackgroundReceiverState(TMR_Reader *reader, bool state)
        **/
       pthread_mutex_lock(&reader->u.llrpReader.receiverLock);
       reader->u.llrpReader.receiverEnabled = false;
+      TMR_LLRP_wakeBackgroundReceiver(reader);
       while (true == reader->u.llrpReader.receiverRunning)
       {
         pthread_cond_wait(&reader->u.llrpReader.receiverCond, &reader->u.llrpReader.receiverLock);
@@ -10570,6 +11645,26 @@ TMR_LLRP_setBackgroundReceiverState(TMR_Reader *reader, bool state)
   }
 }
 
+/**
+ * Wake the background receiver out of its wait so that it re-checks
+ * receiverEnabled and threadCancel.
+ */
+void
+TMR_LLRP_wakeBackgroundReceiver(TMR_Reader *reader)
+{
+#if !defined(WIN32) && !defined(WINCE)
+  uint8_t one = 1;
+  ssize_t rc;
+
+  if (-1 != reader->u.llrpReader.receiverWake[1])
+  {
+    /* A full pipe already guarantees a wake-up, so EAGAIN is fine */
+    rc = write(reader->u.llrpReader.receiverWake[1], &one, 1);
+    (void)rc;
+  }
+#endif
+}
+
 TMR_Status
 TMR_LLRP_startBackgroundReceiver(TMR_Reader *reader)
 {
@@ -10578,6 +11673,19 @@ TMR_LLRP_startBackgroundReceiver(TMR_Reader *reader)
 
   ret = TMR_SUCCESS;
 
+#if !defined(WIN32) && !defined(WINCE)
+  if (-1 == lr->receiverWake[0])
+  {
+    if (0 != pipe(lr->receiverWake))
+    {
+      lr->receiverWake[0] = lr->receiverWake[1] = -1;
+      return TMR_ERROR_NO_THREADS;
+    }
+    fcntl(lr->receiverWake[0], F_SETFL, O_NONBLOCK);
+    fcntl(lr->receiverWake[1], F_SETFL, O_NONBLOCK);
+  }
+#endif
+
   /* Initialize background llrp receiver */
   pthread_mutex_lock(&lr->receiverLock);
 
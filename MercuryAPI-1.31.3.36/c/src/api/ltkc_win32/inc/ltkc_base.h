@@ -50,6 +50,7 @@ struct LLRP_SEncoder;
 struct LLRP_SEncoderOps;
 struct LLRP_SEncoderStream;
 struct LLRP_SEncoderStreamOps;
+struct LLRP_SArena;
 
 
 typedef enum LLRP_ResultCode            LLRP_tResultCode;
@@ -73,6 +74,7 @@ typedef struct LLRP_SEncoder            LLRP_tSEncoder;
 typedef struct LLRP_SEncoderOps         LLRP_tSEncoderOps;
 typedef struct LLRP_SEncoderStream      LLRP_tSEncoderStream;
 typedef struct LLRP_SEncoderStreamOps   LLRP_tSEncoderStreamOps;
+typedef struct LLRP_SArena              LLRP_tSArena;
 
 
 typedef struct
@@ -586,6 +588,16 @@ struct LLRP_SMessage
     llrp_u32_t                  MessageID;
 
     LLRP_tSMessage *            pQueueNext;
+
+    /* Arena holding this message and everything under it, NULL if
+     * the elements were individually allocated */
+    LLRP_tSArena *              pArena;
+
+    /* The frame as received, when a connection's raw frame filter
+     * kept it undecoded. Such a message has no parameters; the
+     * frame lives in the same allocation as the element. */
+    const unsigned char *       pRawFrame;
+    unsigned int                nRawFrame;
 };
 
 struct LLRP_SParameter
@@ -600,13 +612,46 @@ struct LLRP_SParameter
 };
 
 
+/*
+ * Message arena
+ *
+ * A decoder can be given an arena so that a received message,
+ * its parameters and their array fields are carved out of a few
+ * large chunks instead of one malloc() each. The arena is then
+ * owned by the message (LLRP_SMessage.pArena) and released as a
+ * whole by LLRP_Element_destruct() on the message.
+ *
+ * Elements of such a message must not be destructed, cleared or
+ * moved to another element individually; only the whole message
+ * can be destructed. Use the LLRP_xxx_copy() functions to keep a
+ * value beyond the life of the message.
+ */
+
 /*
  * ltkc_element.c
  */
+extern LLRP_tSArena *
+LLRP_Arena_construct (
+  unsigned int                  nChunkSize);
+
+extern void
+LLRP_Arena_destruct (
+  LLRP_tSArena *                pArena);
+
+extern void *
+LLRP_Arena_alloc (
+  LLRP_tSArena *                pArena,
+  unsigned int                  nByte);
+
 LLRP_tSElement *
 LLRP_Element_construct (
   const LLRP_tSTypeDescriptor *  pTypeDescriptor);
 
+LLRP_tSElement *
+LLRP_Element_constructInArena (
+  const LLRP_tSTypeDescriptor *  pTypeDescriptor,
+  LLRP_tSArena *                pArena);
+
 extern void
 LLRP_Element_destruct (
   LLRP_tSElement *              pElement);
@@ -42,6 +42,12 @@ extern "C" {
 struct LLRP_SConnection;
 typedef struct LLRP_SConnection     LLRP_tSConnection;
 
+/* Returns TRUE to queue a complete frame undecoded */
+typedef int (*LLRP_tRawFrameFilter) (
+  void *                        pContext,
+  const unsigned char *         pFrame,
+  unsigned int                  nFrame);
+
 
 /**
  *****************************************************************************
@@ -92,6 +98,15 @@ struct LLRP_SConnection
     /** Size of the send/recv buffers, below, specified at construct() time */
     unsigned int                nBufferSize;
 
+    /** TRUE to decode each received message into its own arena.
+     ** See LLRP_Conn_setDecodeArena(). */
+    int                         bDecodeArena;
+
+    /** Frames this accepts skip the decoder, see
+     ** LLRP_Conn_setRawFrameFilter(). NULL to decode everything. */
+    LLRP_tRawFrameFilter        pfRawFrameFilter;
+    void *                      pRawFrameContext;
+
     /** Receive state */
     struct
     {
@@ -190,6 +205,17 @@ extern const LLRP_tSErrorDetails *
 LLRP_Conn_getRecvError (
   LLRP_tSConnection *           pConn);
 
+extern void
+LLRP_Conn_setDecodeArena (
+  LLRP_tSConnection *           pConn,
+  int                           bDecodeArena);
+
+extern void
+LLRP_Conn_setRawFrameFilter (
+  LLRP_tSConnection *           pConn,
+  LLRP_tRawFrameFilter          pfRawFrameFilter,
+  void *                        pContext);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
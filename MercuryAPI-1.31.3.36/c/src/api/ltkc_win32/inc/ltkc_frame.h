@@ -61,6 +61,10 @@ struct LLRP_SFrameDecoder
     unsigned int                iNext;
     unsigned int                BitFieldBuffer;
     unsigned int                nBitFieldResid;
+
+    /* When not NULL, elements and arrays are allocated from here
+     * and the decoded message takes ownership of the arena */
+    LLRP_tSArena *              pArena;
 };
 
 extern LLRP_tSFrameExtract
@@ -71,6 +71,15 @@ recvAdvance (
   int                           nMaxMS,
   time_t                        timeLimit);
 
+static LLRP_tSMessage *
+recvRawFrame (
+  LLRP_tSConnection *           pConn);
+
+static void
+recvEnqueue (
+  LLRP_tSConnection *           pConn,
+  LLRP_tSMessage *              pMessage);
+
 static time_t
 calculateTimeLimit (
   int                           nMaxMS);
@@ -784,6 +793,63 @@ LLRP_Conn_getRecvError (
 }
 
 
+/**
+ *****************************************************************************
+ **
+ ** @brief  Choose how received messages are allocated
+ **
+ ** With bDecodeArena TRUE each message decoded from now on is built
+ ** in an arena of its own: a handful of large allocations instead
+ ** of one per parameter and per array field. LLRP_Element_destruct()
+ ** on the message releases the arena in one go. The parts of such a
+ ** message cannot be destructed or detached individually.
+ **
+ ** @param[in]  pConn           Pointer to the connection instance.
+ ** @param[in]  bDecodeArena    TRUE to use an arena per message
+ **
+ *****************************************************************************/
+
+void
+LLRP_Conn_setDecodeArena (
+  LLRP_tSConnection *           pConn,
+  int                           bDecodeArena)
+{
+    pConn->bDecodeArena = bDecodeArena;
+}
+
+
+/**
+ *****************************************************************************
+ **
+ ** @brief  Let the application take some frames undecoded
+ **
+ ** Every complete frame is offered to pfRawFrameFilter before it is
+ ** decoded. When the filter returns TRUE the frame is not decoded;
+ ** the received message is an element of the frame's message type
+ ** with no fields or parameters set, MessageID filled in, and
+ ** pRawFrame/nRawFrame holding a copy of the whole frame. It is
+ ** queued, returned and destructed like any other message.
+ **
+ ** The filter runs on the receiving thread for every frame, so it
+ ** should be cheap. Custom (vendor) messages are always decoded.
+ **
+ ** @param[in]  pConn           Pointer to the connection instance.
+ ** @param[in]  pfRawFrameFilter The filter, NULL to decode all frames
+ ** @param[in]  pContext        Passed through to the filter
+ **
+ *****************************************************************************/
+
+void
+LLRP_Conn_setRawFrameFilter (
+  LLRP_tSConnection *           pConn,
+  LLRP_tRawFrameFilter          pfRawFrameFilter,
+  void *                        pContext)
+{
+    pConn->pfRawFrameFilter = pfRawFrameFilter;
+    pConn->pRawFrameContext = pContext;
+}
+
+
 /**
  *****************************************************************************
  **
@@ -1154,7 +1220,24 @@ recvAdvance (
              */
             LLRP_tSFrameDecoder *   pDecoder;
             LLRP_tSMessage *        pMessage;
-            LLRP_tSMessage **       ppMessageTail;
+            LLRP_tSArena *          pArena = NULL;
+
+            /*
+             * Frames the application wants as they are skip the
+             * decoder. If the copy cannot be made, decode after all.
+             */
+            if(NULL != pConn->pfRawFrameFilter &&
+               pConn->pfRawFrameFilter(pConn->pRawFrameContext,
+                    pConn->Recv.pBuffer,
+                    pConn->Recv.FrameExtract.MessageLength))
+            {
+                pMessage = recvRawFrame(pConn);
+                if(NULL != pMessage)
+                {
+                    recvEnqueue(pConn, pMessage);
+                    break;
+                }
+            }
 
             /*
              * Construct a new frame decoder. It needs the registry
@@ -1176,6 +1259,21 @@ recvAdvance (
                 break;
             }
 
+            /*
+             * If asked, give the decoder an arena for the message.
+             * A decoded tag report takes about twelve times the size
+             * of its frame; the arena grows by further chunks if
+             * that is not enough.
+             * Without an arena the decode simply falls back to
+             * allocating each element.
+             */
+            if(pConn->bDecodeArena)
+            {
+                pArena = LLRP_Arena_construct(
+                            16u * pConn->Recv.FrameExtract.MessageLength);
+                pDecoder->pArena = pArena;
+            }
+
             /*
              * Now ask the nice, brand new decoder to decode the frame.
              * It returns NULL for some kind of error.
@@ -1211,6 +1309,12 @@ recvAdvance (
                         LLRP_RC_MiscError, "NULL message but no error");
                 }
 
+                /*
+                 * Whatever was decoded before the error lives in
+                 * the arena and goes with it.
+                 */
+                LLRP_Arena_destruct(pArena);
+
                 /*
                  * All we can do is discard the frame.
                  */
@@ -1223,22 +1327,7 @@ recvAdvance (
             /*
              * Yay! It worked. Enqueue the message.
              */
-            ppMessageTail = &pConn->pInputQueue;
-            while(NULL != *ppMessageTail)
-            {
-                ppMessageTail = &(*ppMessageTail)->pQueueNext;
-            }
-
-            pMessage->pQueueNext = NULL;
-            *ppMessageTail = pMessage;
-
-            /*
-             * Note that the frame is valid. Consult
-             * Recv.FrameExtract.MessageLength.
-             * Clear the buffer count to be ready for next time.
-             */
-            pConn->Recv.bFrameValid = TRUE;
-            pConn->Recv.nBuffer = 0;
+            recvEnqueue(pConn, pMessage);
 
             break;
         }
@@ -1256,6 +1345,106 @@ recvAdvance (
 }
 
 
+/**
+ *****************************************************************************
+ **
+ ** @brief  Internal routine to keep the frame in the receive buffer
+ **         as an undecoded message
+ **
+ ** One allocation holds the bare message element followed by a copy
+ ** of the frame, so the usual LLRP_Element_destruct() frees both.
+ **
+ ** @param[in]  pConn           Pointer to the connection instance.
+ **
+ ** @return     The message, NULL if the frame has to be decoded
+ **
+ *****************************************************************************/
+
+static LLRP_tSMessage *
+recvRawFrame (
+  LLRP_tSConnection *           pConn)
+{
+    const LLRP_tSTypeDescriptor *pTypeDescriptor;
+    LLRP_tSMessage *            pMessage;
+    unsigned char *             pFrame;
+    unsigned int                nElement;
+    unsigned int                nFrame;
+
+    /*
+     * A custom message type also needs its vendor and subtype,
+     * which is the decoder's business.
+     */
+    if(1023u == pConn->Recv.FrameExtract.MessageType)
+    {
+        return NULL;
+    }
+
+    pTypeDescriptor = LLRP_TypeRegistry_lookupMessage(pConn->pTypeRegistry,
+            pConn->Recv.FrameExtract.MessageType);
+    if(NULL == pTypeDescriptor)
+    {
+        return NULL;
+    }
+
+    nFrame   = pConn->Recv.FrameExtract.MessageLength;
+    nElement = (pTypeDescriptor->nSizeBytes + 7u) & ~7u;
+
+    pMessage = (LLRP_tSMessage *)malloc(nElement + nFrame);
+    if(NULL == pMessage)
+    {
+        return NULL;
+    }
+    memset(pMessage, 0, pTypeDescriptor->nSizeBytes);
+
+    pFrame = (unsigned char *) pMessage + nElement;
+    memcpy(pFrame, pConn->Recv.pBuffer, nFrame);
+
+    pMessage->elementHdr.pType = pTypeDescriptor;
+    pMessage->MessageID        = pConn->Recv.FrameExtract.MessageID;
+    pMessage->pRawFrame        = pFrame;
+    pMessage->nRawFrame        = nFrame;
+
+    return pMessage;
+}
+
+
+/**
+ *****************************************************************************
+ **
+ ** @brief  Internal routine to queue a received message and mark
+ **         the frame it came from as done
+ **
+ ** @param[in]  pConn           Pointer to the connection instance.
+ ** @param[in]  pMessage        The message
+ **
+ *****************************************************************************/
+
+static void
+recvEnqueue (
+  LLRP_tSConnection *           pConn,
+  LLRP_tSMessage *              pMessage)
+{
+    LLRP_tSMessage **           ppMessageTail;
+
+    ppMessageTail = &pConn->pInputQueue;
+    while(NULL != *ppMessageTail)
+    {
+        ppMessageTail = &(*ppMessageTail)->pQueueNext;
+    }
+
+    pMessage->pQueueNext = NULL;
+    *ppMessageTail = pMessage;
+
+    /*
+     * Note that the frame is valid. Consult
+     * Recv.FrameExtract.MessageLength.
+     * Clear the buffer count to be ready for next time.
+     */
+    pConn->Recv.bFrameValid = TRUE;
+    pConn->Recv.nBuffer = 0;
+}
+
+
 /**
  *****************************************************************************
  **
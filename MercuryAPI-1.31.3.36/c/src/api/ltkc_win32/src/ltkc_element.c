@@ -23,6 +23,149 @@
 #include "ltkc_base.h"
 
 
+/*
+ * Arena chunks are linked newest first. The usable space follows
+ * the header, rounded so that every allocation is suitably aligned
+ * for any field type an element can hold.
+ */
+typedef struct LLRP_SArenaChunk         LLRP_tSArenaChunk;
+
+struct LLRP_SArenaChunk
+{
+    LLRP_tSArenaChunk *         pNext;
+    unsigned int                nSize;
+    unsigned int                nUsed;
+};
+
+struct LLRP_SArena
+{
+    /* Chunk currently being carved, head of the chunk list */
+    LLRP_tSArenaChunk *         pChunk;
+
+    /* Usable size of each chunk after the first */
+    unsigned int                nChunkSize;
+};
+
+typedef union
+{
+    void *                      p;
+    llrp_u64_t                  u64;
+    double                      d;
+} LLRP_tUArenaAlign;
+
+#define ARENA_ROUNDUP(n) \
+    (((n) + sizeof(LLRP_tUArenaAlign) - 1u) & \
+        ~(unsigned int)(sizeof(LLRP_tUArenaAlign) - 1u))
+
+#define ARENA_CHUNK_DATA(pChunk) \
+    ((unsigned char *)(pChunk) + ARENA_ROUNDUP(sizeof(LLRP_tSArenaChunk)))
+
+static LLRP_tSArenaChunk *
+arenaNewChunk (
+  unsigned int                  nSize)
+{
+    LLRP_tSArenaChunk *         pChunk;
+
+    pChunk = (LLRP_tSArenaChunk *)malloc(ARENA_ROUNDUP(sizeof *pChunk) + nSize);
+    if(NULL != pChunk)
+    {
+        pChunk->pNext = NULL;
+        pChunk->nSize = nSize;
+        pChunk->nUsed = 0;
+    }
+
+    return pChunk;
+}
+
+LLRP_tSArena *
+LLRP_Arena_construct (
+  unsigned int                  nChunkSize)
+{
+    LLRP_tSArenaChunk *         pChunk;
+    LLRP_tSArena *              pArena;
+
+    nChunkSize = ARENA_ROUNDUP(nChunkSize);
+    if(256u > nChunkSize)
+    {
+        nChunkSize = 256u;
+    }
+
+    /*
+     * The arena itself lives at the start of its first chunk
+     * so that a message that fits costs a single malloc().
+     */
+    pChunk = arenaNewChunk(ARENA_ROUNDUP(sizeof *pArena) + nChunkSize);
+    if(NULL == pChunk)
+    {
+        return NULL;
+    }
+
+    pArena = (LLRP_tSArena *) ARENA_CHUNK_DATA(pChunk);
+    pChunk->nUsed = ARENA_ROUNDUP(sizeof *pArena);
+
+    pArena->pChunk     = pChunk;
+    pArena->nChunkSize = nChunkSize;
+
+    return pArena;
+}
+
+void
+LLRP_Arena_destruct (
+  LLRP_tSArena *                pArena)
+{
+    LLRP_tSArenaChunk *         pChunk;
+    LLRP_tSArenaChunk *         pNext;
+
+    if(NULL == pArena)
+    {
+        return;
+    }
+
+    /*
+     * The first chunk, which holds the arena, is the last one
+     * on the list, so pArena is not touched after it is freed.
+     */
+    for(pChunk = pArena->pChunk; NULL != pChunk; pChunk = pNext)
+    {
+        pNext = pChunk->pNext;
+        free(pChunk);
+    }
+}
+
+void *
+LLRP_Arena_alloc (
+  LLRP_tSArena *                pArena,
+  unsigned int                  nByte)
+{
+    LLRP_tSArenaChunk *         pChunk = pArena->pChunk;
+    void *                      pValue;
+
+    nByte = ARENA_ROUNDUP(nByte);
+
+    if(nByte > pChunk->nSize - pChunk->nUsed)
+    {
+        unsigned int            nSize = pArena->nChunkSize;
+
+        if(nByte > nSize)
+        {
+            nSize = nByte;
+        }
+
+        pChunk = arenaNewChunk(nSize);
+        if(NULL == pChunk)
+        {
+            return NULL;
+        }
+
+        pChunk->pNext = pArena->pChunk;
+        pArena->pChunk = pChunk;
+    }
+
+    pValue = ARENA_CHUNK_DATA(pChunk) + pChunk->nUsed;
+    pChunk->nUsed += nByte;
+
+    return pValue;
+}
 
 
 LLRP_tSElement *
@@ -42,12 +185,46 @@ LLRP_Element_construct (
     return pElement;
 }
 
+LLRP_tSElement *
+LLRP_Element_constructInArena (
+  const LLRP_tSTypeDescriptor *  pTypeDescriptor,
+  LLRP_tSArena *                pArena)
+{
+    LLRP_tSElement *            pElement;
+
+    if(NULL == pArena)
+    {
+        return LLRP_Element_construct(pTypeDescriptor);
+    }
+
+    pElement = (LLRP_tSElement *)LLRP_Arena_alloc(pArena, pTypeDescriptor->nSizeBytes);
+    if(NULL != pElement)
+    {
+        memset(pElement, 0, pTypeDescriptor->nSizeBytes);
+
+        pElement->pType = pTypeDescriptor;
+    }
+
+    return pElement;
+}
+
 void
 LLRP_Element_destruct (
   LLRP_tSElement *              pElement)
 {
     if(NULL != pElement)
     {
+        /*
+         * A message decoded into an arena goes away with the arena,
+         * along with all of its parameters and their arrays.
+         */
+        if(pElement->pType->bIsMessage &&
+           NULL != ((LLRP_tSMessage *) pElement)->pArena)
+        {
+            LLRP_Arena_destruct(((LLRP_tSMessage *) pElement)->pArena);
+            return;
+        }
+
         pElement->pType->pfDestruct(pElement);
     }
 }
@@ -250,10 +250,39 @@ verifyVectorAllocation (
   const void *                  pValue,
   const LLRP_tSFieldDescriptor *pFieldDescriptor);
 
+static LLRP_tSElement *
+constructElement (
+  LLRP_tSFrameDecoder *         pDecoder,
+  const LLRP_tSTypeDescriptor * pTypeDescriptor);
+
+static void
+discardElement (
+  LLRP_tSFrameDecoder *         pDecoder,
+  LLRP_tSElement *              pElement);
+
 /*
  * END forward decls
  */
 
+/*
+ * Storage for a vector field of nCount elements. From the decoder's
+ * arena when it has one, otherwise from the usual LLRP_xxx_construct().
+ */
+#define CONSTRUCT_VECTOR(pDecoder, Value, nCount, pfConstruct)         \
+    do                                                                  \
+    {                                                                   \
+        if(NULL != (pDecoder)->pArena)                                  \
+        {                                                               \
+            (Value).pValue = LLRP_Arena_alloc((pDecoder)->pArena,       \
+                                (nCount) * sizeof (Value).pValue[0]);   \
+            (Value).nValue = (NULL != (Value).pValue) ? (nCount) : 0;   \
+        }                                                               \
+        else                                                            \
+        {                                                               \
+            (Value) = pfConstruct(nCount);                              \
+        }                                                               \
+    } while(0)
+
 
 
 static LLRP_tSDecoderOps
@@ -496,7 +525,8 @@ get_u8v (
     {
         if(checkAvailable(pDecoderStream, 1u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_u8v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_u8v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -531,7 +561,8 @@ get_s8v (
     {
         if(checkAvailable(pDecoderStream, 1u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_s8v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_s8v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -610,7 +641,8 @@ get_u16v (
     {
         if(checkAvailable(pDecoderStream, 2u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_u16v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_u16v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -645,7 +677,8 @@ get_s16v (
     {
         if(checkAvailable(pDecoderStream, 2u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_s16v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_s16v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -724,7 +757,8 @@ get_u32v (
     {
         if(checkAvailable(pDecoderStream, 4u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_u32v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_u32v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -759,7 +793,8 @@ get_s32v (
     {
         if(checkAvailable(pDecoderStream, 4u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_s32v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_s32v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -838,7 +873,8 @@ get_u64v (
     {
         if(checkAvailable(pDecoderStream, 8u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_u64v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_u64v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -873,7 +909,8 @@ get_s64v (
     {
         if(checkAvailable(pDecoderStream, 8u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_s64v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_s64v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -925,7 +962,16 @@ get_u1v (
 
         if(checkAvailable(pDecoderStream, nByte, pFieldDescriptor))
         {
-            Value = LLRP_u1v_construct(nBit);
+            if(NULL != pDecoderStream->pDecoder->pArena)
+            {
+                Value.pValue = (llrp_u8_t *)LLRP_Arena_alloc(
+                                    pDecoderStream->pDecoder->pArena, nByte);
+                Value.nBit = (NULL != Value.pValue) ? nBit : 0;
+            }
+            else
+            {
+                Value = LLRP_u1v_construct(nBit);
+            }
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -1002,7 +1048,8 @@ get_utf8v (
     {
         if(checkAvailable(pDecoderStream, 1u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_utf8v_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_utf8v_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -1037,7 +1084,8 @@ get_bytesToEnd (
     {
         if(checkAvailable(pDecoderStream, 1u * nValue, pFieldDescriptor))
         {
-            Value = LLRP_bytesToEnd_construct(nValue);
+            CONSTRUCT_VECTOR(pDecoderStream->pDecoder, Value, nValue,
+                LLRP_bytesToEnd_construct);
             if(verifyVectorAllocation(pDecoderStream, Value.pValue,
                                 pFieldDescriptor))
             {
@@ -1348,7 +1396,7 @@ decodeMessage (
 
     pDecoderStream->pRefType = pTypeDescriptor;
 
-    pElement = LLRP_Element_construct(pTypeDescriptor);
+    pElement = constructElement(pDecoder, pTypeDescriptor);
 
     if(NULL == pElement)
     {
@@ -1367,7 +1415,7 @@ decodeMessage (
 
     if(LLRP_RC_OK != pError->eResultCode)
     {
-        LLRP_Element_destruct(pElement);
+        discardElement(pDecoder, pElement);
         return NULL;
     }
 
@@ -1415,7 +1463,7 @@ decodeMessage (
 
     if(LLRP_RC_OK != pError->eResultCode)
     {
-        LLRP_Element_destruct(pElement);
+        discardElement(pDecoder, pElement);
         return NULL;
     }
 
@@ -1423,10 +1471,12 @@ decodeMessage (
 
     if(LLRP_RC_OK != pError->eResultCode)
     {
-        LLRP_Element_destruct(pElement);
+        discardElement(pDecoder, pElement);
         return NULL;
     }
 
+    pMessage->pArena = pDecoder->pArena;
+
     return pMessage;
 }
 
@@ -1576,7 +1626,7 @@ decodeParameter (
 
     pDecoderStream->pRefType = pTypeDescriptor;
 
-    pElement = LLRP_Element_construct(pTypeDescriptor);
+    pElement = constructElement(pDecoder, pTypeDescriptor);
 
     if(NULL == pElement)
     {
@@ -1594,7 +1644,7 @@ decodeParameter (
 
     if(LLRP_RC_OK != pError->eResultCode)
     {
-        LLRP_Element_destruct(pElement);
+        discardElement(pDecoder, pElement);
         return NULL;
     }
 
@@ -1644,7 +1694,7 @@ decodeParameter (
 
         if(LLRP_RC_OK != pError->eResultCode)
         {
-            LLRP_Element_destruct(pElement);
+            discardElement(pDecoder, pElement);
             return NULL;
         }
 
@@ -1652,7 +1702,7 @@ decodeParameter (
 
         if(LLRP_RC_OK != pError->eResultCode)
         {
-            LLRP_Element_destruct(pElement);
+            discardElement(pDecoder, pElement);
             return NULL;
         }
     }
@@ -1798,3 +1848,27 @@ verifyVectorAllocation (
     }
 }
 
+
+static LLRP_tSElement *
+constructElement (
+  LLRP_tSFrameDecoder *         pDecoder,
+  const LLRP_tSTypeDescriptor * pTypeDescriptor)
+{
+    return LLRP_Element_constructInArena(pTypeDescriptor, pDecoder->pArena);
+}
+
+static void
+discardElement (
+  LLRP_tSFrameDecoder *         pDecoder,
+  LLRP_tSElement *              pElement)
+{
+    /*
+     * Arena elements are reclaimed when whoever owns the arena
+     * releases it. Destructing them here would free() memory
+     * that malloc() never handed out.
+     */
+    if(NULL == pDecoder->pArena)
+    {
+        LLRP_Element_destruct(pElement);
+    }
+}
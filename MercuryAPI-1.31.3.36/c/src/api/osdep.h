@@ -89,6 +89,14 @@ uint32_t tmr_gettime_low(void);
  */
 uint32_t tmr_gettime_high(void);
 
+/**
+ * Return a microsecond counter that only moves forward at a steady
+ * rate, unaffected by changes to the wall clock.  Its origin is
+ * arbitrary.  Used to timestamp tag reads and to time operations;
+ * tag timestamps are converted to wall clock time only when reported.
+ */
+uint64_t tmr_gettime_us(void);
+
 /**
  * Suspend operation for a given duration.
  * @param sleepms The number of milliseconds to sleep for.
@@ -41,6 +41,22 @@ tmr_gettime(void)
   return millis();
 }
 
+uint64_t
+tmr_gettime_us(void)
+{
+  static uint32_t last, wraps;
+  uint32_t now;
+
+  /* micros() wraps every 71 minutes */
+  now = micros();
+  if (now < last)
+  {
+    wraps++;
+  }
+  last = now;
+  return ((uint64_t)wraps << 32) | now;
+}
+
 uint32_t
 tmr_gettime_low(void)
 {
@@ -17,6 +17,14 @@ uint32_t tmr_gettime_low()
   return 0;
 }
 
+uint64_t tmr_gettime_us()
+{
+  /* Fill in with code that returns a monotonic microsecond counter.
+   * It must not jump when the wall clock is set.
+   */
+  return 0;
+}
+
 uint32_t tmr_gettime_high()
 {
   /* Fill in with code that returns the hugh 32 bits of a millisecond
@@ -30,6 +30,7 @@
 
 #include <time.h>
 #include <sys/time.h>
+#include <mach/mach_time.h>
 
 #include "osdep.h"
 
@@ -45,6 +46,20 @@ tmr_gettime()
     return totalms;
 }
 
+uint64_t
+tmr_gettime_us()
+{
+    static mach_timebase_info_data_t timebase;
+    uint64_t ticks;
+
+    if (0 == timebase.denom)
+    {
+        mach_timebase_info(&timebase);
+    }
+    ticks = mach_absolute_time();
+    return (ticks / 1000) * timebase.numer / timebase.denom;
+}
+
 uint32_t
 tmr_gettime_low()
 {
@@ -45,6 +45,15 @@ tmr_gettime()
   return totalms;
 }
 
+uint64_t
+tmr_gettime_us()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (((uint64_t)ts.tv_sec) * 1000000) + ((uint64_t)ts.tv_nsec) / 1000;
+}
+
 uint32_t
 tmr_gettime_low()
 {
@@ -29,6 +29,13 @@ tmr_gettime(void)
 	return 0;
 }
 
+uint64_t 
+tmr_gettime_us(void)
+{
+	/* Only the millisecond SysTick counter is available */
+	return tmr_gettime() * 1000;
+}
+
 uint32_t 
 tmr_gettime_low()
 {
@@ -28,6 +28,12 @@ uint64_t tmr_gettime(void)
   return 0; 
 }
 
+uint64_t tmr_gettime_us(void)
+{
+  /* Only the millisecond SysTick counter is available */
+  return tmr_gettime() * 1000;
+}
+
 uint32_t tmr_gettime_low()
 {
   /* Fill in with code that returns the low 32 bits of a millisecond
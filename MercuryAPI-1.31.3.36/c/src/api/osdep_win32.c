@@ -54,6 +54,17 @@ tmr_gettime()
   return unixms;
 }
 
+uint64_t
+tmr_gettime_us()
+{
+  LARGE_INTEGER count, frequency;
+
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&frequency);
+  return (uint64_t)((count.QuadPart / frequency.QuadPart) * 1000000 +
+                    ((count.QuadPart % frequency.QuadPart) * 1000000) / frequency.QuadPart);
+}
+
 uint32_t
 tmr_gettime_low()
 {
@@ -121,6 +121,10 @@ readasyncGPIOControl: ../samples/readasyncGPIOControl.o $(LIB)
 readcustomtransport: ../samples/readcustomtransport.o $(LIB)
 	$(CC) $(CFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)	
 
+../samples/simulator.o: $(HEADERS) $(LIB)
+simulator: ../samples/simulator.o $(LIB)
+	$(CC) $(CFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)
+
 ../samples/savedreadplanconfig.o: $(HEADERS) $(LIB)
 savedreadplanconfig: ../samples/savedreadplanconfig.o $(LIB)
 	$(CC) $(CFLAGS) -o $@ $^ -lpthread $(LTKC_LIBS)	
@@ -49,25 +49,15 @@ extern bool isEmbeddedTagopEnabled;
 extern bool isSecureAccessEnabled;
 
 static TMR_Status
-initTxRxMapFromPorts(TMR_Reader *reader)
+initTxRxMap(TMR_Reader *reader, const TMR_SR_PortDetect *ports, uint8_t numPorts)
 {
-  TMR_Status ret;
-  TMR_SR_PortDetect ports[TMR_SR_MAX_ANTENNA_PORTS];
-  uint8_t i, numPorts;
+  uint8_t i;
   TMR_SR_SerialReader *sr;
   TMR_AntennaMap *defMap = (TMR_AntennaMap *)malloc(TMR_SR_MAX_ANTENNA_PORTS * sizeof(TMR_AntennaMap));
   TMR_AntennaMapList *defMapList = (TMR_AntennaMapList *)malloc(sizeof(TMR_AntennaMapList));
 
-  numPorts = numberof(ports);
   sr = &reader->u.serialReader;
 
-  /* Need number of ports to set up Tx-Rx map */
-  ret = TMR_SR_cmdAntennaDetect(reader, &numPorts, ports);
-  if (TMR_SUCCESS != ret)
-  {
-    return ret;
-  }
-
   /* Modify TxRxMap according to reader product */
   switch (sr->productId)
   {
@@ -156,6 +146,201 @@ initTxRxMapFromPorts(TMR_Reader *reader)
   return TMR_SUCCESS;
 }
 
+static TMR_Status
+initTxRxMapFromPorts(TMR_Reader *reader)
+{
+  TMR_Status ret;
+  TMR_SR_PortDetect ports[TMR_SR_MAX_ANTENNA_PORTS];
+  uint8_t numPorts;
+
+  numPorts = numberof(ports);
+
+  /* Need number of ports to set up Tx-Rx map */
+  ret = TMR_SR_cmdAntennaDetect(reader, &numPorts, ports);
+  if (TMR_SUCCESS != ret)
+  {
+    return ret;
+  }
+  return initTxRxMap(reader, ports, numPorts);
+}
+
+/**
+ * Forget cached parameter values that setting key may have changed,
+ * or all of them for TMR_PARAM_NONE.
+ */
+static void
+paramCacheInvalidate(TMR_SR_SerialReader *sr, TMR_Param key)
+{
+  switch (key)
+  {
+  case TMR_PARAM_NONE:
+  case TMR_PARAM_USER_CONFIG:
+    memset(sr->paramCached, 0, sizeof(sr->paramCached));
+    break;
+
+  case TMR_PARAM_REGION_ID:
+    /* Power limits are per region */
+    BITCLR(sr->paramCached, TMR_PARAM_RADIO_POWERMAX);
+    BITCLR(sr->paramCached, TMR_PARAM_RADIO_POWERMIN);
+    break;
+
+  default:
+    BITCLR(sr->paramCached, key);
+  }
+}
+
+static TMR_Status getSerialNumber(struct TMR_Reader *reader, void *value);
+static void paramCachePut(TMR_SR_SerialReader *sr, TMR_Param key, const void *value);
+
+/**
+ * Read the session record from /reader/session/file, if one is set,
+ * and keep the record only if it is from a session with this URI.
+ */
+static void
+sessionLoad(TMR_Reader *reader)
+{
+  TMR_SR_SerialReader *sr;
+  TMR_SR_SessionRecord *s;
+#ifdef TMR_ENABLE_STDIO
+  FILE *fp;
+#endif
+
+  sr = &reader->u.serialReader;
+  s = &sr->session;
+#ifdef TMR_ENABLE_STDIO
+  if ('\0' != sr->sessionFile[0])
+  {
+    s->magic = 0;
+    fp = fopen(sr->sessionFile, "rb");
+    if (NULL != fp)
+    {
+      if (1 != fread(s, sizeof(*s), 1, fp))
+      {
+        s->magic = 0;
+      }
+      fclose(fp);
+    }
+  }
+#endif
+  if ((TMR_SR_SESSION_MAGIC != s->magic) || (sizeof(*s) != s->size)
+      || (0 != strncmp(s->uri, reader->uri, sizeof(s->uri)))
+      || (0 == s->portCount) || (s->portCount > TMR_SR_MAX_ANTENNA_PORTS))
+  {
+    s->magic = 0;
+  }
+  s->serial[sizeof(s->serial) - 1] = '\0';
+}
+
+/**
+ * Decide whether this boot may take its discovery from the session
+ * record: the module must report the recorded firmware, in the
+ * version reply probing got, and the recorded serial number.
+ */
+static TMR_Status
+sessionResume(TMR_Reader *reader)
+{
+  TMR_Status ret;
+  TMR_SR_SerialReader *sr;
+  TMR_SR_SessionRecord *s;
+  TMR_String serial;
+  char buf[TMR_SR_PARAM_CACHE_STRING];
+
+  sr = &reader->u.serialReader;
+  s = &sr->session;
+  sr->sessionResumed = false;
+  if (false == sr->sessionEnable)
+  {
+    return TMR_SUCCESS;
+  }
+
+  /* Needed for the record either way */
+  serial.value = buf;
+  serial.max = sizeof(buf);
+  ret = getSerialNumber(reader, &serial);
+  if (TMR_SUCCESS != ret)
+  {
+    /* Can't tell the module apart, so never resume with it */
+    s->magic = 0;
+    s->serial[0] = '\0';
+    return TMR_SUCCESS;
+  }
+  paramCachePut(sr, TMR_PARAM_VERSION_SERIAL, &serial);
+
+  sr->sessionResumed = (TMR_SR_SESSION_MAGIC == s->magic)
+    && (0 == memcmp(&s->versionInfo, &sr->versionInfo, sizeof(s->versionInfo)))
+    && (0 == strcmp(s->serial, buf));
+  if (false == sr->sessionResumed)
+  {
+    /* Not a record of this module until the boot completes */
+    s->magic = 0;
+  }
+  memcpy(s->serial, buf, sizeof(s->serial));
+  return TMR_SUCCESS;
+}
+
+/**
+ * Record the session with the module just booted, and write the
+ * record to /reader/session/file if one is set.  Failing to write it
+ * only costs the next connect its shortcut, so that is not an error.
+ */
+static void
+sessionSave(TMR_Reader *reader)
+{
+  TMR_SR_SerialReader *sr;
+  TMR_SR_SessionRecord *s;
+#ifdef TMR_ENABLE_STDIO
+  char tmp[TMR_SR_SESSION_PATH + 4];
+  FILE *fp;
+  size_t len, written;
+#endif
+
+  sr = &reader->u.serialReader;
+  s = &sr->session;
+  if (false == sr->sessionEnable)
+  {
+    return;
+  }
+
+  s->magic = TMR_SR_SESSION_MAGIC;
+  s->size = sizeof(*s);
+  memcpy(s->uri, reader->uri, sizeof(s->uri));
+  s->baudRate = sr->lastGoodBaudRate;
+  s->versionInfo = sr->versionInfo;
+  s->productId = sr->productId;
+  s->transportType = sr->transportType;
+
+#ifdef TMR_ENABLE_STDIO
+  len = strlen(sr->sessionFile);
+  if (0 == len)
+  {
+    return;
+  }
+  /* Write a new file and move it into place, never a half-written one */
+  memcpy(tmp, sr->sessionFile, len);
+  memcpy(tmp + len, ".new", 5);
+  fp = fopen(tmp, "wb");
+  if (NULL == fp)
+  {
+    return;
+  }
+  written = fwrite(s, sizeof(*s), 1, fp);
+  if ((0 != fclose(fp)) || (1 != written))
+  {
+    remove(tmp);
+    return;
+  }
+  if (0 != rename(tmp, sr->sessionFile))
+  {
+    /* Windows doesn't replace an existing file */
+    remove(sr->sessionFile);
+    if (0 != rename(tmp, sr->sessionFile))
+    {
+      remove(tmp);
+    }
+  }
+#endif
+}
+
 static TMR_Status
 TMR_SR_configPreamble(TMR_SR_SerialReader *sr)
 {
@@ -190,6 +375,8 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   bool boolval;
   TMR_SR_SerialReader *sr;
   TMR_SR_SerialTransport *transport;
+  TMR_SR_PortDetect ports[TMR_SR_MAX_ANTENNA_PORTS];
+  uint8_t numPorts;
   int i;
   bool value;
   uint32_t rate = 0x00;
@@ -198,6 +385,10 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   sr = &reader->u.serialReader;
   transport = &sr->transport;
 
+  /* Nothing cached survives a new boot or firmware */
+  paramCacheInvalidate(sr, TMR_PARAM_NONE);
+  sr->sessionResumed = false;
+
     /*
    * Once out of bootloader, configure for wakeup preambles.
    * Bootloader doesn't support preambles, and some versions
@@ -230,6 +421,13 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
     }
   }
 
+  /* Skip the discovery below if this is the module of the session record */
+  ret = sessionResume(reader);
+  if (TMR_SUCCESS != ret)
+  {
+    return ret;
+  }
+
   /* Initialize cached power mode value */
   /* Should read power mode as soon as possible.
    * Default mode assumes module is in deep sleep and
@@ -255,10 +453,17 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
     /**
      * Get the transport/BUS type
      **/
-    ret = TMR_SR_cmdGetReaderConfiguration(reader, TMR_SR_CONFIGURATION_CURRENT_MSG_TRANSPORT, &reader->u.serialReader.transportType);
-    if (TMR_SUCCESS != ret)
+    if (sr->sessionResumed)
     {
-      return ret;
+      sr->transportType = sr->session.transportType;
+    }
+    else
+    {
+      ret = TMR_SR_cmdGetReaderConfiguration(reader, TMR_SR_CONFIGURATION_CURRENT_MSG_TRANSPORT, &reader->u.serialReader.transportType);
+      if (TMR_SUCCESS != ret)
+      {
+        return ret;
+      }
     }
     /**
      * In case of USB port disable the CRC
@@ -281,10 +486,14 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   }
 
   rate = sr->baudRate;
-  ret = TMR_paramSet(reader, TMR_PARAM_BAUDRATE, &rate);
-  if (TMR_SUCCESS != ret)
+  /* A resumed module has just answered at this rate */
+  if ((false == sr->sessionResumed) || (rate != currentBaudRate))
   {
-    return ret;
+    ret = TMR_paramSet(reader, TMR_PARAM_BAUDRATE, &rate);
+    if (TMR_SUCCESS != ret)
+    {
+      return ret;
+    }
   }
 
   if (sr->baudRate != currentBaudRate)
@@ -309,6 +518,7 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
       {
         return ret;
       }
+      sr->lastGoodBaudRate = sr->baudRate;
     }
   }
 
@@ -362,6 +572,17 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   BITSET(sr->paramPresent, TMR_PARAM_PROBEBAUDRATES);  
   BITSET(sr->paramPresent, TMR_PARAM_COMMANDTIMEOUT);
   BITSET(sr->paramPresent, TMR_PARAM_TRANSPORTTIMEOUT);
+  BITSET(sr->paramPresent, TMR_PARAM_TRANSPORT_TRACE_RAW);
+  BITSET(sr->paramPresent, TMR_PARAM_READER_METRICS);
+  BITSET(sr->paramPresent, TMR_PARAM_READER_TIMESTAMP_DRIFT);
+  BITSET(sr->paramPresent, TMR_PARAM_PARAM_CACHE_ENABLE);
+  BITSET(sr->paramPresent, TMR_PARAM_PARAM_CACHE_HITS);
+  BITSET(sr->paramPresent, TMR_PARAM_PARAM_CACHE_MISSES);
+#ifdef TMR_ENABLE_STDIO
+  BITSET(sr->paramPresent, TMR_PARAM_SESSION_FILE);
+#endif
+  BITSET(sr->paramPresent, TMR_PARAM_SESSION_RECORD);
+  BITSET(sr->paramPresent, TMR_PARAM_SESSION_RESUMED);
   BITSET(sr->paramPresent, TMR_PARAM_POWERMODE);
   BITSET(sr->paramPresent, TMR_PARAM_USERMODE);
   BITSET(sr->paramPresent, TMR_PARAM_ANTENNA_CHECKPORT);
@@ -385,6 +606,12 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   BITSET(sr->paramPresent, TMR_PARAM_GEN2_SEND_SELECT);
   BITSET(sr->paramPresent, TMR_PARAM_READ_ASYNCOFFTIME);
   BITSET(sr->paramPresent, TMR_PARAM_READ_ASYNCONTIME);
+#ifdef TMR_ENABLE_BACKGROUND_READS
+  BITSET(sr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_DEPTH);
+  BITSET(sr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_POLICY);
+  BITSET(sr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_HIGHWATER);
+  BITSET(sr->paramPresent, TMR_PARAM_READ_ASYNC_QUEUE_DROPS);
+#endif
   BITSET(sr->paramPresent, TMR_PARAM_READ_PLAN);
   BITSET(sr->paramPresent, TMR_PARAM_RADIO_ENABLEPOWERSAVE);
   BITSET(sr->paramPresent, TMR_PARAM_RADIO_POWERMAX);
@@ -456,6 +683,11 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   }
 
   /* Get productGroupID early, so other params (e.g., txRxMap) can use it */
+  if (sr->sessionResumed)
+  {
+    sr->productId = sr->session.productId;
+  }
+  else
   {
     ret = TMR_SR_cmdGetReaderConfiguration(reader, TMR_SR_CONFIGURATION_PRODUCT_GROUP_ID, &sr->productId);
     if (TMR_SUCCESS != ret)
@@ -473,18 +705,18 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
         return ret;
       }
     }
-    /* 
-     * If product is ruggedized reader, 
-     * set reader's GPO pin which is used for antenna port switching
-     */
-    if (1 == sr->productId)
+  }
+  /* 
+   * If product is ruggedized reader, 
+   * set reader's GPO pin which is used for antenna port switching
+   */
+  if (1 == sr->productId)
+  {
+    uint8_t pin = 1;
+    ret = TMR_SR_cmdSetReaderConfiguration(reader, TMR_SR_CONFIGURATION_ANTENNA_CONTROL_GPIO, &pin);
+    if (TMR_SUCCESS != ret)
     {
-      uint8_t pin = 1;
-      ret = TMR_SR_cmdSetReaderConfiguration(reader, TMR_SR_CONFIGURATION_ANTENNA_CONTROL_GPIO, &pin);
-      if (TMR_SUCCESS != ret)
-      {
-        return ret;
-      }
+      return ret;
     }
   }
   /* Set region if user set the param */
@@ -531,7 +763,36 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   reader->tagOpParams.protocol = sr->currentProtocol;
 
   reader->tagOpParams.antenna = 0;
-  ret = initTxRxMapFromPorts(reader);
+  if (sr->sessionResumed)
+  {
+    numPorts = sr->session.portCount;
+    for (i = 0; i < numPorts; i++)
+    {
+      ports[i].port = sr->session.ports[i];
+      ports[i].detected = sr->session.detected[i];
+    }
+    ret = initTxRxMap(reader, ports, numPorts);
+  }
+  else
+  {
+    /* Need number of ports to set up Tx-Rx map */
+    numPorts = numberof(ports);
+    ret = TMR_SR_cmdAntennaDetect(reader, &numPorts, ports);
+    if (TMR_SUCCESS == ret)
+    {
+      sr->session.portCount = numPorts;
+      for (i = 0; i < numPorts; i++)
+      {
+        sr->session.ports[i] = ports[i].port;
+        sr->session.detected[i] = ports[i].detected;
+      }
+      ret = initTxRxMap(reader, ports, numPorts);
+    }
+    else
+    {
+      sr->session.portCount = 0;
+    }
+  }
 
   /**
    * Enable the extended EPC flag in case
@@ -590,8 +851,81 @@ TMR_SR_boot(TMR_Reader *reader, uint32_t currentBaudRate)
   return ret;
 }
 
+/**
+ * Try to talk to the module at one baud rate.
+ *
+ * @return TMR_SUCCESS if it answered, TMR_ERROR_TIMEOUT if it did
+ * not (usually the wrong rate), any other error is real.
+ */
+static TMR_Status
+probeBaudRate(TMR_Reader *reader, uint32_t rate)
+{
+  TMR_Status ret;
+  TMR_SR_SerialTransport *transport;
+
+  transport = &reader->u.serialReader.transport;
+
+  if (NULL != transport->setBaudRate)
+  {
+    /**
+    * some transport layer does not support baud rate settings.
+    * for ex: TCP transport. In that case skip the baud rate
+    * settings.
+    */ 
+    ret = transport->setBaudRate(transport, rate);
+    if (TMR_SUCCESS != ret)
+    {
+      return ret;
+    }
+  }
+
+  ret = transport->flush(transport);
+  if ((TMR_SUCCESS != ret) && (TMR_ERROR_UNIMPLEMENTED != ret))
+  {
+    return ret;
+  }
+contact:
+  ret = TMR_SR_cmdVersion(reader, &(reader->u.serialReader.versionInfo));
+  if (TMR_SUCCESS == ret)
+  {
+    /* Got a reply?  Then this is the right baud rate! */
+    return ret;
+  }
+
+  else if(TMR_ERROR_BOOT_RESPONSE == ret)
+  {
+    goto contact;
+  }
+
+  /* Timeouts are okay -- they usually mean "wrong baud rate",
+  * so just try the next one.  All other errors are real
+  * and should be forwarded immediately. */
+  else if (TMR_ERROR_TIMEOUT != ret)
+  {
+    if (TMR_ERROR_COMM(ret))
+    {
+      ret = verifySearchStatus(reader);
+      if (TMR_SUCCESS == ret)
+      {
+        goto contact;
+      }
+      else
+      {
+        return ret;
+      }
+    } 
+    else
+    {
+      return ret;
+    }
+  }
+  return ret;
+}
+
 /**
  * Probing the correct baudrate to communicate with the serial reader.
+ * The rate the module last answered at is tried first, then the
+ * configured /reader/baudRate, then /reader/probeBaudRates in order.
  *
  * @param reader The reader
  * @param currentBaudRate the baud rate at which module is communicating.
@@ -601,13 +935,26 @@ TMR_SR_cmdProbeBaudRate(TMR_Reader *reader, uint32_t *currentBaudRate)
 {
   TMR_Status ret;
   TMR_SR_SerialReader *sr;
-  TMR_SR_SerialTransport *transport;
   uint32_t rate = 0x00;
   int i,count = 2;
 
   ret = TMR_SUCCESS;
   sr = &reader->u.serialReader;
-  transport = &reader->u.serialReader.transport;
+
+  if ((0 != sr->lastGoodBaudRate) && (sr->lastGoodBaudRate != sr->baudRate))
+  {
+    rate = sr->lastGoodBaudRate;
+    ret = probeBaudRate(reader, rate);
+    if (TMR_SUCCESS == ret)
+    {
+      *currentBaudRate = rate;
+      return ret;
+    }
+    else if (TMR_ERROR_TIMEOUT != ret)
+    {
+      return ret;
+    }
+  }
 
   for (i = 0; (uint32_t)i < sr->probeBaudRates.len; i++)
   {
@@ -626,63 +973,18 @@ TMR_SR_cmdProbeBaudRate(TMR_Reader *reader, uint32_t *currentBaudRate)
     else
     {
       rate = sr->probeBaudRates.list[i];
-      if (rate == sr->baudRate)
+      if ((rate == sr->baudRate) || (rate == sr->lastGoodBaudRate))
         continue; /* We already tried this one */
     }
 
-    if (NULL != transport->setBaudRate)
-    {
-      /**
-      * some transport layer does not support baud rate settings.
-      * for ex: TCP transport. In that case skip the baud rate
-      * settings.
-      */ 
-      ret = transport->setBaudRate(transport, rate);
-      if (TMR_SUCCESS != ret)
-      {
-        return ret;
-      }
-    }
-
-    ret = transport->flush(transport);
-    if ((TMR_SUCCESS != ret) && (TMR_ERROR_UNIMPLEMENTED != ret))
-    {
-      return ret;
-    }
-contact:
-    ret = TMR_SR_cmdVersion(reader, &(reader->u.serialReader.versionInfo));
+    ret = probeBaudRate(reader, rate);
     if (TMR_SUCCESS == ret)
     {
-      /* Got a reply?  Then this is the right baud rate! */
       break;
     }
-
-    else if(TMR_ERROR_BOOT_RESPONSE == ret)
-    {
-      goto contact;
-    }
-
-    /* Timeouts are okay -- they usually mean "wrong baud rate",
-    * so just try the next one.  All other errors are real
-    * and should be forwarded immediately. */
     else if (TMR_ERROR_TIMEOUT != ret)
     {
-      if (TMR_ERROR_COMM(ret))
-      {
-        ret = verifySearchStatus(reader);
-        if (TMR_SUCCESS == ret)
-        {
-          goto contact;
-        }
-        else
-        {
-          return ret;
-        }
-      } 
-      else
-      {
-        return ret;
-      }
+      return ret;
     }
   }
   if (i == sr->probeBaudRates.len)
@@ -692,6 +994,7 @@ contact:
 
   /* copy the baud rate */
   *currentBaudRate = rate;  
+  sr->lastGoodBaudRate = rate;
   return ret;
 }
 
@@ -712,6 +1015,14 @@ TMR_SR_connect(TMR_Reader *reader)
   {
     return ret;
   }
+
+  /* Start probing where the last session left the module */
+  sessionLoad(reader);
+  if ((TMR_SR_SESSION_MAGIC == sr->session.magic) && (0 == sr->lastGoodBaudRate))
+  {
+    sr->lastGoodBaudRate = sr->session.baudRate;
+  }
+
   rate = sr->probeBaudRates.list[0]; //this fixes the compilation errors in some compilers
   ret = TMR_SR_cmdProbeBaudRate(reader, &rate);
   if (TMR_SUCCESS != ret)
@@ -749,6 +1060,17 @@ TMR_SR_connect(TMR_Reader *reader)
     }
   }
 
+  if ((TMR_SUCCESS != ret) && (TMR_ERROR_AUTOREAD_ENABLED != ret) && sr->sessionResumed)
+  {
+    /* Something the record vouched for no longer holds; discover it all */
+    sr->session.magic = 0;
+    ret = TMR_SR_boot(reader, sr->lastGoodBaudRate);
+  }
+  if (TMR_SUCCESS == ret)
+  {
+    sessionSave(reader);
+  }
+
   return ret;
 }
 
@@ -1405,11 +1727,7 @@ TMR_SR_read_internal(struct TMR_Reader *reader, uint32_t timeoutMs,
       if (!reader->continuousReading)
       {
         /* Cache the read time so it can be put in tag read data later */
-        tm_gettime_consistent(&starttimeHigh, &starttimeLow);
-        sr->readTimeHigh = starttimeHigh;
-        sr->readTimeLow = starttimeLow;
-        sr->lastSentTagTimestampHigh = starttimeHigh;
-        sr->lastSentTagTimestampLow = starttimeLow;
+        TMR_SR_resetTimeBase(sr);
       }
 
       if (reader->continuousReading)
@@ -1520,10 +1838,7 @@ TMR_SR_read_internal(struct TMR_Reader *reader, uint32_t timeoutMs,
 
   /* Cache the read time so it can be put in tag read data later */
   tm_gettime_consistent(&starttimeHigh, &starttimeLow);
-  sr->readTimeHigh = starttimeHigh;
-  sr->readTimeLow = starttimeLow;
-  sr->lastSentTagTimestampHigh = starttimeHigh;
-  sr->lastSentTagTimestampLow = starttimeLow;
+  TMR_SR_resetTimeBase(sr);
 
   /* Cache search timeout for later call to streaming receive */
   sr->searchTimeoutMs = timeoutMs;
@@ -1721,7 +2036,6 @@ TMR_SR_read_internal(struct TMR_Reader *reader, uint32_t timeoutMs,
       while (TMR_SUCCESS == TMR_SR_hasMoreTags(reader))
       {
         TMR_TagReadData trd;
-        TMR_ReadListenerBlock *rlb;
 
         TMR_TRD_init(&trd);
 
@@ -1735,14 +2049,7 @@ TMR_SR_read_internal(struct TMR_Reader *reader, uint32_t timeoutMs,
           break;
         }
 
-        pthread_mutex_lock(&reader->listenerLock);
-        rlb = reader->readListeners;
-        while (rlb)
-        { 
-          rlb->listener(reader, &trd, rlb->cookie);
-          rlb = rlb->next;
-        }
-        pthread_mutex_unlock(&reader->listenerLock);
+        notify_read_listeners(reader, &trd);
       }
 
       /* Calculate and accumulate time spent in fetching tags */
@@ -2685,6 +2992,7 @@ TMR_SR_reboot(TMR_Reader *reader)
   TMR_Status ret;
 
   ret = TMR_SR_cmdrebootReader(reader);
+  paramCacheInvalidate(&reader->u.serialReader, TMR_PARAM_NONE);
 
   return ret;
 }
@@ -3141,6 +3449,167 @@ getPortValues(struct TMR_Reader *reader, TMR_PortValueList *list, int offset)
   return TMR_SUCCESS;
 }
 
+/**
+ * Answer a get from the parameter cache.
+ *
+ * @return true if the value was cached and has been copied out
+ */
+static bool
+paramCacheGet(TMR_SR_SerialReader *sr, TMR_Param key, void *value)
+{
+  TMR_SR_ParamCache *cache;
+  uint8_t i;
+
+  cache = &sr->paramCache;
+  if ((false == cache->enable) || (0 == BITGET(sr->paramCached, key)))
+  {
+    return false;
+  }
+
+  switch (key)
+  {
+  case TMR_PARAM_VERSION_SERIAL:
+    TMR_stringCopy(value, cache->serial, (int)strlen(cache->serial));
+    break;
+
+  case TMR_PARAM_REGION_SUPPORTEDREGIONS:
+  {
+    TMR_RegionList *regions = value;
+
+    regions->len = 0;
+    for (i = 0; i < cache->regionCount; i++)
+    {
+      LISTAPPEND(regions, cache->regions[i]);
+    }
+    break;
+  }
+
+  case TMR_PARAM_VERSION_SUPPORTEDPROTOCOLS:
+  {
+    TMR_TagProtocolList *protocols = value;
+
+    protocols->len = 0;
+    for (i = 0; i < cache->protocolCount; i++)
+    {
+      LISTAPPEND(protocols, cache->protocols[i]);
+    }
+    break;
+  }
+
+  case TMR_PARAM_RADIO_POWERMAX:
+    *(int16_t *)value = cache->powerMax;
+    break;
+
+  case TMR_PARAM_RADIO_POWERMIN:
+    *(int16_t *)value = cache->powerMin;
+    break;
+
+  case TMR_PARAM_PRODUCT_GROUP_ID:
+    *(uint16_t *)value = cache->productGroupId;
+    break;
+
+  case TMR_PARAM_PRODUCT_ID:
+    *(uint16_t *)value = cache->productId;
+    break;
+
+  default:
+    return false;
+  }
+  cache->hits++;
+  return true;
+}
+
+/**
+ * Keep the value the module just returned, if key is one that can be
+ * cached and the caller's buffer held all of it.
+ */
+static void
+paramCachePut(TMR_SR_SerialReader *sr, TMR_Param key, const void *value)
+{
+  TMR_SR_ParamCache *cache;
+  uint8_t i;
+
+  cache = &sr->paramCache;
+  if (false == cache->enable)
+  {
+    return;
+  }
+
+  switch (key)
+  {
+  case TMR_PARAM_VERSION_SERIAL:
+  {
+    const TMR_String *serial = value;
+    size_t len;
+
+    len = strlen(serial->value);
+    if ((len + 1 >= serial->max) || (len >= sizeof(cache->serial)))
+    {
+      /* May have been cut short */
+      cache->misses++;
+      return;
+    }
+    memcpy(cache->serial, serial->value, len + 1);
+    break;
+  }
+
+  case TMR_PARAM_REGION_SUPPORTEDREGIONS:
+  {
+    const TMR_RegionList *regions = value;
+
+    if ((regions->len > regions->max) || (regions->len > TMR_SR_PARAM_CACHE_LIST))
+    {
+      cache->misses++;
+      return;
+    }
+    for (i = 0; i < regions->len; i++)
+    {
+      cache->regions[i] = regions->list[i];
+    }
+    cache->regionCount = regions->len;
+    break;
+  }
+
+  case TMR_PARAM_VERSION_SUPPORTEDPROTOCOLS:
+  {
+    const TMR_TagProtocolList *protocols = value;
+
+    if ((protocols->len > protocols->max) || (protocols->len > TMR_SR_PARAM_CACHE_LIST))
+    {
+      cache->misses++;
+      return;
+    }
+    for (i = 0; i < protocols->len; i++)
+    {
+      cache->protocols[i] = protocols->list[i];
+    }
+    cache->protocolCount = protocols->len;
+    break;
+  }
+
+  case TMR_PARAM_RADIO_POWERMAX:
+    cache->powerMax = *(const int16_t *)value;
+    break;
+
+  case TMR_PARAM_RADIO_POWERMIN:
+    cache->powerMin = *(const int16_t *)value;
+    break;
+
+  case TMR_PARAM_PRODUCT_GROUP_ID:
+    cache->productGroupId = *(const uint16_t *)value;
+    break;
+
+  case TMR_PARAM_PRODUCT_ID:
+    cache->productId = *(const uint16_t *)value;
+    break;
+
+  default:
+    return;
+  }
+  cache->misses++;
+  BITSET(sr->paramCached, key);
+}
+
 static TMR_Status
 TMR_SR_paramSet(struct TMR_Reader *reader, TMR_Param key, const void *value)
 {
@@ -3165,6 +3634,8 @@ TMR_SR_paramSet(struct TMR_Reader *reader, TMR_Param key, const void *value)
     return TMR_ERROR_NOT_FOUND;
   }
 
+  paramCacheInvalidate(sr, key);
+
   switch (key)
   {
   case TMR_PARAM_REGION_ID:
@@ -3227,7 +3698,12 @@ TMR_SR_paramSet(struct TMR_Reader *reader, TMR_Param key, const void *value)
           break;
         }
         sr->baudRate = rate;
-        transport->setBaudRate(transport, sr->baudRate);
+        sr->lastGoodBaudRate = rate;
+        ret = transport->setBaudRate(transport, sr->baudRate);
+        if ((TMR_SUCCESS == ret) && (TMR_SR_SESSION_MAGIC == sr->session.magic))
+        {
+          sessionSave(reader);
+        }
       }
     }
     else
@@ -3673,9 +4149,42 @@ TMR_SR_paramSet(struct TMR_Reader *reader, TMR_Param key, const void *value)
   case TMR_PARAM_VERSION_SOFTWARE:
   case TMR_PARAM_ANTENNA_RETURNLOSS:
   case TMR_PARAM_GEN2_PROTOCOLEXTENSION:
+  case TMR_PARAM_READER_TIMESTAMP_DRIFT:
+  case TMR_PARAM_PARAM_CACHE_HITS:
+  case TMR_PARAM_PARAM_CACHE_MISSES:
+  case TMR_PARAM_SESSION_RESUMED:
     ret = TMR_ERROR_READONLY;
     break;
 
+  case TMR_PARAM_PARAM_CACHE_ENABLE:
+    sr->paramCache.enable = *(bool *)value;
+    paramCacheInvalidate(sr, TMR_PARAM_NONE);
+    break;
+
+  case TMR_PARAM_SESSION_FILE:
+  {
+    const TMR_String *path = value;
+    size_t len;
+
+    len = (NULL == path->value) ? 0 : strlen(path->value);
+    if (len >= sizeof(sr->sessionFile))
+    {
+      ret = TMR_ERROR_ILLEGAL_VALUE;
+      break;
+    }
+    memcpy(sr->sessionFile, path->value, len);
+    sr->sessionFile[len] = '\0';
+    /* An empty path turns session records off */
+    sr->sessionEnable = (0 != len);
+    sr->session.magic = 0;
+    break;
+  }
+
+  case TMR_PARAM_SESSION_RECORD:
+    sr->session = *(const TMR_SR_SessionRecord *)value;
+    sr->sessionEnable = true;
+    break;
+
   case TMR_PARAM_POWERMODE:
     if (reader->connected)
     {
@@ -4097,6 +4606,11 @@ TMR_SR_paramGet(struct TMR_Reader *reader, TMR_Param key, void *value)
     return TMR_ERROR_NOT_FOUND;
   }
 
+  if (paramCacheGet(sr, key, value))
+  {
+    return TMR_SUCCESS;
+  }
+
   switch (key)
   {
   case TMR_PARAM_BAUDRATE:
@@ -4802,6 +5316,34 @@ TMR_SR_paramGet(struct TMR_Reader *reader, TMR_Param key, void *value)
   ret = TMR_SR_cmdGetReaderStatistics(reader, TMR_SR_READER_STATS_ALL, value);
   break;
 
+  case TMR_PARAM_READER_TIMESTAMP_DRIFT:
+    *(int32_t *)value = reader->u.serialReader.clockDrift.ppb;
+    break;
+
+  case TMR_PARAM_PARAM_CACHE_ENABLE:
+    *(bool *)value = sr->paramCache.enable;
+    break;
+
+  case TMR_PARAM_PARAM_CACHE_HITS:
+    *(uint32_t *)value = sr->paramCache.hits;
+    break;
+
+  case TMR_PARAM_PARAM_CACHE_MISSES:
+    *(uint32_t *)value = sr->paramCache.misses;
+    break;
+
+  case TMR_PARAM_SESSION_FILE:
+    TMR_stringCopy(value, sr->sessionFile, (int)strlen(sr->sessionFile));
+    break;
+
+  case TMR_PARAM_SESSION_RECORD:
+    *(TMR_SR_SessionRecord *)value = sr->session;
+    break;
+
+  case TMR_PARAM_SESSION_RESUMED:
+    *(bool *)value = sr->sessionResumed;
+    break;
+
   case TMR_PARAM_PRODUCT_GROUP:
     {
       const char *group;
@@ -4964,7 +5506,8 @@ TMR_SR_paramGet(struct TMR_Reader *reader, TMR_Param key, void *value)
 	  ;
   }
 
-  if (0 == BITGET(sr->paramConfirmed, key))
+  /* An aborted batch never asked the module */
+  if ((0 == BITGET(sr->paramConfirmed, key)) && (TMR_ERROR_BATCH_ABORTED != ret))
   {
     if ((TMR_SUCCESS == ret) || ret == TMR_ERROR_AUTOREAD_ENABLED )
     {
@@ -4973,6 +5516,11 @@ TMR_SR_paramGet(struct TMR_Reader *reader, TMR_Param key, void *value)
     BITSET(sr->paramConfirmed, key);
   }
 
+  if (TMR_SUCCESS == ret)
+  {
+    paramCachePut(sr, key, value);
+  }
+
   return ret;
 }
 
@@ -5010,15 +5558,42 @@ TMR_SR_SerialReader_init(TMR_Reader *reader)
 
   reader->paramSet = TMR_SR_paramSet;
   reader->paramGet = TMR_SR_paramGet;
+  reader->paramBatchFlush = TMR_SR_flushPipeline;
+  reader->batchOps = NULL;
  
   memset(reader->u.serialReader.paramConfirmed,0,
          sizeof(reader->u.serialReader.paramConfirmed));
   memset(reader->u.serialReader.paramPresent,0,
          sizeof(reader->u.serialReader.paramPresent));
   reader->u.serialReader.baudRate = 115200;
+  reader->u.serialReader.lastGoodBaudRate = 0;
   reader->u.serialReader.currentProtocol = TMR_TAG_PROTOCOL_NONE;
   reader->u.serialReader.versionInfo.hardware[0] = TMR_SR_MODEL_UNKNOWN;
   reader->u.serialReader.supportsPreamble = false;
+  reader->u.serialReader.preambleSkipped = false;
+  reader->u.serialReader.preambleIdleUs = TMR_SR_PREAMBLE_IDLE_MS * 1000;
+  reader->u.serialReader.preambleForcedUntilUs = 0;
+  reader->u.serialReader.preambleBackoffMs = 0;
+  reader->u.serialReader.lastExchangeUs = 0;
+  reader->u.serialReader.paramCache.enable = true;
+  reader->u.serialReader.paramCache.hits = 0;
+  reader->u.serialReader.paramCache.misses = 0;
+  memset(reader->u.serialReader.paramCached, 0, sizeof(reader->u.serialReader.paramCached));
+  reader->u.serialReader.pipeline.head = 0;
+  reader->u.serialReader.pipeline.count = 0;
+  memset(&reader->u.serialReader.session, 0, sizeof(reader->u.serialReader.session));
+  reader->u.serialReader.sessionEnable = false;
+  reader->u.serialReader.sessionResumed = false;
+  reader->u.serialReader.sessionFile[0] = '\0';
+  /* Known before connecting, and TMR_paramProbe() can't hold a record */
+#ifdef TMR_ENABLE_STDIO
+  BITSET(reader->u.serialReader.paramPresent, TMR_PARAM_SESSION_FILE);
+#endif
+  BITSET(reader->u.serialReader.paramConfirmed, TMR_PARAM_SESSION_FILE);
+  BITSET(reader->u.serialReader.paramPresent, TMR_PARAM_SESSION_RECORD);
+  BITSET(reader->u.serialReader.paramConfirmed, TMR_PARAM_SESSION_RECORD);
+  BITSET(reader->u.serialReader.paramPresent, TMR_PARAM_SESSION_RESUMED);
+  BITSET(reader->u.serialReader.paramConfirmed, TMR_PARAM_SESSION_RESUMED);
   reader->u.serialReader.extendedEPC = false;
   reader->u.serialReader.powerMode = TMR_SR_POWER_MODE_INVALID;
   reader->u.serialReader.transportTimeout = 5000;
@@ -5044,6 +5619,8 @@ TMR_SR_SerialReader_init(TMR_Reader *reader)
   reader->u.serialReader.enableAutonomousRead = false;
   reader->u.serialReader.isBasetimeUpdated = false;
   reader->u.serialReader.elapsedTime = 0;
+  memset(&reader->u.serialReader.clockDrift, 0, sizeof(reader->u.serialReader.clockDrift));
+  TMR_SR_resetTimeBase(&reader->u.serialReader);
   {
     //initialize the probe baud rate list with the supported  baud rate values
     TMR_uint32List value;
@@ -7421,22 +7998,20 @@ TMR_SR_addTagOp(struct TMR_Reader *reader, TMR_TagOp *tagop,TMR_ReadPlan *rp, ui
 void TMR_SR_updateBaseTimeStamp(TMR_Reader *reader)
 {
   /* update the base time stamp to current host time */
-  uint32_t starttimeLow = 0, starttimeHigh = 0;
   TMR_SR_SerialReader *sr = &reader->u.serialReader;
 
   if(sr->elapsedTime)
   {
-    uint64_t currTime64;
-    currTime64 = ((uint64_t)sr->readTimeHigh << 32) | sr->readTimeLow;
-    currTime64 += (uint64_t)sr->elapsedTime;
-    starttimeLow  = (uint32_t)(currTime64 & 0xFFFFFFFF);
-    starttimeHigh = (uint32_t)((currTime64>>32) & 0xFFFFFFFF);
+    /* Module's search cycle ended, its timestamps restart from here */
+    sr->timeBaseUs += (uint64_t)sr->elapsedTime * 1000;
+    if (sr->lastSentTagUs < sr->timeBaseUs)
+    {
+      sr->lastSentTagUs = sr->timeBaseUs;
+    }
   }
   else
   {
-    tm_gettime_consistent(&starttimeHigh, &starttimeLow);
+    TMR_SR_resetTimeBase(sr);
   }
-  sr->readTimeHigh = sr->lastSentTagTimestampHigh = starttimeHigh;
-  sr->readTimeLow = sr->lastSentTagTimestampLow = starttimeLow;
 }
 #endif /* TMR_ENABLE_SERIAL_READER */
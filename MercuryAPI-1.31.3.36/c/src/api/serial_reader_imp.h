@@ -177,6 +177,7 @@ typedef enum TMR_SR_EndOfSelect
 TMR_Status TMR_SR_sendTimeout(TMR_Reader *reader, uint8_t *data,
                               uint32_t timeoutMs);
 TMR_Status TMR_SR_send(TMR_Reader *reader, uint8_t *data);
+TMR_Status TMR_SR_flushPipeline(TMR_Reader *reader);
 TMR_Status TMR_SR_sendMessage(TMR_Reader *reader, uint8_t *data,
                               uint8_t *opcode, uint32_t timeoutMs);
 TMR_Status TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data,
@@ -191,6 +192,7 @@ TMR_SR_parseMetadataOnly(TMR_Reader *reader, TMR_TagReadData *read, uint16_t fla
                                 uint8_t *i, uint8_t msg[]);
 void TMR_SR_postprocessReaderSpecificMetadata(TMR_TagReadData *read,
                                               TMR_SR_SerialReader *sr);
+void TMR_SR_resetTimeBase(TMR_SR_SerialReader *sr);
 bool isContinuousReadParamSupported(TMR_Reader *reader);
 
 /**
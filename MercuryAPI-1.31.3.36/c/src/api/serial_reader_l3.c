@@ -35,6 +35,7 @@
 #include "tm_reader.h"
 #include "serial_reader_imp.h"
 #include "tmr_utils.h"
+#include "tmr_crc.h"
 
 #define NUMBER_OF_MULTISELECT_SUPPORTED 3u
 bool isMultiSelectEnabled = false;
@@ -57,35 +58,6 @@ static TMR_Status filterbytes(TMR_TagProtocol protocol,
 TMR_Status
 TMR_SR_sendBytes(TMR_Reader *reader, uint8_t len, uint8_t *data, uint32_t timeoutMs);
 
-/*
- * ThingMagic-mutated CRC used for messages.
- * Notably, not a CCITT CRC-16, though it looks close.
- */
-static uint16_t crctable[] = 
-{
-  0x0000, 0x1021, 0x2042, 0x3063,
-  0x4084, 0x50a5, 0x60c6, 0x70e7,
-  0x8108, 0x9129, 0xa14a, 0xb16b,
-  0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
-};
-
-static uint16_t
-tm_crc(uint8_t *u8Buf, uint8_t len)
-{
-  uint16_t crc;
-  int i;
-
-  crc = 0xffff;
-
-  for (i = 0; i < len ; i++)
-  {
-    crc = ((crc << 4) | (u8Buf[i] >> 4))  ^ crctable[crc >> 12];
-    crc = ((crc << 4) | (u8Buf[i] & 0xf)) ^ crctable[crc >> 12];
-  }
-
-  return crc;
-}
-
 
 /**
  * Send a byte string
@@ -112,6 +84,62 @@ TMR_SR_sendBytes(TMR_Reader *reader, uint8_t len, uint8_t *data, uint32_t timeou
   return ret;
 }
 
+/**
+ * Whether the module may have gone to sleep since it was last heard
+ * from, so that the next command needs the wake-up preamble.
+ */
+static bool
+preambleNeeded(TMR_SR_SerialReader *sr)
+{
+  uint64_t now;
+
+  if (0 == sr->lastExchangeUs)
+  {
+    return true;
+  }
+  now = tmr_gettime_us();
+  return (now - sr->lastExchangeUs >= sr->preambleIdleUs)
+    || (now < sr->preambleForcedUntilUs);
+}
+
+/**
+ * Tickle the RS-232 line for TMR_SR_PREAMBLE_MS while the processor
+ * spins up communications again. The length is counted in bytes at the
+ * current speed, 10 bits each. On a UART the line paces them; a TCP
+ * bridge or USB CDC device takes them at once, so whatever is left of
+ * TMR_SR_PREAMBLE_MS once they are written is slept.
+ */
+static void
+sendPreamble(TMR_Reader *reader, uint32_t timeoutMs)
+{
+  uint8_t flushBytes[64];
+  uint32_t remaining, count;
+  uint64_t startUs, elapsedUs;
+
+  startUs = tmr_gettime_us();
+  memset(flushBytes, 0xFF, sizeof(flushBytes));
+  remaining = (uint32_t)((uint64_t)reader->u.serialReader.baudRate * TMR_SR_PREAMBLE_MS / 10000);
+  if (remaining < 8)
+  {
+    remaining = 8;
+  }
+  while (0 != remaining)
+  {
+    count = (remaining < sizeof(flushBytes)) ? remaining : sizeof(flushBytes);
+    if (TMR_SUCCESS != TMR_SR_sendBytes(reader, count, flushBytes, timeoutMs))
+    {
+      break;
+    }
+    remaining -= count;
+  }
+
+  elapsedUs = tmr_gettime_us() - startUs;
+  if (elapsedUs < TMR_SR_PREAMBLE_MS * 1000)
+  {
+    tmr_sleep((uint32_t)((TMR_SR_PREAMBLE_MS * 1000 - elapsedUs + 999) / 1000));
+  }
+}
+
 /**
  * Send a message to the reader
  *
@@ -141,33 +169,21 @@ TMR_SR_sendMessage(TMR_Reader *reader, uint8_t *data, uint8_t *opcode, uint32_t
     byteLen = 3;
   }*/
 
-  /* Wake up processor from deep sleep.  Tickle the RS-232 line, then
-   * wait a fixed delay while the processor spins up communications again. */
+  /* Wake up processor from deep sleep, unless it answered recently
+   * enough to still be awake. */
+  sr->preambleSkipped = false;
   if (sr->supportsPreamble && ((sr->powerMode == TMR_SR_POWER_MODE_INVALID) ||
                               (sr->powerMode == TMR_SR_POWER_MODE_SLEEP)) )
   {
-    uint8_t flushBytes[] = {
-      0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
-    };
-
-    TMR_SR_sendBytes(reader, sizeof(flushBytes)/sizeof(uint8_t), flushBytes, timeoutMs);
+    if (preambleNeeded(sr))
     {
-      //uint32_t bytesper100ms;
-      uint32_t bytesSent;
-
-      /* Calculate fixed delay in terms of byte-lengths at current speed */
-      /* @todo Optimize delay length.  This value (100 bytes at 9600bps) is taken
-       * directly from arbser, which was itself using a hastily-chosen value. */
-      //bytesper100ms = sr->baudRate / 50;
-      for (bytesSent=0; bytesSent < 24;
-         bytesSent++)
-      {
-        TMR_SR_sendBytes(reader, sizeof(flushBytes)/sizeof(uint8_t), flushBytes, timeoutMs);
-        /* Introducing 25 ms delay between each Iteration */
-        tmr_sleep(9); 
-      }
+      sendPreamble(reader, timeoutMs);
+    }
+    else
+    {
+      sr->preambleSkipped = true;
     }
-  }    
+  }
 
   /* Layout of message in data array: 
    * [0] [1] [2] [3] [4]  ... [LEN+2] [LEN+3] [LEN+4]
@@ -266,8 +282,11 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
   uint32_t rxcount = 0;
   uint8_t sohIndex = 0;
   TMR_SR_SerialTransport *transport;
+  TMR_ReaderMetrics *metrics;
   uint8_t retryCount = 0;
   bool sohFound = false;
+  uint64_t deadlineUs;
+  uint32_t remainingMs;
 
   transport = &reader->u.serialReader.transport;
   timeoutMs += reader->u.serialReader.transportTimeout;
@@ -277,6 +296,13 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
     timeoutMs += reader->readParams.asyncOffTime;
 #endif
   }
+  /**
+   * The whole message, however many receives and SOH retries it
+   * takes, has to arrive within timeoutMs. Each receive is only
+   * given what is left of it, and none is started once it is gone
+   * (some transports treat a zero timeout as no timeout).
+   **/
+  deadlineUs = tm_deadline_us(timeoutMs);
 
   /**
    * Initialize the receive bytes length based on
@@ -293,8 +319,13 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
 
   do
   {
+    remainingMs = tm_remaining_ms(deadlineUs);
+    if ((0 == remainingMs) && (0 != timeoutMs))
+    {
+      return TMR_ERROR_TIMEOUT;
+    }
     /* Pull at least receiveBytesLen bytes on first serial receive */
-    ret = transport->receiveBytes(transport, (receiveBytesLen - inlen), &rxcount, (data + inlen), timeoutMs);
+    ret = transport->receiveBytes(transport, (receiveBytesLen - inlen), &rxcount, (data + inlen), remainingMs);
     if (TMR_SUCCESS != ret)
     {
       /* @todo Figure out how many bytes were actually obtained in a failed receive */
@@ -331,6 +362,7 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
       break;
     else
     {
+      TMR__metrics(reader, &reader->metricsIo)->resyncBytes += sohIndex;
       /* Update inlen with correct length after discarding invalid bytes. */
       inlen = receiveBytesLen - sohIndex;
       /* Now, copy the inlen number of bytes to data buffer at 0th index. */
@@ -366,7 +398,12 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
   }
   else
   {
-    ret = transport->receiveBytes(transport, len, &inlen, data + receiveBytesLen, timeoutMs);
+    remainingMs = tm_remaining_ms(deadlineUs);
+    if ((0 == remainingMs) && (0 != timeoutMs))
+    {
+      return TMR_ERROR_TIMEOUT;
+    }
+    ret = transport->receiveBytes(transport, len, &inlen, data + receiveBytesLen, remainingMs);
   }
 
   if (NULL != reader->transportListeners)
@@ -379,6 +416,14 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
     /* before we can actually process the message, we have to properly receive the message */
     return ret;
   }
+  metrics = TMR__metrics(reader, &reader->metricsIo);
+  metrics->framesReceived++;
+  reader->u.serialReader.lastExchangeUs = tmr_gettime_us();
+  if ((0x22 == data[2]) && (reader->continuousReading))
+  {
+    /* Arrival of a streamed tag, bounds its timestamp and tracks drift */
+    reader->u.serialReader.rxUs = reader->u.serialReader.lastExchangeUs;
+  }
 
   /**
    * Calculate the CRC only if expectCRC option
@@ -390,6 +435,7 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
   if ((data[len + 5] != (crc >> 8)) ||
       (data[len + 6] != (crc & 0xff)))
   {
+    metrics->crcErrors++;
     return TMR_ERROR_CRC_ERROR;
   }
   }
@@ -438,6 +484,86 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
   return ret;
 }
 
+/**
+ * Read the response to the oldest pipelined command, and record a
+ * failure against the batch entry it was sent for.
+ *
+ * @return An error that leaves the remaining responses unaccounted
+ * for; the module's own errors are only recorded.
+ */
+static TMR_Status
+receivePipelined(TMR_Reader *reader)
+{
+  TMR_SR_Pipeline *p;
+  TMR_Status ret;
+  uint8_t msg[TMR_SR_MAX_PACKET_SIZE];
+  uint8_t slot;
+
+  p = &reader->u.serialReader.pipeline;
+  slot = p->head;
+  p->head = (p->head + 1) % TMR_SR_PIPELINE_DEPTH;
+  p->count--;
+  ret = TMR_SR_receiveMessage(reader, msg, p->pending[slot].opcode, p->pending[slot].timeoutMs);
+  if ((TMR_SUCCESS != ret) && (TMR_SUCCESS == reader->batchOps[p->pending[slot].op].status))
+  {
+    reader->batchOps[p->pending[slot].op].status = ret;
+  }
+  if ((TMR_SUCCESS == ret) || TMR_ERROR_IS_CODE(ret))
+  {
+    return TMR_SUCCESS;
+  }
+
+  /* Out of step with the module: fail everything still in flight */
+  while (0 != p->count)
+  {
+    slot = p->head;
+    p->head = (p->head + 1) % TMR_SR_PIPELINE_DEPTH;
+    p->count--;
+    if (TMR_SUCCESS == reader->batchOps[p->pending[slot].op].status)
+    {
+      reader->batchOps[p->pending[slot].op].status = ret;
+    }
+  }
+  reader->u.serialReader.transport.flush(&reader->u.serialReader.transport);
+  return ret;
+}
+
+/** Whether a batch entry up to the current one has failed */
+static bool
+batchFailed(TMR_Reader *reader)
+{
+  uint32_t i;
+
+  for (i = 0; i <= reader->batchIndex; i++)
+  {
+    if (TMR_SUCCESS != reader->batchOps[i].status)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Read the responses to all pipelined commands. Their outcomes go to
+ * the batch entries they were sent for.
+ */
+TMR_Status
+TMR_SR_flushPipeline(TMR_Reader *reader)
+{
+  TMR_Status ret;
+
+  while (0 != reader->u.serialReader.pipeline.count)
+  {
+    ret = receivePipelined(reader);
+    if (TMR_SUCCESS != ret)
+    {
+      return ret;
+    }
+  }
+  return TMR_SUCCESS;
+}
+
 /**
  * Send a message and receive a response.
  *
@@ -449,8 +575,32 @@ TMR_SR_receiveMessage(TMR_Reader *reader, uint8_t *data, uint8_t opcode, uint32_
 TMR_Status
 TMR_SR_sendTimeout(TMR_Reader *reader, uint8_t *data, uint32_t timeoutMs)
 {
+  TMR_SR_SerialReader *sr;
   TMR_Status ret;
   uint8_t opcode;
+  uint8_t resend[TMR_SR_MAX_PACKET_SIZE];
+  uint64_t sentUs;
+
+  sr = &reader->u.serialReader;
+  /* Commands go out, and are answered, in order */
+  if (0 != sr->pipeline.count)
+  {
+    ret = TMR_SR_flushPipeline(reader);
+    if (TMR_SUCCESS != ret)
+    {
+      return ret;
+    }
+    if (batchFailed(reader))
+    {
+      return TMR_ERROR_BATCH_ABORTED;
+    }
+  }
+  /* Keep the command in case it has to go again with the preamble */
+  if (sr->supportsPreamble)
+  {
+    memcpy(resend, data, data[1] + 5);
+  }
+  sentUs = tmr_gettime_us();
   ret = TMR_SR_sendMessage(reader, data, &opcode, timeoutMs);
   if (TMR_SUCCESS != ret)
   {
@@ -488,6 +638,41 @@ TMR_SR_sendTimeout(TMR_Reader *reader, uint8_t *data, uint32_t timeoutMs)
   else
   {
     ret = TMR_SR_receiveMessage(reader, data, opcode, timeoutMs);
+    if ((TMR_ERROR_TIMEOUT == ret) && sr->preambleSkipped &&
+        (sr->lastExchangeUs < sentUs))
+    {
+      /*
+       * Not a word from the module: it went to sleep after all, and
+       * may sleep sooner than assumed. Wake it up before every command
+       * for a while rather than pay for another timeout, backing off
+       * further each time this happens again.
+       */
+      memcpy(data, resend, resend[1] + 5);
+      if (0 == sr->preambleBackoffMs)
+      {
+        sr->preambleBackoffMs = TMR_SR_PREAMBLE_BACKOFF_MS;
+      }
+      else if (sr->preambleBackoffMs < TMR_SR_PREAMBLE_BACKOFF_MAX_MS / 2)
+      {
+        sr->preambleBackoffMs *= 2;
+      }
+      else
+      {
+        sr->preambleBackoffMs = TMR_SR_PREAMBLE_BACKOFF_MAX_MS;
+      }
+      sr->preambleForcedUntilUs = tmr_gettime_us() + (uint64_t)sr->preambleBackoffMs * 1000;
+      ret = TMR_SR_sendMessage(reader, data, &opcode, timeoutMs);
+      if (TMR_SUCCESS != ret)
+      {
+        return ret;
+      }
+      ret = TMR_SR_receiveMessage(reader, data, opcode, timeoutMs);
+    }
+    else if ((TMR_SUCCESS == ret) && sr->preambleSkipped)
+    {
+      /* Skipping it worked: the idle threshold holds again */
+      sr->preambleBackoffMs = 0;
+    }
     if (TMR_SUCCESS != ret)
     {
 		return ret;
@@ -504,6 +689,61 @@ TMR_SR_send(TMR_Reader *reader, uint8_t *data)
                             reader->u.serialReader.commandTimeout);
 }
 
+/**
+ * Send a settings command whose response is nothing but a status.
+ * Within a TMR_paramSetMany() batch the response is read later, by
+ * TMR_SR_flushPipeline() or when the pipeline is full, so that the
+ * next commands of the batch go out without waiting for it.
+ *
+ * A command that may find the module asleep is sent alone, so that
+ * TMR_SR_sendTimeout() can wake it up and send it again. Callers that
+ * act on the outcome themselves use TMR_SR_send() instead.
+ *
+ * @param reader The reader
+ * @param data Message to send, as for TMR_SR_send()
+ */
+static TMR_Status
+sendSetting(TMR_Reader *reader, uint8_t *data)
+{
+  TMR_SR_SerialReader *sr;
+  TMR_SR_Pipeline *p;
+  TMR_Status ret;
+  uint8_t opcode, slot;
+
+  sr = &reader->u.serialReader;
+  p = &sr->pipeline;
+  if ((NULL == reader->batchOps) || (TMR_SR_PIPELINE_DEPTH < 2)
+      || isContinuousReadParamSupported(reader)
+      || ((0 == p->count) && sr->supportsPreamble && preambleNeeded(sr)))
+  {
+    return TMR_SR_send(reader, data);
+  }
+
+  if (TMR_SR_PIPELINE_DEPTH == p->count)
+  {
+    ret = receivePipelined(reader);
+    if (TMR_SUCCESS != ret)
+    {
+      return ret;
+    }
+    if (batchFailed(reader))
+    {
+      return TMR_ERROR_BATCH_ABORTED;
+    }
+  }
+  ret = TMR_SR_sendMessage(reader, data, &opcode, sr->commandTimeout);
+  if (TMR_SUCCESS != ret)
+  {
+    return ret;
+  }
+  slot = (p->head + p->count) % TMR_SR_PIPELINE_DEPTH;
+  p->pending[slot].opcode = opcode;
+  p->pending[slot].op = reader->batchIndex;
+  p->pending[slot].timeoutMs = sr->commandTimeout;
+  p->count++;
+  return TMR_SUCCESS;
+}
+
 /**
  * Set the operating frequency of the device.
  * Testing command.
@@ -2254,43 +2494,122 @@ TMR_SR_parseMetadataOnly(TMR_Reader *reader, TMR_TagReadData *read, uint16_t fla
   }
 }
 
+/* Length of a drift window, the span needed before trusting the
+ * estimate, and the largest drift believed (1000 ppm) */
+#define TMR_SR_DRIFT_WINDOW_US 1000000
+#define TMR_SR_DRIFT_MIN_SPAN_US 10000000
+#define TMR_SR_DRIFT_MAX_PPB 1000000
+
+/**
+ * Start a new time base for the module's tag timestamps: the read
+ * starts now on the host's monotonic clock, and the wall clock is
+ * sampled once here so that a clock step during the read cannot
+ * reorder the reported reads.
+ */
 void
-TMR_SR_postprocessReaderSpecificMetadata(TMR_TagReadData *read, TMR_SR_SerialReader *sr)
+TMR_SR_resetTimeBase(TMR_SR_SerialReader *sr)
 {
-  uint16_t j;
-  uint32_t timestampLow;
-  uint64_t currTime64, lastSentTagTime64; /*for comparison*/
-  int32_t tempDiff;
+  uint64_t now;
+  TMR_SR_ClockDrift *cd = &sr->clockDrift;
+
+  now = tmr_gettime_us();
+  sr->timeBaseUs = now;
+  sr->lastSentTagUs = now;
+  sr->rxUs = 0;
+  sr->wallOffsetUs = (int64_t)(tmr_gettime() * 1000) - (int64_t)now;
 
-  timestampLow = sr->readTimeLow;
-  read->timestampHigh = sr->readTimeHigh;
+  cd->streamStartUs = now;
+  cd->windowStartUs = 0;
+  cd->windowMin = INT64_MAX;
+  cd->refValid = false;
+}
 
-  timestampLow = timestampLow + read->dspMicros;
-  currTime64 = ((uint64_t)read->timestampHigh << 32) | timestampLow;
-  lastSentTagTime64 = ((uint64_t)sr->lastSentTagTimestampHigh << 32) | sr->lastSentTagTimestampLow;
-  if (lastSentTagTime64 >= currTime64)
+/**
+ * Update the drift estimate with a tag the module timestamped at
+ * moduleUs (host time base plus the module's offset) and that arrived
+ * at rxUs. The estimate is the slope of the per-window minimum of
+ * rxUs - moduleUs against the first window's.
+ */
+static void
+trackClockDrift(TMR_SR_ClockDrift *cd, uint64_t moduleUs, uint64_t rxUs)
+{
+  int64_t residual;
+
+  residual = (int64_t)(rxUs - moduleUs);
+  if (0 == cd->windowStartUs)
+  {
+    cd->windowStartUs = rxUs;
+  }
+  if (residual < cd->windowMin)
   {
-    tempDiff = (int32_t)(currTime64 - lastSentTagTime64);
-    timestampLow = timestampLow - tempDiff + 1;
-    if (timestampLow < sr->lastSentTagTimestampLow) /*account for overflow*/
+    cd->windowMin = residual;
+  }
+  if (rxUs - cd->windowStartUs < TMR_SR_DRIFT_WINDOW_US)
+  {
+    return;
+  }
+
+  if (false == cd->refValid)
+  {
+    cd->refValid = true;
+    cd->refUs = cd->windowStartUs;
+    cd->refResidual = cd->windowMin;
+  }
+  else if (cd->windowStartUs - cd->refUs >= TMR_SR_DRIFT_MIN_SPAN_US)
+  {
+    int64_t ppb;
+
+    ppb = (cd->windowMin - cd->refResidual) * 1000000 / (int64_t)((cd->windowStartUs - cd->refUs) / 1000);
+    if ((ppb <= TMR_SR_DRIFT_MAX_PPB) && (ppb >= -TMR_SR_DRIFT_MAX_PPB))
     {
-      read->timestampHigh++;
+      cd->ppb = (int32_t)ppb;
     }
   }
-  if (timestampLow < sr->readTimeLow) /* Overflow */
+  cd->windowStartUs = rxUs;
+  cd->windowMin = INT64_MAX;
+}
+
+void
+TMR_SR_postprocessReaderSpecificMetadata(TMR_TagReadData *read, TMR_SR_SerialReader *sr)
+{
+  uint16_t j;
+  uint64_t micros, unixms;
+
+  /*
+   * The module timestamps each tag in milliseconds since the time base,
+   * so this has 1 ms resolution. Frame arrival says nothing finer:
+   * tags are batched and arrive later than they were read.
+   */
+  micros = sr->timeBaseUs + (uint64_t)read->dspMicros * 1000;
+  if (0 != sr->rxUs)
+  {
+    trackClockDrift(&sr->clockDrift, micros, sr->rxUs);
+  }
+  if (0 != sr->clockDrift.ppb)
+  {
+    micros += (int64_t)(micros - sr->clockDrift.streamStartUs) * sr->clockDrift.ppb / 1000000000LL;
+  }
+
+  /* A tag can't have been read after its frame arrived, nor before the last one reported */
+  if ((0 != sr->rxUs) && (micros > sr->rxUs))
+  {
+    micros = sr->rxUs;
+  }
+  if (micros < sr->lastSentTagUs)
   {
-    read->timestampHigh++;
+    micros = sr->lastSentTagUs;
   }
-  read->timestampLow = timestampLow;
-  sr->lastSentTagTimestampHigh = read->timestampHigh;
-  sr->lastSentTagTimestampLow = read->timestampLow;
+  sr->lastSentTagUs = micros;
+  read->timestampMicros = micros;
+
+  unixms = (uint64_t)((int64_t)micros + sr->wallOffsetUs) / 1000;
+  read->timestampHigh = (uint32_t)(unixms >> 32);
+  read->timestampLow = (uint32_t)unixms;
 
 #ifdef WIN32
  {	 
-    uint64_t unixms;
     FILETIME ft;
 
-	unixms= ((uint64_t)(read->timestampHigh)<<32) | (read->timestampLow);   
     tmr_unixms_to_filetime(unixms, &ft);
     read->timestampHigh =(uint32_t)ft.dwHighDateTime;
     read->timestampLow = (uint32_t)ft.dwLowDateTime;
@@ -2707,7 +3026,6 @@ TMR_SR_cmdGEN2ReadTagData(TMR_Reader *reader,
   TMR_Status ret;
   uint8_t msg[TMR_SR_MAX_PACKET_SIZE];
   uint8_t optbyte, i, mdfbyte;
-  uint32_t starttimeHigh, starttimeLow;
 
   i = 2;
   TMR_SR_msgAddGEN2DataRead(msg, &i, timeout, bank, address, length, 0x00, true);
@@ -2729,9 +3047,7 @@ TMR_SR_cmdGEN2ReadTagData(TMR_Reader *reader,
   msg[1] = i - 3; /* Install length */
 
   /* Cache the read time so it can be put in tag read data later */
-  tm_gettime_consistent(&starttimeHigh, &starttimeLow);
-  reader->u.serialReader.readTimeHigh = starttimeHigh;
-  reader->u.serialReader.readTimeLow = starttimeLow;
+  TMR_SR_resetTimeBase(&reader->u.serialReader);
 
   ret = TMR_SR_sendTimeout(reader, msg, timeout);
   if (TMR_SUCCESS != ret)
@@ -2778,7 +3094,7 @@ TMR_SR_cmdSetTxRxPorts(TMR_Reader *reader, uint8_t txPort, uint8_t rxPort)
   SETU8(msg, i, rxPort);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -2800,7 +3116,7 @@ TMR_SR_cmdSetAntennaSearchList(TMR_Reader *reader, uint8_t count,
   }
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status
@@ -2852,7 +3168,7 @@ TMR_SR_cmdSetAntennaPortPowersAndSettlingTime(
   }
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -2874,7 +3190,7 @@ TMR_SR_cmdSetReadTxPower(TMR_Reader *reader, int32_t power)
   SETS16(msg,i, (int16_t)power);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -2911,7 +3227,7 @@ TMR_SR_cmdSetWriteTxPower(TMR_Reader *reader, int32_t power)
   SETS16(msg, i, (int16_t)power);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -2936,7 +3252,7 @@ TMR_SR_cmdSetFrequencyHopTable(TMR_Reader *reader, uint8_t count,
   }
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -2952,7 +3268,7 @@ TMR_SR_cmdSetFrequencyHopTime(TMR_Reader *reader, uint32_t hopTime)
   SETU32(msg, i, hopTime);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 /**
@@ -2973,7 +3289,7 @@ TMR_SR_cmdSetQuantizationStep(TMR_Reader *reader, uint32_t step)
   SETU32(msg, i, step);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 /**
@@ -2994,7 +3310,7 @@ TMR_SR_cmdSetMinimumFrequency(TMR_Reader *reader, uint32_t freq)
   SETU32(msg, i, freq);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status
@@ -3009,7 +3325,7 @@ TMR_SR_cmdSetGPIO(TMR_Reader *reader, uint8_t gpio, bool high)
   SETU8(msg, i, (high == true));
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status 
@@ -3083,7 +3399,7 @@ TMR_SR_cmdSetRegion(TMR_Reader *reader, TMR_Region region)
   DwellTimeEnable = false;
   LBTEnable = false;
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status
@@ -3100,7 +3416,7 @@ TMR_SR_cmdSetRegionDwellTimeEnable(TMR_Reader *reader, TMR_Region region, bool d
   SETU8(msg, i, dwellTimeEnable ? 1:0);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status
@@ -3117,7 +3433,7 @@ TMR_SR_cmdSetRegionDwellTime(TMR_Reader *reader, TMR_Region region, uint16_t dwe
   SETU16(msg, i, dwellTime);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status
@@ -3134,7 +3450,7 @@ TMR_SR_cmdSetRegionLbtThreshold(TMR_Reader *reader, TMR_Region region, int8_t lb
   SETU8(msg, i, lbtThreshold);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status
@@ -3151,7 +3467,7 @@ TMR_SR_cmdSetRegionLbt(TMR_Reader *reader, TMR_Region region, bool lbt)
   SETU8(msg, i, lbt ? 1 : 0);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -3181,7 +3497,7 @@ TMR_SR_cmdSetUserMode(TMR_Reader *reader, TMR_SR_UserMode mode)
   SETU8(msg, i, mode);
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -3245,7 +3561,22 @@ TMR_SR_cmdSetReaderConfiguration(TMR_Reader *reader, TMR_SR_Configuration key,
   }
   msg[1] = i - 3; /* Install length */
 
-  return TMR_SR_send(reader, msg);
+  switch (key)
+  {
+  /* The responses that follow change with the CRC setting */
+  case TMR_SR_CONFIGURATION_SEND_CRC:
+  /*
+   * TMR_SR_paramSet() updates its own copy of these from the outcome,
+   * so it has to be the module's answer, not a pipelined success
+   */
+  case TMR_SR_CONFIGURATION_ANTENNA_CONTROL_GPIO:
+  case TMR_SR_CONFIGURATION_ENABLE_READ_FILTER:
+  case TMR_SR_CONFIGURATION_READ_FILTER_TIMEOUT:
+  case TMR_SR_CONFIGURATION_EXTENDED_EPC:
+    return TMR_SR_send(reader, msg);
+  default:
+    return sendSetting(reader, msg);
+  }
 }
 
 /**
@@ -3508,7 +3839,7 @@ TMR_SR_cmdSetProtocolConfiguration(TMR_Reader *reader, TMR_TagProtocol protocol,
   }
 
   msg[1] = i - 3; /* Install length */
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 
@@ -8619,7 +8950,7 @@ TMR_SR_cmdSetReaderWriteTimeOut (struct TMR_Reader *reader, TMR_TagProtocol prot
   SETU16(msg,i, value->writetimeout);
 
   msg[1] = i - 3; /* Install length */
-  return TMR_SR_send(reader, msg);
+  return sendSetting(reader, msg);
 }
 
 TMR_Status
@@ -85,26 +85,39 @@ struct llrp_param
 
 
 
+/* Receive one LLRP message by deadlineUs (tmr_gettime_us() clock), or
+ * with no time limit if deadlineUs is zero.
+ */
 static TMR_Status
 llrp_receive_message(int sockfd, struct llrp_message *message, uint8_t *buf,
-                     uint16_t buflen, uint32_t timeout)
+                     uint16_t buflen, uint64_t deadlineUs)
 {
   int ret;
   ssize_t msgsize, retlen;
   struct timeval timeo;
-
-  timeo.tv_sec = timeout / 1000;
-  timeo.tv_usec = 1000 * (timeout % 1000);
-
-  ret = setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeo, sizeof(timeo));
-  if (-1 == ret)
-  {
-    return TMR_ERROR_COMM_ERRNO(errno);
-  }
+  uint32_t timeout;
 
   msgsize = 0;
   do
   {
+    /* Each recv() only gets what is left of the deadline */
+    timeout = 0;
+    if (0 != deadlineUs)
+    {
+      timeout = tm_remaining_ms(deadlineUs);
+      if (0 == timeout)
+      {
+        return TMR_ERROR_TIMEOUT;
+      }
+    }
+    timeo.tv_sec = timeout / 1000;
+    timeo.tv_usec = 1000 * (timeout % 1000);
+    ret = setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeo, sizeof(timeo));
+    if (-1 == ret)
+    {
+      return TMR_ERROR_COMM_ERRNO(errno);
+    }
+
     retlen = recv(sockfd, buf + msgsize, buflen - msgsize, 0);
     if (-1 == retlen)
     {
@@ -235,7 +248,7 @@ llrp_check_success(uint8_t *msgptr, uint16_t msglen)
  */
 static TMR_Status
 llrp_receive_message_filtered(int sockfd, struct llrp_message *message,
-                              uint8_t *buf, uint16_t buflen, uint32_t timeout)
+                              uint8_t *buf, uint16_t buflen, uint64_t deadlineUs)
 {
   struct llrp_param param;
   TMR_Status ret;
@@ -243,7 +256,7 @@ llrp_receive_message_filtered(int sockfd, struct llrp_message *message,
 
   while (1)
   {
-    ret = llrp_receive_message(sockfd, message, buf, buflen, timeout);
+    ret = llrp_receive_message(sockfd, message, buf, buflen, deadlineUs);
     if (TMR_SUCCESS != ret)
     {
       return ret;
@@ -411,8 +424,8 @@ s_receiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
     return TMR_SUCCESS;
   }
 
-  ret = llrp_receive_message_filtered(context->socket, &message, buf,
-                                      sizeof(buf), timeoutMs);
+  ret = llrp_receive_message_filtered(context->socket, &message, buf, sizeof(buf),
+                                      (0 == timeoutMs) ? 0 : tm_deadline_us(timeoutMs));
   if (TMR_SUCCESS != ret)
   {
     return ret;
@@ -37,6 +37,10 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include "tm_reader.h"
+#include "tmr_utils.h"
+
+/* In serial_transport_posix_termios2.c, EINVAL where not supported */
+int tmr_posix_setArbitraryBaudRate(int handle, uint32_t rate);
 
 #ifdef __APPLE__
 #include <sys/ioctl.h>
@@ -45,6 +49,41 @@
 
 #ifdef TMR_ENABLE_SERIAL_TRANSPORT_NATIVE
 
+#if TMR_SR_READAHEAD_SIZE > 0
+/*
+ * The read-ahead buffer holds bytes that would otherwise still be
+ * waiting in the kernel, so only a new handle invalidates it; flush
+ * leaves it alone. These two are shared with the TCP transport.
+ */
+
+/**
+ * Copy up to length bytes already held in the read-ahead buffer into
+ * message, returning the number of bytes copied.
+ */
+uint32_t
+tmr_posix_takeReadAhead(TMR_SR_SerialPortNativeContext *c, uint32_t length,
+                        uint8_t *message)
+{
+  uint32_t n;
+
+  n = c->rxLen - c->rxPos;
+  if (n > length)
+  {
+    n = length;
+  }
+  memcpy(message, c->rxBuf + c->rxPos, n);
+  c->rxPos += n;
+  return n;
+}
+
+/** Drop whatever is in the read-ahead buffer */
+void
+tmr_posix_discardReadAhead(TMR_SR_SerialPortNativeContext *c)
+{
+  c->rxPos = c->rxLen = 0;
+}
+#endif
+
 static TMR_Status
 s_open(TMR_SR_SerialTransport *this)
 {
@@ -59,6 +98,9 @@ s_open(TMR_SR_SerialTransport *this)
   if (c->handle == -1)
     return TMR_ERROR_COMM_ERRNO(errno);
 #endif
+#if TMR_SR_READAHEAD_SIZE > 0
+  tmr_posix_discardReadAhead(c);
+#endif
 
   /*
    * Set 8N1, disable high-bit stripping, soft flow control, and hard
@@ -121,23 +163,50 @@ s_receiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
   struct timeval tv;
   fd_set set;
   int status = 0;
+  uint8_t *dest;
+  uint32_t destLen, remainingMs;
+  uint64_t deadlineUs;
 
   *messageLength = 0;
   c = this->cookie;
+  /* One deadline for all of length, not timeoutMs per select() */
+  deadlineUs = tm_deadline_us(timeoutMs);
+
+#if TMR_SR_READAHEAD_SIZE > 0
+  ret = tmr_posix_takeReadAhead(c, length, message);
+  length -= ret;
+  *messageLength += ret;
+  message += ret;
+#endif
 
-  do
+  while (length > 0)
   {
     FD_ZERO(&set);
     FD_SET(c->handle, &set);
-    tv.tv_sec = timeoutMs / 1000;
-    tv.tv_usec = (timeoutMs % 1000) * 1000;
-    /* Ideally should reset this timeout value every time through */
+    remainingMs = tm_remaining_ms(deadlineUs);
+    tv.tv_sec = remainingMs / 1000;
+    tv.tv_usec = (remainingMs % 1000) * 1000;
     ret = select(c->handle + 1, &set, NULL, NULL, &tv);
     if (ret < 1)
     {
       return TMR_ERROR_TIMEOUT;
     }
-    ret = read(c->handle, message, length);
+
+    /*
+     * Small requests (headers, short responses) read everything that
+     * is pending into the read-ahead buffer; large ones go straight
+     * into the caller's buffer.
+     */
+    dest = message;
+    destLen = length;
+#if TMR_SR_READAHEAD_SIZE > 0
+    if (length < sizeof(c->rxBuf))
+    {
+      dest = c->rxBuf;
+      destLen = sizeof(c->rxBuf);
+    }
+#endif
+    ret = read(c->handle, dest, destLen);
     if (ret == -1)
     {
       if (ENXIO == errno)
@@ -170,13 +239,22 @@ s_receiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
           return TMR_ERROR_TIMEOUT;
         }
       }
+      continue;
+    }
+
+#if TMR_SR_READAHEAD_SIZE > 0
+    if (dest == c->rxBuf)
+    {
+      c->rxPos = 0;
+      c->rxLen = (uint16_t)ret;
+      ret = tmr_posix_takeReadAhead(c, length, message);
     }
+#endif
 
     length -= ret;
     *messageLength += ret;
     message += ret;
   }
-  while (length > 0);
 
   return TMR_SUCCESS;
 }
@@ -185,7 +263,7 @@ static TMR_Status
 s_setBaudRate(TMR_SR_SerialTransport *this, uint32_t rate)
 {
   TMR_SR_SerialPortNativeContext *c;
-  
+
   c = this->cookie;
 
 #if defined(__APPLE__)
@@ -198,6 +276,7 @@ s_setBaudRate(TMR_SR_SerialTransport *this, uint32_t rate)
 #else
   {
     struct termios t;
+    bool standard = true;
 
     tcgetattr(c->handle, &t);
 
@@ -224,12 +303,28 @@ s_setBaudRate(TMR_SR_SerialTransport *this, uint32_t rate)
       BCASE(&t, 921600);
 #endif
     default:
-      return TMR_ERROR_INVALID;
+      standard = false;
+      break;
     }
 #undef BCASE
-    if (tcsetattr(c->handle, TCSANOW, &t) != 0)
+    if (standard)
     {
-      return TMR_ERROR_COMM_ERRNO(errno);
+      if (tcsetattr(c->handle, TCSANOW, &t) != 0)
+      {
+        return TMR_ERROR_COMM_ERRNO(errno);
+      }
+    }
+    else
+    {
+      /* Anything else, such as the 2-3 Mbaud of USB-UART bridges,
+       * where the platform can set an explicit rate */
+      int err;
+
+      err = tmr_posix_setArbitraryBaudRate(c->handle, rate);
+      if (0 != err)
+      {
+        return (EINVAL == err) ? TMR_ERROR_INVALID : TMR_ERROR_COMM_ERRNO(err);
+      }
     }
   }
 #endif /* __APPLE__ */
@@ -286,6 +381,10 @@ TMR_SR_SerialTransportNativeInit(TMR_SR_SerialTransport *transport,
   }
 #endif
 
+#if TMR_SR_READAHEAD_SIZE > 0
+  tmr_posix_discardReadAhead(context);
+#endif
+
   transport->cookie = context;
   transport->open = s_open;
   transport->sendBytes = s_sendBytes;
@@ -0,0 +1,77 @@
+/**
+ *  @file serial_transport_posix_termios2.c
+ *  @brief Mercury API - Linux arbitrary baud rates for the POSIX serial transport
+ */
+
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The kernel's struct termios2 and BOTHER come from <asm/termbits.h>,
+ * which can't be included together with the C library's <termios.h>,
+ * so this lives in a file of its own.
+ */
+#include <stdint.h>
+#include <errno.h>
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+#endif
+
+/**
+ * Set both directions of the serial port to any rate the driver can
+ * generate, not only the Bxxxx constants.
+ *
+ * @param handle The open serial port
+ * @param rate The rate in bits per second
+ * @return 0 on success, otherwise an errno value
+ */
+int
+tmr_posix_setArbitraryBaudRate(int handle, uint32_t rate)
+{
+#if defined(__linux__) && defined(TCGETS2) && defined(BOTHER)
+  struct termios2 t;
+
+  if (-1 == ioctl(handle, TCGETS2, &t))
+  {
+    return errno;
+  }
+  t.c_cflag &= ~CBAUD;
+  t.c_cflag |= BOTHER;
+#ifdef IBSHIFT
+  /* The input rate follows the same, explicit, speed */
+  t.c_cflag &= ~(CBAUD << IBSHIFT);
+  t.c_cflag |= BOTHER << IBSHIFT;
+#endif
+  t.c_ispeed = rate;
+  t.c_ospeed = rate;
+  if (-1 == ioctl(handle, TCSETS2, &t))
+  {
+    return errno;
+  }
+  return 0;
+#else
+  return EINVAL;
+#endif
+}
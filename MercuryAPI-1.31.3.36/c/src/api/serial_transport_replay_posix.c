@@ -0,0 +1,585 @@
+/**
+ *  @file serial_transport_replay_posix.c
+ *  @brief Mercury API - serial transports that record a session to a
+ *  capture file and play one back, for POSIX
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "tm_reader.h"
+#include "tmr_utils.h"
+
+#ifdef TMR_ENABLE_SERIAL_TRANSPORT_NATIVE
+
+/*
+ * Capture file format, all integers big-endian like the serial
+ * protocol itself:
+ *
+ *   header:  "TMRC", u8 version (1), 3 bytes reserved
+ *   record:  u8 kind, u32 microseconds since the previous record
+ *            (the first one: since the transport was opened),
+ *            u16 payload length, payload
+ *
+ * A receive that failed stores the TMR_Status as a u32 at the start
+ * of its payload, followed by whatever bytes arrived before the error.
+ */
+#define CAPTURE_MAGIC          "TMRC"
+#define CAPTURE_VERSION        1
+#define CAPTURE_HEADER_LEN     8
+#define CAPTURE_RECORD_LEN     7
+#define CAPTURE_MAX_PAYLOAD    0xFFFF
+
+#define CAPTURE_SEND           1
+#define CAPTURE_RECEIVE        2
+#define CAPTURE_RECEIVE_ERROR  3
+#define CAPTURE_BAUD_RATE      4
+
+typedef struct TMR_SR_CaptureContext
+{
+  /** Capture file */
+  FILE *file;
+  /** Its name, opened by the open callback */
+  char filename[TMR_MAX_READER_NAME_LENGTH];
+  /** Monotonic time of the last record written or replayed, microseconds */
+  uint64_t lastUs;
+
+  /** Recording: the transport to the module */
+  TMR_SR_SerialTransport inner;
+
+  /** Replay: feed receives as fast as they are asked for */
+  bool fast;
+  /** Recorded and wall clock time of the last command sent */
+  uint64_t anchorRecordedUs, anchorWallUs;
+  /** Recorded time of the record at the file position */
+  uint64_t recordedUs;
+  /** The record read ahead of use, valid if kind is not 0 */
+  uint8_t kind;
+  uint32_t delayUs;
+  uint16_t length;
+  /** Received bytes of the current record not yet handed out */
+  uint8_t payload[CAPTURE_MAX_PAYLOAD];
+  uint16_t payloadPos;
+  uint16_t payloadLen;
+} TMR_SR_CaptureContext;
+
+static uint64_t
+nowUs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void
+sleepUs(uint64_t us)
+{
+  struct timespec ts;
+
+  ts.tv_sec = (time_t)(us / 1000000);
+  ts.tv_nsec = (long)(us % 1000000) * 1000;
+  while ((0 != nanosleep(&ts, &ts)) && (EINTR == errno))
+  {
+  }
+}
+
+/**
+ * Split "<path>?<option>" as found in the URI, dropping the extra
+ * leading slashes TMR_create() leaves on custom scheme devices.
+ */
+static TMR_Status
+splitDevice(const char *device, char *path, size_t pathSize, const char **option)
+{
+  const char *query;
+  size_t len;
+
+  while (('/' == device[0]) && ('/' == device[1]))
+  {
+    device++;
+  }
+  query = strchr(device, '?');
+  len = (NULL != query) ? (size_t)(query - device) : strlen(device);
+  if ((0 == len) || (len + 1 > pathSize))
+  {
+    return TMR_ERROR_INVALID;
+  }
+  memcpy(path, device, len);
+  path[len] = '\0';
+  *option = (NULL != query) ? query + 1 : "";
+  return TMR_SUCCESS;
+}
+
+
+/* Recording */
+
+static TMR_Status
+writeRecord(TMR_SR_CaptureContext *c, uint8_t kind, const uint8_t *head, uint16_t headLen,
+            const uint8_t *data, uint32_t dataLen)
+{
+  uint8_t hdr[CAPTURE_RECORD_LEN];
+  uint64_t now, delay;
+  int i = 0;
+
+  if (headLen + dataLen > CAPTURE_MAX_PAYLOAD)
+  {
+    dataLen = CAPTURE_MAX_PAYLOAD - headLen;
+  }
+  now = nowUs();
+  delay = now - c->lastUs;
+  c->lastUs = now;
+
+  SETU8(hdr, i, kind);
+  SETU32(hdr, i, (delay > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)delay);
+  SETU16(hdr, i, (uint16_t)(headLen + dataLen));
+  if ((1 != fwrite(hdr, sizeof(hdr), 1, c->file))
+      || ((0 < headLen) && (1 != fwrite(head, headLen, 1, c->file)))
+      || ((0 < dataLen) && (1 != fwrite(data, dataLen, 1, c->file))))
+  {
+    return TMR_ERROR_COMM_ERRNO(errno);
+  }
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+record_open(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+  uint8_t hdr[CAPTURE_HEADER_LEN] = CAPTURE_MAGIC;
+
+  c->file = fopen(c->filename, "wb");
+  if (NULL == c->file)
+  {
+    return TMR_ERROR_COMM_ERRNO(errno);
+  }
+  hdr[4] = CAPTURE_VERSION;
+  if (1 != fwrite(hdr, sizeof(hdr), 1, c->file))
+  {
+    return TMR_ERROR_COMM_ERRNO(errno);
+  }
+  c->lastUs = nowUs();
+
+  return c->inner.open(&c->inner);
+}
+
+static TMR_Status
+record_sendBytes(TMR_SR_SerialTransport *this, uint32_t length,
+                 uint8_t* message, const uint32_t timeoutMs)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+  TMR_Status ret;
+
+  ret = writeRecord(c, CAPTURE_SEND, NULL, 0, message, length);
+  if (TMR_SUCCESS != ret)
+  {
+    return ret;
+  }
+  return c->inner.sendBytes(&c->inner, length, message, timeoutMs);
+}
+
+static TMR_Status
+record_receiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
+                    uint32_t* messageLength, uint8_t* message, const uint32_t timeoutMs)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+  TMR_Status ret, wret;
+
+  ret = c->inner.receiveBytes(&c->inner, length, messageLength, message, timeoutMs);
+  if (TMR_SUCCESS == ret)
+  {
+    wret = writeRecord(c, CAPTURE_RECEIVE, NULL, 0, message, *messageLength);
+  }
+  else
+  {
+    uint8_t status[4];
+    int i = 0;
+
+    SETU32(status, i, ret);
+    wret = writeRecord(c, CAPTURE_RECEIVE_ERROR, status, sizeof(status), message, *messageLength);
+  }
+  return (TMR_SUCCESS != wret) ? wret : ret;
+}
+
+static TMR_Status
+record_setBaudRate(TMR_SR_SerialTransport *this, uint32_t rate)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+  uint8_t data[4];
+  int i = 0;
+
+  if (NULL == c->inner.setBaudRate)
+  {
+    return TMR_SUCCESS;
+  }
+  SETU32(data, i, rate);
+  writeRecord(c, CAPTURE_BAUD_RATE, NULL, 0, data, sizeof(data));
+  return c->inner.setBaudRate(&c->inner, rate);
+}
+
+static TMR_Status
+record_flush(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+
+  fflush(c->file);
+  return c->inner.flush(&c->inner);
+}
+
+static TMR_Status
+record_shutdown(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+  TMR_Status ret;
+
+  ret = c->inner.shutdown(&c->inner);
+  if ((NULL != c->file) && (0 != fclose(c->file)) && (TMR_SUCCESS == ret))
+  {
+    ret = TMR_ERROR_COMM_ERRNO(errno);
+  }
+  free(c);
+  this->cookie = NULL;
+
+  return ret;
+}
+
+
+/* Replay */
+
+/**
+ * Read the header of the next record, if not done already.
+ * Returns false at the end of the capture.
+ */
+static bool
+peekRecord(TMR_SR_CaptureContext *c)
+{
+  uint8_t hdr[CAPTURE_RECORD_LEN];
+
+  if (0 != c->kind)
+  {
+    return true;
+  }
+  if (1 != fread(hdr, sizeof(hdr), 1, c->file))
+  {
+    return false;
+  }
+  c->kind = GETU8AT(hdr, 0);
+  c->delayUs = GETU32AT(hdr, 1);
+  c->length = GETU16AT(hdr, 5);
+  return true;
+}
+
+/** Consume the record peeked at, keeping its payload */
+static bool
+takeRecord(TMR_SR_CaptureContext *c)
+{
+  if ((0 < c->length) && (1 != fread(c->payload, c->length, 1, c->file)))
+  {
+    return false;
+  }
+  c->recordedUs += c->delayUs;
+  c->payloadPos = 0;
+  c->payloadLen = c->length;
+  c->kind = 0;
+  return true;
+}
+
+static TMR_Status
+replay_open(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+  uint8_t hdr[CAPTURE_HEADER_LEN];
+
+  c->file = fopen(c->filename, "rb");
+  if (NULL == c->file)
+  {
+    return TMR_ERROR_COMM_ERRNO(errno);
+  }
+  if ((1 != fread(hdr, sizeof(hdr), 1, c->file))
+      || (0 != memcmp(hdr, CAPTURE_MAGIC, 4)) || (CAPTURE_VERSION != hdr[4]))
+  {
+    fclose(c->file);
+    c->file = NULL;
+    return TMR_ERROR_INVALID;
+  }
+  c->kind = 0;
+  c->recordedUs = c->anchorRecordedUs = 0;
+  c->anchorWallUs = nowUs();
+  c->payloadPos = c->payloadLen = 0;
+
+  return TMR_SUCCESS;
+}
+
+/**
+ * The recorded command is consumed, whatever it was; responses the
+ * API did not read before it are dropped. Responses are timed from
+ * the command they follow.
+ */
+static TMR_Status
+replay_sendBytes(TMR_SR_SerialTransport *this, uint32_t length,
+                 uint8_t* message, const uint32_t timeoutMs)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+
+  while (peekRecord(c))
+  {
+    uint8_t kind = c->kind;
+
+    if ((false == takeRecord(c)) || (CAPTURE_SEND == kind))
+    {
+      break;
+    }
+  }
+  c->payloadPos = c->payloadLen = 0;
+  c->anchorRecordedUs = c->recordedUs;
+  c->anchorWallUs = nowUs();
+
+  return TMR_SUCCESS;
+}
+
+/**
+ * Serve the recorded responses to the last command. Running out of
+ * them, at the next command or the end of the capture, is a timeout,
+ * as a silent module would be.
+ */
+static TMR_Status
+replay_receiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
+                    uint32_t* messageLength, uint8_t* message, const uint32_t timeoutMs)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+  uint64_t deadline = nowUs() + (uint64_t)timeoutMs * 1000;
+
+  *messageLength = 0;
+  while (length > 0)
+  {
+    uint32_t n = c->payloadLen - c->payloadPos;
+
+    if (0 < n)
+    {
+      if (n > length)
+      {
+        n = length;
+      }
+      memcpy(message, &c->payload[c->payloadPos], n);
+      c->payloadPos += n;
+      message += n;
+      length -= n;
+      *messageLength += n;
+      continue;
+    }
+
+    if ((false == peekRecord(c)) || (CAPTURE_SEND == c->kind))
+    {
+      if (false == c->fast)
+      {
+        uint64_t now = nowUs();
+
+        if (deadline > now)
+        {
+          sleepUs(deadline - now);
+        }
+      }
+      return TMR_ERROR_TIMEOUT;
+    }
+
+    if (false == c->fast)
+    {
+      uint64_t due = c->anchorWallUs + (c->recordedUs + c->delayUs - c->anchorRecordedUs);
+      uint64_t now = nowUs();
+
+      if (due > deadline)
+      {
+        if (deadline > now)
+        {
+          sleepUs(deadline - now);
+        }
+        return TMR_ERROR_TIMEOUT;
+      }
+      if (due > now)
+      {
+        sleepUs(due - now);
+      }
+    }
+
+    {
+      uint8_t kind = c->kind;
+
+      if (false == takeRecord(c))
+      {
+        return TMR_ERROR_TIMEOUT;
+      }
+      if ((CAPTURE_RECEIVE_ERROR == kind) && (4 <= c->payloadLen))
+      {
+        TMR_Status ret = GETU32AT(c->payload, 0);
+
+        n = c->payloadLen - 4;
+        if (n > length)
+        {
+          n = length;
+        }
+        memcpy(message, &c->payload[4], n);
+        *messageLength += n;
+        c->payloadPos = c->payloadLen = 0;
+        return ret;
+      }
+      if (CAPTURE_RECEIVE != kind)
+      {
+        c->payloadPos = c->payloadLen = 0;
+      }
+    }
+  }
+
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+replay_setBaudRate(TMR_SR_SerialTransport *this, uint32_t rate)
+{
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+replay_flush(TMR_SR_SerialTransport *this)
+{
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+replay_shutdown(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_CaptureContext *c = this->cookie;
+
+  if (NULL != c->file)
+  {
+    fclose(c->file);
+  }
+  free(c);
+  this->cookie = NULL;
+
+  return TMR_SUCCESS;
+}
+
+/**
+ * Initialize a TMR_SR_SerialTransport structure that talks to a
+ * module on a serial port and records every exchange, with its
+ * timing, to a capture file for TMR_SR_SerialTransportReplayInit().
+ *
+ * Register it with TMR_setSerialTransport("record", ...); the reader
+ * URI is then record:///dev/ttyUSB0?/tmp/capture.trc
+ *
+ * @param transport The TMR_SR_SerialTransport structure to initialize.
+ * @param context A TMR_SR_SerialPortNativeContext structure for the serial port.
+ * @param device The serial device and capture file, separated by '?'
+ */
+TMR_Status
+TMR_SR_SerialTransportRecordInit(TMR_SR_SerialTransport *transport,
+                                 TMR_SR_SerialPortNativeContext *context,
+                                 const char *device)
+{
+  TMR_SR_CaptureContext *c;
+  char path[TMR_MAX_READER_NAME_LENGTH];
+  const char *capture;
+  TMR_Status ret;
+
+  ret = splitDevice(device, path, sizeof(path), &capture);
+  if ((TMR_SUCCESS != ret) || ('\0' == capture[0])
+      || (strlen(capture) + 1 > TMR_MAX_READER_NAME_LENGTH))
+  {
+    return TMR_ERROR_INVALID;
+  }
+  c = malloc(sizeof(*c));
+  if (NULL == c)
+  {
+    return TMR_ERROR_OUT_OF_MEMORY;
+  }
+  memset(c, 0, sizeof(*c));
+  strcpy(c->filename, capture);
+
+  ret = TMR_SR_SerialTransportNativeInit(&c->inner, context, path);
+  if (TMR_SUCCESS != ret)
+  {
+    free(c);
+    return ret;
+  }
+
+  transport->cookie = c;
+  transport->open = record_open;
+  transport->sendBytes = record_sendBytes;
+  transport->receiveBytes = record_receiveBytes;
+  transport->setBaudRate = record_setBaudRate;
+  transport->shutdown = record_shutdown;
+  transport->flush = record_flush;
+
+  return TMR_SUCCESS;
+}
+
+/**
+ * Initialize a TMR_SR_SerialTransport structure that plays back a
+ * capture made with TMR_SR_SerialTransportRecordInit() in place of a
+ * module. Responses come with their recorded delay after each
+ * command, or as fast as they are read with the "fast" option.
+ *
+ * Register it with TMR_setSerialTransport("replay", ...); the reader
+ * URI is then replay:///tmp/capture.trc or replay:///tmp/capture.trc?fast
+ *
+ * @param transport The TMR_SR_SerialTransport structure to initialize.
+ * @param context Unused.
+ * @param device The capture file, optionally followed by "?fast"
+ */
+TMR_Status
+TMR_SR_SerialTransportReplayInit(TMR_SR_SerialTransport *transport,
+                                 TMR_SR_SerialPortNativeContext *context,
+                                 const char *device)
+{
+  TMR_SR_CaptureContext *c;
+  const char *option;
+  TMR_Status ret;
+
+  c = malloc(sizeof(*c));
+  if (NULL == c)
+  {
+    return TMR_ERROR_OUT_OF_MEMORY;
+  }
+  memset(c, 0, sizeof(*c));
+  ret = splitDevice(device, c->filename, sizeof(c->filename), &option);
+  if ((TMR_SUCCESS != ret) || (('\0' != option[0]) && (0 != strcmp(option, "fast"))))
+  {
+    free(c);
+    return TMR_ERROR_INVALID;
+  }
+  c->fast = (0 == strcmp(option, "fast"));
+
+  transport->cookie = c;
+  transport->open = replay_open;
+  transport->sendBytes = replay_sendBytes;
+  transport->receiveBytes = replay_receiveBytes;
+  transport->setBaudRate = replay_setBaudRate;
+  transport->shutdown = replay_shutdown;
+  transport->flush = replay_flush;
+
+  return TMR_SUCCESS;
+}
+#endif
@@ -0,0 +1,1093 @@
+/**
+ *  @file serial_transport_sim_posix.c
+ *  @brief Mercury API - serial transport that emulates an M6e module
+ *  and its tag population, for POSIX
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include "tm_reader.h"
+#include "serial_reader_imp.h"
+#include "tmr_utils.h"
+#include "tmr_crc.h"
+
+#ifdef TMR_ENABLE_SERIAL_TRANSPORT_NATIVE
+
+/*
+ * The simulator answers the subset of the serial protocol that
+ * TMR_connect(), TMR_read() and TMR_startReading() use on an M6e
+ * (firmware 1.21.1.19: streaming and duty cycle, no multi-select),
+ * with one Gen2 antenna per port and a synthetic tag population.
+ * Commands it does not know get an empty success response.
+ */
+#define SIM_MAX_COMMAND        TMR_SR_MAX_PACKET_SIZE
+#define SIM_MAX_PAYLOAD        0xF8
+#define SIM_OUTPUT_SIZE        4096
+#define SIM_MAX_EPC_BYTES      62
+
+#define SIM_DEFAULT_TAGS       100
+#define SIM_DEFAULT_EPC_BYTES  12
+#define SIM_DEFAULT_RATE       1000
+#define SIM_DEFAULT_RSSI       (-60)
+#define SIM_DEFAULT_RSSI_DEV   6
+#define SIM_DEFAULT_ANTENNAS   4
+#define SIM_WIRE_IDLE_US       1000
+#define SIM_WAKE_US            50000
+#define SIM_MAX_DUE            16
+
+typedef struct TMR_SR_SimContext
+{
+  /**
+   * Held by every transport call except while it sleeps: a continuous
+   * read receives on the background thread while the caller's thread
+   * sends commands, the stop among them
+   */
+  pthread_mutex_t lock;
+  /** Tag population size */
+  uint32_t tags;
+  /** EPC length of every tag, bytes */
+  uint8_t epcBytes;
+  /** Tag reads per second while reading, 0 for as fast as asked */
+  uint32_t rate;
+  /** Mean and spread of the reported RSSI, dBm */
+  int32_t rssi;
+  uint32_t rssiDev;
+  /** Antenna ports, all detected */
+  uint8_t antennas;
+  /** Metadata to report instead of the requested flags, if not 0 */
+  uint16_t metadataOverride;
+  /** Delay before each command response, microseconds */
+  uint32_t latencyUs;
+  /**
+   * Command responses not yet fully received, oldest first: where
+   * each ends in output, and when its delay is over
+   */
+  struct
+  {
+    uint32_t end;
+    uint64_t us;
+  } due[SIM_MAX_DUE];
+  uint32_t dueCount;
+  /** Pace responses at the baud rate the host sets, 10 bits per byte */
+  bool wire;
+  uint32_t wireBaud;
+  /** When the last byte handed out finished on the wire */
+  uint64_t wireUs;
+  /** Rate the module listens at, 0 for any */
+  uint32_t moduleBaud;
+  /** Idle time after which the module sleeps, microseconds, 0 never */
+  uint32_t sleepUs;
+  /** When the last byte the host sent finished arriving at the module */
+  uint64_t activeUs;
+  /** Bytes still to be lost while waking up */
+  uint32_t wakeBytes;
+  /** Random number state */
+  uint32_t seed;
+
+  /** Bytes of the command being assembled */
+  uint8_t command[SIM_MAX_COMMAND + 5];
+  uint32_t commandLen;
+
+  /** Response bytes not yet received, available from readyUs on */
+  uint8_t output[SIM_OUTPUT_SIZE];
+  uint32_t outputPos;
+  uint32_t outputLen;
+  uint64_t readyUs;
+
+  /** Tag reads left in the tag buffer after a timed read */
+  uint32_t bufferTags;
+  uint32_t bufferNext;
+  uint16_t bufferMetadata;
+
+  /** Streaming state */
+  bool streaming;
+  uint16_t streamMetadata;
+  uint16_t streamSearchFlags;
+  uint64_t streamStartUs;
+  uint64_t streamReads;
+
+  /** Start of the last search, which timestamp metadata counts from */
+  uint64_t searchStartUs;
+} TMR_SR_SimContext;
+
+static uint64_t
+nowUs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void
+sleepUntilUs(uint64_t when)
+{
+  struct timespec ts;
+  uint64_t now, us;
+
+  now = nowUs();
+  if (when <= now)
+  {
+    return;
+  }
+  us = when - now;
+  ts.tv_sec = (time_t)(us / 1000000);
+  ts.tv_nsec = (long)(us % 1000000) * 1000;
+  while ((0 != nanosleep(&ts, &ts)) && (EINTR == errno))
+  {
+  }
+}
+
+/**
+ * Sleep with the context unlocked, so that commands can come in
+ * meanwhile. Anything read from it before may have changed after.
+ */
+static void
+simSleepUntilUs(TMR_SR_SimContext *c, uint64_t when)
+{
+  pthread_mutex_unlock(&c->lock);
+  sleepUntilUs(when);
+  pthread_mutex_lock(&c->lock);
+}
+
+/**
+ * Let the rest of the receive timeout pass and give up, unlocked
+ */
+static TMR_Status
+simTimeout(TMR_SR_SimContext *c, uint64_t deadline)
+{
+  pthread_mutex_unlock(&c->lock);
+  sleepUntilUs(deadline);
+  return TMR_ERROR_TIMEOUT;
+}
+
+static uint32_t
+simRandom(TMR_SR_SimContext *c)
+{
+  /* xorshift32: cheap and deterministic for a given seed */
+  c->seed ^= c->seed << 13;
+  c->seed ^= c->seed >> 17;
+  c->seed ^= c->seed << 5;
+  return c->seed;
+}
+
+static int8_t
+simRssi(TMR_SR_SimContext *c)
+{
+  int32_t sum, value;
+  int i;
+
+  /* Sum of four uniform draws: close enough to normal, no libm */
+  sum = 0;
+  for (i = 0; i < 4; i++)
+  {
+    sum += (int32_t)(simRandom(c) % 2001) - 1000;
+  }
+  value = c->rssi + (sum * (int32_t)c->rssiDev) / 1155;
+  if (value < -127)
+  {
+    value = -127;
+  }
+  if (value > -1)
+  {
+    value = -1;
+  }
+  return (int8_t)value;
+}
+
+/**
+ * Append a response frame: FF LEN OP STATUS payload CRC
+ */
+static void
+simRespond(TMR_SR_SimContext *c, uint8_t opcode, uint16_t status,
+           const uint8_t *payload, uint8_t length)
+{
+  uint8_t *out;
+  uint16_t crc;
+  uint32_t i;
+
+  if (c->outputPos == c->outputLen)
+  {
+    c->outputPos = c->outputLen = 0;
+  }
+  if (c->outputLen + length + 7 > SIM_OUTPUT_SIZE)
+  {
+    memmove(c->output, c->output + c->outputPos, c->outputLen - c->outputPos);
+    c->outputLen -= c->outputPos;
+    for (i = 0; i < c->dueCount; i++)
+    {
+      c->due[i].end -= c->outputPos;
+    }
+    c->outputPos = 0;
+    if (c->outputLen + length + 7 > SIM_OUTPUT_SIZE)
+    {
+      return;
+    }
+  }
+  out = c->output + c->outputLen;
+  out[0] = 0xFF;
+  out[1] = length;
+  out[2] = opcode;
+  out[3] = (uint8_t)(status >> 8);
+  out[4] = (uint8_t)status;
+  memcpy(out + 5, payload, length);
+  crc = tm_crc(out + 1, length + 4);
+  out[length + 5] = (uint8_t)(crc >> 8);
+  out[length + 6] = (uint8_t)crc;
+  c->outputLen += length + 7;
+}
+
+/**
+ * Fill in one tag read: the requested metadata, then the EPC memory
+ * as the module reports it (bit length, PC, EPC, CRC).
+ */
+static uint8_t
+simTagRead(TMR_SR_SimContext *c, uint32_t tag, uint16_t flags, uint8_t *p)
+{
+  uint8_t i, epcLen, antenna;
+  uint32_t frequency, ms;
+  uint16_t crc;
+
+  i = 0;
+  antenna = (uint8_t)(1 + tag % c->antennas);
+  if (flags & TMR_TRD_METADATA_FLAG_READCOUNT)
+  {
+    SETU8(p, i, 1);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_RSSI)
+  {
+    SETU8(p, i, (uint8_t)simRssi(c));
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_ANTENNAID)
+  {
+    SETU8(p, i, (uint8_t)((antenna << 4) | antenna));
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_FREQUENCY)
+  {
+    frequency = 902750 + 500 * (simRandom(c) % 50);
+    SETU8(p, i, (uint8_t)(frequency >> 16));
+    SETU16(p, i, (uint16_t)frequency);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_TIMESTAMP)
+  {
+    ms = (uint32_t)((nowUs() - c->searchStartUs) / 1000);
+    SETU32(p, i, ms);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_PHASE)
+  {
+    SETU16(p, i, (uint16_t)(simRandom(c) % 180));
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_PROTOCOL)
+  {
+    SETU8(p, i, TMR_TAG_PROTOCOL_GEN2);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_DATA)
+  {
+    SETU16(p, i, 0);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_GPIO_STATUS)
+  {
+    SETU8(p, i, 0);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_GEN2_Q)
+  {
+    SETU8(p, i, 4);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_GEN2_LF)
+  {
+    SETU8(p, i, 0x02);
+  }
+  if (flags & TMR_TRD_METADATA_FLAG_GEN2_TARGET)
+  {
+    SETU8(p, i, 0);
+  }
+
+  epcLen = c->epcBytes;
+  if (flags & TMR_TRD_METADATA_FLAG_BRAND_IDENTIFIER)
+  {
+    epcLen += 2;
+  }
+  SETU16(p, i, (uint16_t)((epcLen + 4) * 8));
+  SETU16(p, i, (uint16_t)((c->epcBytes / 2) << 11));
+  /* EPC: E2 00, then the tag number, zero padded */
+  memset(p + i, 0, epcLen);
+  p[i] = 0xE2;
+  p[i + c->epcBytes - 4] = (uint8_t)(tag >> 24);
+  p[i + c->epcBytes - 3] = (uint8_t)(tag >> 16);
+  p[i + c->epcBytes - 2] = (uint8_t)(tag >> 8);
+  p[i + c->epcBytes - 1] = (uint8_t)tag;
+  crc = tm_crc(p + i, c->epcBytes);
+  i += epcLen;
+  SETU16(p, i, crc);
+
+  return i;
+}
+
+/** Bytes one tag read takes in a response with these metadata flags */
+static uint8_t
+simTagReadLength(TMR_SR_SimContext *c, uint16_t flags)
+{
+  uint8_t scratch[SIM_MAX_PAYLOAD];
+  uint32_t seed = c->seed;
+  uint8_t len;
+
+  len = simTagRead(c, 0, flags, scratch);
+  c->seed = seed;
+  return len;
+}
+
+/**
+ * Queue the next streamed read, FF LEN 22 STATUS 10 SEARCHFLAGS
+ * METADATAFLAGS 01 <tag read>
+ */
+static void
+simStreamTag(TMR_SR_SimContext *c)
+{
+  uint8_t payload[SIM_MAX_PAYLOAD];
+  uint8_t i;
+
+  i = 0;
+  SETU8(payload, i, 0x10);
+  SETU16(payload, i, c->streamSearchFlags);
+  SETU16(payload, i, c->streamMetadata);
+  SETU8(payload, i, 0x01);
+  i += simTagRead(c, simRandom(c) % c->tags, c->streamMetadata, payload + i);
+  simRespond(c, TMR_SR_OPCODE_READ_TAG_ID_MULTIPLE, 0, payload, i);
+  c->streamReads++;
+}
+
+/**
+ * Metadata flags of a streaming 0x22 subcommand:
+ * 22 [singulation option] option searchflags(2) timeout(2)
+ * [offtime(2)] metadata(2)
+ */
+static uint16_t
+simSubcommandMetadata(const uint8_t *sub, uint8_t len, uint16_t *searchFlags)
+{
+  uint8_t i;
+
+  i = 1;
+  if ((i < len) && (0x80 & sub[i]))
+  {
+    i++;
+  }
+  i++;
+  if (i + 6 > len)
+  {
+    return TMR_TRD_METADATA_FLAG_NONE;
+  }
+  *searchFlags = GETU16AT(sub, i);
+  i += 4;
+  if (*searchFlags & TMR_SR_SEARCH_FLAG_DUTY_CYCLE_CONTROL)
+  {
+    i += 2;
+  }
+  return (i + 2 <= len) ? GETU16AT(sub, i) : TMR_TRD_METADATA_FLAG_NONE;
+}
+
+/**
+ * Run a timed read into the tag buffer, which like the module's keeps
+ * one entry per tag until cleared. Returns the number of new tags.
+ */
+static uint32_t
+simTimedRead(TMR_SR_SimContext *c, uint16_t timeoutMs)
+{
+  uint64_t reads;
+  uint32_t seen, found;
+
+  reads = (0 == c->rate) ? c->tags : (uint64_t)c->rate * timeoutMs / 1000;
+  seen = (reads < c->tags) ? (uint32_t)reads : c->tags;
+  found = (seen > c->bufferTags) ? seen - c->bufferTags : 0;
+  c->bufferTags += found;
+  c->searchStartUs = nowUs();
+  c->readyUs = c->searchStartUs + (uint64_t)timeoutMs * 1000;
+
+  return found;
+}
+
+static void simCommand(TMR_SR_SimContext *c, uint8_t opcode,
+                       const uint8_t *data, uint8_t length);
+
+static void
+simMultiProtocolOp(TMR_SR_SimContext *c, const uint8_t *data, uint8_t length)
+{
+  uint8_t payload[SIM_MAX_PAYLOAD];
+  uint8_t i, option;
+  uint16_t timeout;
+  uint32_t found;
+
+  if (length < 3)
+  {
+    simRespond(c, TMR_SR_OPCODE_MULTI_PROTOCOL_TAG_OP, 0x105, NULL, 0);
+    return;
+  }
+  timeout = GETU16AT(data, 0);
+  option = data[2];
+  i = 0;
+  switch (option)
+  {
+  case 0x01:
+    /* Start streaming: 01 22 searchflags(2) then per protocol
+     * protocol plen <22 subcommand> */
+    c->streamSearchFlags = 0;
+    c->streamMetadata = (length > 8)
+      ? simSubcommandMetadata(data + 8, (uint8_t)(length - 8), &c->streamSearchFlags)
+      : TMR_TRD_METADATA_FLAG_NONE;
+    if (0 != c->metadataOverride)
+    {
+      c->streamMetadata = c->metadataOverride;
+    }
+    c->streaming = true;
+    c->streamStartUs = nowUs();
+    c->searchStartUs = c->streamStartUs;
+    c->streamReads = 0;
+    SETU8(payload, i, 0x01);
+    simRespond(c, TMR_SR_OPCODE_MULTI_PROTOCOL_TAG_OP, 0, payload, i);
+    break;
+
+  case 0x02:
+    /* Stop streaming; everything read so far is already queued */
+    c->streaming = false;
+    SETU8(payload, i, 0x02);
+    simRespond(c, TMR_SR_OPCODE_MULTI_PROTOCOL_TAG_OP, 0, payload, i);
+    break;
+
+  case 0x04:
+    /* A command sent while streaming: 04 LEN OP data, answered as
+     * 2F STATUS 04 LEN OP STATUS data */
+    if ((length >= 5) && (length >= 5 + data[3]))
+    {
+      uint32_t start;
+      uint8_t inner;
+
+      start = c->outputLen;
+      simCommand(c, data[4], data + 5, data[3]);
+      if (c->outputLen - start >= 7)
+      {
+        inner = c->output[start + 1];
+        SETU8(payload, i, 0x04);
+        SETU8(payload, i, inner);
+        SETU8(payload, i, c->output[start + 2]);
+        memcpy(payload + i, c->output + start + 3, inner + 2);
+        i += inner + 2;
+        c->outputLen = start;
+        /* The wrapper's response takes over the inner one's delay */
+        if ((0 != c->dueCount) && (c->due[c->dueCount - 1].end > start))
+        {
+          c->dueCount--;
+        }
+        simRespond(c, TMR_SR_OPCODE_MULTI_PROTOCOL_TAG_OP, 0, payload, i);
+      }
+    }
+    break;
+
+  default:
+    /* Timed search: 11 metadata(2) 22 searchflags(2) ..., answered
+     * with 11 metadata(2) 22 count(4) after the search time */
+    c->bufferMetadata = (0 != c->metadataOverride) ? c->metadataOverride
+      : ((length >= 5) ? GETU16AT(data, 3) : TMR_TRD_METADATA_FLAG_NONE);
+    found = simTimedRead(c, timeout);
+    SETU8(payload, i, option);
+    SETU16(payload, i, c->bufferMetadata);
+    SETU8(payload, i, TMR_SR_OPCODE_READ_TAG_ID_MULTIPLE);
+    SETU32(payload, i, found);
+    simRespond(c, TMR_SR_OPCODE_MULTI_PROTOCOL_TAG_OP,
+               (0 == found) ? 0x400 : 0, payload, i);
+    break;
+  }
+}
+
+/**
+ * Handle one complete command and queue its response.
+ */
+static void
+simCommand(TMR_SR_SimContext *c, uint8_t opcode, const uint8_t *data, uint8_t length)
+{
+  uint8_t payload[SIM_MAX_PAYLOAD];
+  uint8_t i, j;
+  uint16_t status;
+
+  i = 0;
+  status = 0;
+  switch (opcode)
+  {
+  case TMR_SR_OPCODE_VERSION:
+  case TMR_SR_OPCODE_BOOT_FIRMWARE:
+    /* bootloader, hardware, firmware date, firmware version, protocols */
+    SETU32(payload, i, 0x13000000);
+    SETU32(payload, i, (uint32_t)TMR_SR_MODEL_M6E << 24);
+    SETU32(payload, i, 0x20150701);
+    SETU32(payload, i, 0x01210119);
+    SETU32(payload, i, 1 << (TMR_TAG_PROTOCOL_GEN2 - 1));
+    break;
+
+  case TMR_SR_OPCODE_GET_CURRENT_PROGRAM:
+    SETU8(payload, i, 0x02); /* application */
+    break;
+
+  case TMR_SR_OPCODE_GET_TAG_PROTOCOL:
+    SETU16(payload, i, TMR_TAG_PROTOCOL_GEN2);
+    break;
+
+  case TMR_SR_OPCODE_GET_AVAILABLE_PROTOCOLS:
+    SETU16(payload, i, TMR_TAG_PROTOCOL_GEN2);
+    break;
+
+  case TMR_SR_OPCODE_GET_REGION:
+  case TMR_SR_OPCODE_GET_AVAILABLE_REGIONS:
+    SETU8(payload, i, TMR_REGION_NA);
+    break;
+
+  case TMR_SR_OPCODE_GET_POWER_MODE:
+    SETU8(payload, i, (0 != c->sleepUs) ? TMR_SR_POWER_MODE_SLEEP : TMR_SR_POWER_MODE_FULL);
+    break;
+
+  case TMR_SR_OPCODE_GET_USER_MODE:
+    SETU8(payload, i, 0);
+    break;
+
+  case TMR_SR_OPCODE_GET_READ_TX_POWER:
+  case TMR_SR_OPCODE_GET_WRITE_TX_POWER:
+    /* option -> option power [max min], centi-dBm */
+    SETU8(payload, i, (length > 0) ? data[0] : 0);
+    SETU16(payload, i, 3000);
+    if ((length > 0) && (1 == data[0]))
+    {
+      SETU16(payload, i, 3150);
+      SETU16(payload, i, 500);
+    }
+    break;
+
+  case TMR_SR_OPCODE_GET_TEMPERATURE:
+    SETU8(payload, i, 30);
+    break;
+
+  case TMR_SR_OPCODE_GET_READER_OPTIONAL_PARAMS:
+    /* 01 key -> 01 key value */
+    if (length >= 2)
+    {
+      SETU8(payload, i, data[0]);
+      SETU8(payload, i, data[1]);
+      SETU32(payload, i, (TMR_SR_CONFIGURATION_SEND_CRC == data[1]) ? 0x01000000 : 0);
+    }
+    break;
+
+  case TMR_SR_OPCODE_GET_PROTOCOL_PARAM:
+    /* protocol key -> protocol key value */
+    for (j = 0; (j < length) && (j < 2); j++)
+    {
+      SETU8(payload, i, data[j]);
+    }
+    SETU32(payload, i, 0);
+    break;
+
+  case TMR_SR_OPCODE_GET_ANTENNA_PORT:
+    SETU8(payload, i, (length > 0) ? data[0] : 0);
+    for (j = 1; (length > 0) && (j <= c->antennas); j++)
+    {
+      switch (data[0])
+      {
+      case 4: /* port, read power, write power, settling time */
+        SETU8(payload, i, j);
+        SETU16(payload, i, 3000);
+        SETU16(payload, i, 3000);
+        SETU16(payload, i, 0);
+        break;
+      case 5: /* port, detected */
+        SETU8(payload, i, j);
+        SETU8(payload, i, 1);
+        break;
+      default:
+        break;
+      }
+    }
+    if ((0 == length) || (0 == data[0]) || (1 == data[0]))
+    {
+      /* tx, rx of the current antenna */
+      i = 0;
+      if (0 != length)
+      {
+        SETU8(payload, i, data[0]);
+      }
+      SETU8(payload, i, 1);
+      SETU8(payload, i, 1);
+    }
+    break;
+
+  case TMR_SR_OPCODE_SET_BAUD_RATE:
+    /* Answered at the old rate, listening at the new one after */
+    if ((0 != c->moduleBaud) && (length >= 4))
+    {
+      c->moduleBaud = GETU32AT(data, 0);
+    }
+    break;
+
+  case TMR_SR_OPCODE_CLEAR_TAG_ID_BUFFER:
+    c->bufferTags = c->bufferNext = 0;
+    break;
+
+  case TMR_SR_OPCODE_READ_TAG_ID_MULTIPLE:
+    /* [singulation option] option searchflags(2) timeout(2) ...
+     * -> option searchflags(2) count(4), after the search time */
+    j = ((length > 0) && (0x80 & data[0])) ? 1 : 0;
+    if (length >= j + 5)
+    {
+      uint32_t found;
+
+      found = simTimedRead(c, GETU16AT(data, j + 3));
+      SETU8(payload, i, data[j]);
+      SETU16(payload, i, GETU16AT(data, j + 1));
+      SETU32(payload, i, found);
+      status = (0 == found) ? 0x400 : 0;
+    }
+    break;
+
+  case TMR_SR_OPCODE_GET_TAG_ID_BUFFER:
+    /* metadata(2) readoptions -> metadata(2) readoptions count reads */
+    if (length >= 3)
+    {
+      uint16_t flags;
+      uint8_t count, readLen;
+
+      flags = (0 != c->metadataOverride) ? c->metadataOverride : GETU16AT(data, 0);
+      SETU16(payload, i, flags);
+      SETU8(payload, i, data[2]);
+      readLen = simTagReadLength(c, flags);
+      count = (uint8_t)((SIM_MAX_PAYLOAD - 4) / readLen);
+      if (count > c->bufferTags - c->bufferNext)
+      {
+        count = (uint8_t)(c->bufferTags - c->bufferNext);
+      }
+      SETU8(payload, i, count);
+      for (j = 0; j < count; j++)
+      {
+        i += simTagRead(c, c->bufferNext++ % c->tags, flags, payload + i);
+      }
+    }
+    break;
+
+  case TMR_SR_OPCODE_MULTI_PROTOCOL_TAG_OP:
+    simMultiProtocolOp(c, data, length);
+    return;
+
+  default:
+    /* Setters and anything else: plain success */
+    break;
+  }
+
+  simRespond(c, opcode, status, payload, i);
+
+  /*
+   * Each response is held back from its own command on, so that the
+   * delays of commands sent back to back overlap.
+   */
+  if ((0 != c->latencyUs) && (SIM_MAX_DUE != c->dueCount))
+  {
+    c->due[c->dueCount].end = c->outputLen;
+    c->due[c->dueCount].us = nowUs() + c->latencyUs;
+    c->dueCount++;
+  }
+}
+
+static TMR_Status
+sim_open(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_SimContext *c = this->cookie;
+
+  pthread_mutex_lock(&c->lock);
+  c->searchStartUs = c->activeUs = nowUs();
+  c->wakeBytes = 0;
+  c->commandLen = c->outputPos = c->outputLen = 0;
+  c->dueCount = 0;
+  c->streaming = false;
+  pthread_mutex_unlock(&c->lock);
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+sim_sendBytes(TMR_SR_SerialTransport *this, uint32_t length,
+              uint8_t* message, const uint32_t timeoutMs)
+{
+  TMR_SR_SimContext *c = this->cookie;
+  uint32_t used, frame;
+  uint64_t now;
+
+  /*
+   * A sleeping module wakes on the first byte, and loses whatever
+   * the line carries while it spins up again. However fast the host
+   * hands bytes over, they reach the module at the line rate, so they
+   * queue behind any still on the way and keep it awake until the
+   * last has arrived.
+   */
+  pthread_mutex_lock(&c->lock);
+  now = nowUs();
+  if (c->activeUs > now)
+  {
+    now = c->activeUs;
+  }
+  if ((0 != c->sleepUs) && !c->streaming && (now - c->activeUs >= c->sleepUs))
+  {
+    c->wakeBytes = (uint32_t)((uint64_t)c->wireBaud * SIM_WAKE_US / 10000000);
+    c->commandLen = 0;
+  }
+  c->activeUs = now + (uint64_t)length * 10000000 / c->wireBaud;
+  if ((0 != c->moduleBaud) && (c->wireBaud != c->moduleBaud))
+  {
+    /* Garbage at the module's rate */
+    c->commandLen = 0;
+    pthread_mutex_unlock(&c->lock);
+    return TMR_SUCCESS;
+  }
+  used = (length < c->wakeBytes) ? length : c->wakeBytes;
+  c->wakeBytes -= used;
+  message += used;
+  length -= used;
+
+  /*
+   * Assemble FF LEN OP data CRC frames from however the bytes come
+   * in, skipping wake-up preamble bytes and anything unframed.
+   */
+  while (length > 0)
+  {
+    used = length;
+    if (used > sizeof(c->command) - c->commandLen)
+    {
+      used = sizeof(c->command) - c->commandLen;
+    }
+    memcpy(c->command + c->commandLen, message, used);
+    c->commandLen += used;
+    message += used;
+    length -= used;
+
+    while (c->commandLen > 0)
+    {
+      if ((0xFF != c->command[0])
+          || ((c->commandLen > 1) && (0xFF == c->command[1])))
+      {
+        memmove(c->command, c->command + 1, --c->commandLen);
+        continue;
+      }
+      if (c->commandLen < 2)
+      {
+        break;
+      }
+      frame = c->command[1] + 5;
+      if (c->commandLen < frame)
+      {
+        break;
+      }
+      simCommand(c, c->command[2], c->command + 3, c->command[1]);
+      c->commandLen -= frame;
+      memmove(c->command, c->command + frame, c->commandLen);
+    }
+  }
+  pthread_mutex_unlock(&c->lock);
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+sim_receiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
+                 uint32_t* messageLength, uint8_t* message, const uint32_t timeoutMs)
+{
+  TMR_SR_SimContext *c = this->cookie;
+  uint64_t now, deadline, due;
+  uint32_t avail;
+
+  *messageLength = 0;
+  now = nowUs();
+  deadline = now + (uint64_t)timeoutMs * 1000;
+  pthread_mutex_lock(&c->lock);
+  /* After each wait, look again: a command may have come in */
+  while (*messageLength < length)
+  {
+    now = nowUs();
+    if (c->outputPos == c->outputLen)
+    {
+      if (!c->streaming)
+      {
+        return simTimeout(c, deadline);
+      }
+      due = (0 == c->rate) ? now
+        : c->streamStartUs + (c->streamReads * 1000000) / c->rate;
+      if (due > deadline)
+      {
+        return simTimeout(c, deadline);
+      }
+      if (due > now)
+      {
+        simSleepUntilUs(c, due);
+        continue;
+      }
+      /* Never after the stop response */
+      simStreamTag(c);
+    }
+    if (c->readyUs > now)
+    {
+      if (c->readyUs > deadline)
+      {
+        return simTimeout(c, deadline);
+      }
+      simSleepUntilUs(c, c->readyUs);
+      continue;
+    }
+    if ((0 != c->dueCount) && (c->due[0].us > now))
+    {
+      if (c->due[0].us > deadline)
+      {
+        return simTimeout(c, deadline);
+      }
+      simSleepUntilUs(c, c->due[0].us);
+      continue;
+    }
+
+    avail = c->outputLen - c->outputPos;
+    if (avail > length - *messageLength)
+    {
+      avail = length - *messageLength;
+    }
+    if ((0 != c->dueCount) && (avail > c->due[0].end - c->outputPos))
+    {
+      /* The next response may not be due yet */
+      avail = c->due[0].end - c->outputPos;
+    }
+    if (c->wire)
+    {
+      /* Back to back with the previous bytes unless the line has been
+       * idle; a late wake-up doesn't slow the line down. */
+      due = (now > c->wireUs + SIM_WIRE_IDLE_US) ? now : c->wireUs;
+      due += (uint64_t)avail * 10000000 / c->wireBaud;
+      if (due > deadline)
+      {
+        return simTimeout(c, deadline);
+      }
+      c->wireUs = due;
+      /* Other calls only append meanwhile, so these bytes stay next */
+      simSleepUntilUs(c, due);
+    }
+    memcpy(message + *messageLength, c->output + c->outputPos, avail);
+    *messageLength += avail;
+    c->outputPos += avail;
+    while ((0 != c->dueCount) && (c->outputPos >= c->due[0].end))
+    {
+      memmove(c->due, c->due + 1, --c->dueCount * sizeof(c->due[0]));
+    }
+  }
+  pthread_mutex_unlock(&c->lock);
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+sim_setBaudRate(TMR_SR_SerialTransport *this, uint32_t rate)
+{
+  TMR_SR_SimContext *c = this->cookie;
+
+  if (0 == rate)
+  {
+    return TMR_ERROR_INVALID;
+  }
+  pthread_mutex_lock(&c->lock);
+  c->wireBaud = rate;
+  pthread_mutex_unlock(&c->lock);
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+sim_flush(TMR_SR_SerialTransport *this)
+{
+  return TMR_SUCCESS;
+}
+
+static TMR_Status
+sim_shutdown(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_SimContext *c = this->cookie;
+
+  pthread_mutex_destroy(&c->lock);
+  free(this->cookie);
+  this->cookie = NULL;
+
+  return TMR_SUCCESS;
+}
+
+/**
+ * Apply one "name=value" setting from the device string.
+ */
+static TMR_Status
+simOption(TMR_SR_SimContext *c, const char *name, size_t nameLen, long value)
+{
+#define SIM_OPTION(s) ((strlen(s) == nameLen) && (0 == strncmp(name, s, nameLen)))
+  if (SIM_OPTION("tags") && (value > 0))
+  {
+    c->tags = (uint32_t)value;
+  }
+  else if (SIM_OPTION("epc") && (value >= 4) && (value <= SIM_MAX_EPC_BYTES) && (0 == value % 2))
+  {
+    c->epcBytes = (uint8_t)value;
+  }
+  else if (SIM_OPTION("rate") && (value >= 0))
+  {
+    c->rate = (uint32_t)value;
+  }
+  else if (SIM_OPTION("rssi") && (value >= -127) && (value < 0))
+  {
+    c->rssi = (int32_t)value;
+  }
+  else if (SIM_OPTION("rssidev") && (value >= 0) && (value <= 64))
+  {
+    c->rssiDev = (uint32_t)value;
+  }
+  else if (SIM_OPTION("antennas") && (value > 0) && (value <= 16))
+  {
+    c->antennas = (uint8_t)value;
+  }
+  else if (SIM_OPTION("metadata") && (value >= 0) && (value <= 0xFFFF))
+  {
+    c->metadataOverride = (uint16_t)value;
+  }
+  else if (SIM_OPTION("latency") && (value >= 0))
+  {
+    c->latencyUs = (uint32_t)value;
+  }
+  else if (SIM_OPTION("wire") && ((0 == value) || (1 == value)))
+  {
+    c->wire = (1 == value);
+  }
+  else if (SIM_OPTION("baud") && (value >= 0))
+  {
+    c->moduleBaud = (uint32_t)value;
+  }
+  else if (SIM_OPTION("sleep") && (value >= 0))
+  {
+    c->sleepUs = (uint32_t)value * 1000;
+  }
+  else if (SIM_OPTION("seed") && (value > 0))
+  {
+    c->seed = (uint32_t)value;
+  }
+  else
+  {
+    return TMR_ERROR_INVALID;
+  }
+  return TMR_SUCCESS;
+#undef SIM_OPTION
+}
+
+/**
+ * Initialize a TMR_SR_SerialTransport structure that emulates a
+ * module and a tag population instead of talking to hardware, to
+ * load-test the API without a reader.
+ *
+ * Register it with TMR_setSerialTransport("sim", ...); the reader URI
+ * then carries the settings, e.g. sim:///?tags=5000&rate=50000
+ *
+ *   tags      Tag population size (100)
+ *   epc       EPC length in bytes, even (12)
+ *   rate      Tag reads per second while reading, 0 for unlimited (1000)
+ *   rssi      Mean RSSI in dBm (-60)
+ *   rssidev   RSSI standard deviation in dB (6)
+ *   antennas  Number of antenna ports (4)
+ *   metadata  Metadata flags to report regardless of those asked for
+ *   latency   Delay before each command response in microseconds,
+ *             counted from its own command, so that the delays of
+ *             commands sent without waiting overlap (0)
+ *   wire      1 to deliver responses no faster than the baud rate the
+ *             host sets would carry them, 10 bits per byte (0)
+ *   baud      Rate the module listens at until a set baud rate command
+ *             changes it; commands sent at any other rate are lost.
+ *             0 listens at any rate (0)
+ *   sleep     Report sleep power mode, and sleep this many
+ *             milliseconds after the last byte from the host has
+ *             arrived at the line rate, losing the bytes of the first
+ *             50 ms after waking; 0 never sleeps (0)
+ *   seed      Random seed, for repeatable runs
+ *
+ * @param transport The TMR_SR_SerialTransport structure to initialize.
+ * @param context Unused.
+ * @param device The settings as "name=value" pairs after a '?'
+ */
+TMR_Status
+TMR_SR_SerialTransportSimInit(TMR_SR_SerialTransport *transport,
+                              TMR_SR_SerialPortNativeContext *context,
+                              const char *device)
+{
+  TMR_SR_SimContext *c;
+  const char *p, *eq, *end;
+  char *stop;
+  long value;
+
+  c = malloc(sizeof(*c));
+  if (NULL == c)
+  {
+    return TMR_ERROR_OUT_OF_MEMORY;
+  }
+  memset(c, 0, sizeof(*c));
+  c->tags = SIM_DEFAULT_TAGS;
+  c->epcBytes = SIM_DEFAULT_EPC_BYTES;
+  c->rate = SIM_DEFAULT_RATE;
+  c->rssi = SIM_DEFAULT_RSSI;
+  c->rssiDev = SIM_DEFAULT_RSSI_DEV;
+  c->antennas = SIM_DEFAULT_ANTENNAS;
+  c->wireBaud = 115200;
+  c->seed = 0x2545F491;
+
+  p = strchr(device, '?');
+  while ((NULL != p) && ('\0' != *++p))
+  {
+    end = strchr(p, '&');
+    if (NULL == end)
+    {
+      end = p + strlen(p);
+    }
+    eq = memchr(p, '=', (size_t)(end - p));
+    if (NULL == eq)
+    {
+      free(c);
+      return TMR_ERROR_INVALID;
+    }
+    value = strtol(eq + 1, &stop, 0);
+    if ((stop != end) || (TMR_SUCCESS != simOption(c, p, (size_t)(eq - p), value)))
+    {
+      free(c);
+      return TMR_ERROR_INVALID;
+    }
+    p = ('\0' == *end) ? NULL : end;
+  }
+  pthread_mutex_init(&c->lock, NULL);
+
+  transport->cookie = c;
+  transport->open = sim_open;
+  transport->sendBytes = sim_sendBytes;
+  transport->receiveBytes = sim_receiveBytes;
+  transport->setBaudRate = sim_setBaudRate;
+  transport->shutdown = sim_shutdown;
+  transport->flush = sim_flush;
+
+  return TMR_SUCCESS;
+}
+#endif
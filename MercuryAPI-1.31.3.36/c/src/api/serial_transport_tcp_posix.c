@@ -37,13 +37,157 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/ioctl.h>
+#include <sys/select.h>
+#include <fcntl.h>
 #include <stdlib.h>
 
 #include "tm_reader.h"
+#include "tmr_utils.h"
+#include "osdep.h"
+
+#ifndef MSG_NOSIGNAL
+/* No per-call flag on this platform; tcp_tune() sets SO_NOSIGPIPE */
+#define MSG_NOSIGNAL 0
+#endif
 
 #ifdef TMR_ENABLE_SERIAL_TRANSPORT_NATIVE
+#if TMR_SR_READAHEAD_SIZE > 0
+/* In serial_transport_posix.c */
+uint32_t tmr_posix_takeReadAhead(TMR_SR_SerialPortNativeContext *c, uint32_t length,
+                                 uint8_t *message);
+void tmr_posix_discardReadAhead(TMR_SR_SerialPortNativeContext *c);
+#endif
+
+/**
+ * Best-effort socket tuning; a setting the platform lacks or refuses
+ * costs nothing but the tuning.
+ */
+static void
+tcp_tune(int sock)
+{
+  int flag;
+
+  flag = 1;
+  setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (void*)&flag, sizeof flag);
+#ifdef SO_NOSIGPIPE
+  setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, (void*)&flag, sizeof flag);
+#endif
+#if TMR_SR_TCP_RCVBUF > 0
+  /* Before connecting, so that the window scale can cover it */
+  flag = TMR_SR_TCP_RCVBUF;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (void*)&flag, sizeof flag);
+#endif
+#if TMR_SR_TCP_KEEPALIVE_IDLE_S > 0
+  flag = 1;
+  setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (void*)&flag, sizeof flag);
+#if defined(TCP_KEEPIDLE)
+  flag = TMR_SR_TCP_KEEPALIVE_IDLE_S;
+  setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, (void*)&flag, sizeof flag);
+#elif defined(TCP_KEEPALIVE)
+  flag = TMR_SR_TCP_KEEPALIVE_IDLE_S;
+  setsockopt(sock, IPPROTO_TCP, TCP_KEEPALIVE, (void*)&flag, sizeof flag);
+#endif
+#ifdef TCP_KEEPINTVL
+  flag = TMR_SR_TCP_KEEPALIVE_INTERVAL_S;
+  setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, (void*)&flag, sizeof flag);
+#endif
+#ifdef TCP_KEEPCNT
+  flag = TMR_SR_TCP_KEEPALIVE_COUNT;
+  setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, (void*)&flag, sizeof flag);
+#endif
+#endif
+#if defined(TCP_USER_TIMEOUT) && (TMR_SR_TCP_USER_TIMEOUT_MS > 0)
+  flag = TMR_SR_TCP_USER_TIMEOUT_MS;
+  setsockopt(sock, IPPROTO_TCP, TCP_USER_TIMEOUT, (void*)&flag, sizeof flag);
+#endif
+}
+
+/**
+ * Connect a new socket to sin, giving up after timeoutMs.
+ *
+ * @return the socket, or -1 with errno set (ETIMEDOUT at the deadline)
+ */
+static int
+tcp_connect(const struct sockaddr_in *sin, uint32_t timeoutMs)
+{
+  int sock, flags, err, rc;
+  socklen_t len;
+  struct timeval tv;
+  fd_set set;
+  uint64_t deadlineUs;
+  uint32_t remainingMs;
+
+  deadlineUs = tm_deadline_us(timeoutMs);
+  sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (0 > sock)
+  {
+    return -1;
+  }
+  tcp_tune(sock);
+
+  /* Connect without blocking, and wait for it only until the deadline */
+  flags = fcntl(sock, F_GETFL, 0);
+  if ((-1 == flags) || (-1 == fcntl(sock, F_SETFL, flags | O_NONBLOCK)))
+  {
+    goto fail;
+  }
+  rc = connect(sock, (const struct sockaddr *)sin, sizeof *sin);
+  if ((0 > rc) && (EINPROGRESS != errno))
+  {
+    goto fail;
+  }
+  while (0 > rc)
+  {
+    FD_ZERO(&set);
+    FD_SET(sock, &set);
+    remainingMs = tm_remaining_ms(deadlineUs);
+    tv.tv_sec = remainingMs / 1000;
+    tv.tv_usec = (remainingMs % 1000) * 1000;
+    rc = select(sock + 1, NULL, &set, NULL, &tv);
+    if ((0 > rc) && (EINTR == errno))
+    {
+      continue;
+    }
+    if (0 == rc)
+    {
+      errno = ETIMEDOUT;
+      goto fail;
+    }
+    if (0 > rc)
+    {
+      goto fail;
+    }
+    len = sizeof err;
+    if (0 != getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len))
+    {
+      goto fail;
+    }
+    if (0 != err)
+    {
+      errno = err;
+      goto fail;
+    }
+  }
+
+  /* The rest of the transport waits with select() itself */
+  if (-1 == fcntl(sock, F_SETFL, flags))
+  {
+    goto fail;
+  }
+  return sock;
+
+fail:
+  err = errno;
+  close(sock);
+  errno = err;
+  return -1;
+}
+
+/**
+ * Connect to the host and port of the URI, giving up after timeoutMs.
+ */
 static TMR_Status
-tcp_open(TMR_SR_SerialTransport *this)
+tcp_openWithin(TMR_SR_SerialTransport *this, uint32_t timeoutMs)
 {
   int sock;
   const char *port;
@@ -54,6 +198,10 @@ tcp_open(TMR_SR_SerialTransport *this)
 
   c = this->cookie;
   port = strchr(c->devicename, ':');
+  if (NULL == port)
+  {
+    return TMR_ERROR_INVALID;
+  }
   strcpy(hostCopy, c->devicename + 1);
   portNum = atoi(port + 1);
   hostCopy[port - c->devicename -1 ] = '\0';
@@ -70,86 +218,168 @@ tcp_open(TMR_SR_SerialTransport *this)
     NULL 
   };   
   struct addrinfo *           hostAddress;
-  int                         flag;
   struct sockaddr_in          sin; 
-  int                         rc;
-
-  /*
-   * Look up host using getaddrinfo().
-   * Gethostbyname() could be configured a lot of
-   * different ways. There is /etc/hosts, DNS, NIS, etc, etc.
-   * Suffice to say it is big, bulky, and susceptible to stall.
-   */
-  if(0 != getaddrinfo(hostCopy, NULL, &addrInfoMask, &hostAddress))
-  {
-    return TMR_ERROR_INVALID;
-  }
 
   /*
    * Convert the address to sockaddr_in format
    */
   memset(&sin, 0, sizeof sin);
   sin.sin_family = AF_INET;
-  sin.sin_addr = ((struct sockaddr_in *)(hostAddress->ai_addr))->sin_addr;
   sin.sin_port = htons(portNum);
 
   /*
-   * Done withe the host addrinfo
-   */
-  freeaddrinfo(hostAddress);
-
-  /*
-   * Create the socket.
+   * A dotted address needs no lookup.  Otherwise look up host using
+   * getaddrinfo().
+   * Gethostbyname() could be configured a lot of
+   * different ways. There is /etc/hosts, DNS, NIS, etc, etc.
+   * Suffice to say it is big, bulky, and susceptible to stall.
+   * getaddrinfo() is bounded only by the resolver's own timeouts.
    */
-  sock = socket(AF_INET, SOCK_STREAM, 0);
-  if(0 > sock)
+  if (1 != inet_pton(AF_INET, hostCopy, &sin.sin_addr))
   {
-    return TMR_ERROR_INVALID;
+    if(0 != getaddrinfo(hostCopy, NULL, &addrInfoMask, &hostAddress))
+    {
+      return TMR_ERROR_INVALID;
+    }
+    sin.sin_addr = ((struct sockaddr_in *)(hostAddress->ai_addr))->sin_addr;
+
+    /*
+     * Done withe the host addrinfo
+     */
+    freeaddrinfo(hostAddress);
   }
 
   /*
-   * Connect the socket to reader. This can stall.
+   * Connect the socket to reader, within the timeout.
    */
-  rc = connect(sock, (struct sockaddr *)&sin, sizeof sin);
-  if(0 > rc)
+  sock = tcp_connect(&sin, timeoutMs);
+  if (0 > sock)
   {
     /* Connect failed */
-    close(sock);
-    return TMR_ERROR_INVALID;
+    return (ETIMEDOUT == errno) ? TMR_ERROR_TIMEOUT : TMR_ERROR_INVALID;
   }
 
-  /*
-   * Best effort to set no delay. If this doesn't work
-   * (no reason it shouldn't) we do not declare defeat.
-   */
-  flag = 1;
-  setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (void*)&flag, sizeof flag);
-
   /*
    * Record the socket in the connection instance
    */
   c->handle = sock;
+#if TMR_SR_READAHEAD_SIZE > 0
+  tmr_posix_discardReadAhead(c);
+#endif
 
   ret = TMR_SUCCESS;
  
   return ret;
 }
 
+static TMR_Status
+tcp_open(TMR_SR_SerialTransport *this)
+{
+  TMR_SR_SerialPortNativeContext *c;
+
+  c = this->cookie;
+  return tcp_openWithin(this, c->connectTimeoutMs);
+}
+
+/**
+ * Close a connection found lost, and replace it if the URI asked for
+ * that. Attempts are at least TMR_SR_TCP_RECONNECT_MS apart, so that a
+ * reader that is gone isn't hammered with connects and callers
+ * retrying in a loop don't spin. Neither that wait nor the connect
+ * goes past deadlineUs, the end of the caller's timeout: an attempt
+ * that doesn't fit is left to a later call.
+ *
+ * @return TMR_SUCCESS if there is a new connection
+ */
+static TMR_Status
+tcp_reconnect(TMR_SR_SerialTransport *this, uint64_t deadlineUs)
+{
+  TMR_SR_SerialPortNativeContext *c;
+  uint64_t now;
+  uint32_t timeoutMs;
+
+  c = this->cookie;
+  if (0 <= c->handle)
+  {
+    close(c->handle);
+    c->handle = -1;
+  }
+  if (false == c->reconnect)
+  {
+    return TMR_ERROR_INVALID;
+  }
+  now = tmr_gettime_us();
+  if (now < c->reconnectUs)
+  {
+    if (c->reconnectUs >= deadlineUs)
+    {
+      return TMR_ERROR_TIMEOUT;
+    }
+    tmr_sleep((uint32_t)((c->reconnectUs - now + 999) / 1000));
+    now = tmr_gettime_us();
+  }
+  timeoutMs = tm_remaining_ms(deadlineUs);
+  if (0 == timeoutMs)
+  {
+    return TMR_ERROR_TIMEOUT;
+  }
+  if (timeoutMs > c->connectTimeoutMs)
+  {
+    timeoutMs = c->connectTimeoutMs;
+  }
+  c->reconnectUs = now + (uint64_t)TMR_SR_TCP_RECONNECT_MS * 1000;
+
+  return tcp_openWithin(this, timeoutMs);
+}
 
 static TMR_Status
 tcp_sendBytes(TMR_SR_SerialTransport *this, uint32_t length, 
                 uint8_t* message, const uint32_t timeoutMs)
 {
   TMR_SR_SerialPortNativeContext *c;
-  int ret;
+  int ret, err;
+  uint8_t *start;
+  uint32_t total;
+  uint64_t deadlineUs;
+  bool reconnected;
 
   c = this->cookie;
+  start = message;
+  total = length;
+  deadlineUs = tm_deadline_us(timeoutMs);
+  reconnected = false;
+  if (0 > c->handle)
+  {
+    if (TMR_SUCCESS != tcp_reconnect(this, deadlineUs))
+    {
+      return TMR_ERROR_COMM_ERRNO(ENOTCONN);
+    }
+    reconnected = true;
+  }
   do 
   {
-    ret = write(c->handle, message, length);
+    /* A peer that went away is an error here, not a SIGPIPE */
+    ret = send(c->handle, message, length, MSG_NOSIGNAL);
     if (ret == -1)
     {
-      return TMR_ERROR_COMM_ERRNO(errno);
+      if (EINTR == errno)
+      {
+        continue;
+      }
+      /*
+       * Part of a message may have gone out on the old connection;
+       * the reader on the other end drops it, so send it whole again.
+       * A new connection that fails too is not replaced in this call.
+       */
+      err = errno;
+      if (reconnected || (TMR_SUCCESS != tcp_reconnect(this, deadlineUs)))
+      {
+        return TMR_ERROR_COMM_ERRNO(err);
+      }
+      reconnected = true;
+      message = start;
+      length = total;
+      continue;
     }
     length -= ret;
     message += ret;
@@ -169,55 +399,90 @@ tcp_receiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
   struct timeval tv;
   fd_set set;
   int status = 0;
+  uint8_t *dest;
+  uint32_t destLen, remainingMs;
+  uint64_t deadlineUs;
 
   *messageLength = 0;
   c = this->cookie;
+  /* One deadline for all of length, not timeoutMs per select() */
+  deadlineUs = tm_deadline_us(timeoutMs);
+  if ((0 > c->handle) && (TMR_SUCCESS != tcp_reconnect(this, deadlineUs)))
+  {
+    return TMR_ERROR_COMM_ERRNO(ENOTCONN);
+  }
 
-  do
+#if TMR_SR_READAHEAD_SIZE > 0
+  ret = tmr_posix_takeReadAhead(c, length, message);
+  length -= ret;
+  *messageLength += ret;
+  message += ret;
+#endif
+
+  while (length > 0)
   {
     FD_ZERO(&set);
     FD_SET(c->handle, &set);
-    tv.tv_sec = timeoutMs/1000;
-    tv.tv_usec = (timeoutMs % 1000) * 1000;
-    /* Ideally should reset this timeout value every time through */
+    remainingMs = tm_remaining_ms(deadlineUs);
+    tv.tv_sec = remainingMs / 1000;
+    tv.tv_usec = (remainingMs % 1000) * 1000;
     ret = select(c->handle + 1, &set, NULL, NULL, &tv);
     if (ret < 1)
     {
       return TMR_ERROR_TIMEOUT;
     }
-    ret = read(c->handle, message, length);
-    if (ret == -1)
+
+    /*
+     * Small requests read everything the socket has pending into the
+     * read-ahead buffer; large ones go straight to the caller.
+     */
+    dest = message;
+    destLen = length;
+#if TMR_SR_READAHEAD_SIZE > 0
+    if (length < sizeof(c->rxBuf))
     {
-      return TMR_ERROR_COMM_ERRNO(errno);
+      dest = c->rxBuf;
+      destLen = sizeof(c->rxBuf);
     }
-
-    if (0 == ret)
+#endif
+    ret = read(c->handle, dest, destLen);
+    if ((ret == -1) && (EINTR == errno))
+    {
+      continue;
+    }
+    if (ret < 1)
     {
       /**
-       * We should not be here, coming here means the select()
-       * is success , but we are not able to read the data.
-       * check the serial port connection status.
+       * Readable with nothing to read is end of file: the reader
+       * closed the connection, or keepalive or TCP_USER_TIMEOUT gave
+       * up on it. Waiting on it again would return at once, forever,
+       * so close it and report the loss as a communication error.
+       *
+       * With reconnect on, set up a new connection within what is
+       * left of timeoutMs, so that continuous reading carries on over
+       * it: the next command is sent there, and a reader that kept
+       * streaming keeps streaming there too. What was in flight is
+       * lost. If the reader can't be reached in time, the next call
+       * tries again.
        **/
-      ret = ioctl(c->handle, TIOCMGET, &status);
-      if (-1 == ret)
-      {
-        /* not success. check for errno */
-        if (EIO == errno)
-        {
-          /**
-           * EIO means I/O error, may serial port got disconnected,
-           * throw the error.
-           **/
-          return TMR_ERROR_TIMEOUT;
-        }
-      }
+      status = (0 == ret) ? ECONNRESET : errno;
+      tcp_reconnect(this, deadlineUs);
+      return TMR_ERROR_COMM_ERRNO(status);
     }
 
+#if TMR_SR_READAHEAD_SIZE > 0
+    if (dest == c->rxBuf)
+    {
+      c->rxPos = 0;
+      c->rxLen = (uint16_t)ret;
+      ret = tmr_posix_takeReadAhead(c, length, message);
+    }
+#endif
+
     length -= ret;
     *messageLength += ret;
     message += ret;
   }
-  while (length > 0);
 
   return TMR_SUCCESS;
 }
@@ -282,11 +547,59 @@ TMR_SR_SerialTransportTcpNativeInit(TMR_SR_SerialTransport *transport,
                                  const char *device)
 {
 
+  const char *p, *end;
+  char *stop;
+  long value;
+
   if (strlen(device) + 1 > TMR_MAX_READER_NAME_LENGTH)
   {
     return TMR_ERROR_INVALID;
   }
   strcpy(context->devicename, device);
+  context->connectTimeoutMs = TMR_SR_TCP_CONNECT_TIMEOUT_MS;
+  context->reconnect = false;
+  context->reconnectUs = 0;
+
+  /* "timeout=<ms>" and "reconnect=<0|1>" settings after a '?' */
+  p = strchr(device, '?');
+  if (NULL != p)
+  {
+    context->devicename[p - device] = '\0';
+  }
+  while ((NULL != p) && ('\0' != *++p))
+  {
+    end = strchr(p, '&');
+    if (NULL == end)
+    {
+      end = p + strlen(p);
+    }
+    if (0 == strncmp(p, "timeout=", 8))
+    {
+      value = strtol(p + 8, &stop, 0);
+      if ((stop != end) || (value <= 0))
+      {
+        return TMR_ERROR_INVALID;
+      }
+      context->connectTimeoutMs = (uint32_t)value;
+    }
+    else if (0 == strncmp(p, "reconnect=", 10))
+    {
+      value = strtol(p + 10, &stop, 0);
+      if ((stop != end) || (value < 0) || (value > 1))
+      {
+        return TMR_ERROR_INVALID;
+      }
+      context->reconnect = (1 == value);
+    }
+    else
+    {
+      return TMR_ERROR_INVALID;
+    }
+    p = ('\0' == *end) ? NULL : end;
+  }
+#if TMR_SR_READAHEAD_SIZE > 0
+  tmr_posix_discardReadAhead(context);
+#endif
 
   transport->cookie = context;
   transport->open = tcp_open;
@@ -47,6 +47,7 @@
 #endif /* WIN32 */
 
 #include "tm_reader.h"
+#include "tmr_utils.h"
 
 __declspec(dllexport) TMR_Status
 tcp_open(TMR_SR_SerialTransport *this)
@@ -149,14 +150,27 @@ timeoutMs)
  TMR_Status ret = TMR_SUCCESS;
  TMR_SR_SerialPortNativeContext *c;
  DWORD dwTime = timeoutMs;
+ uint64_t deadlineUs;
 
  c = this->cookie;
  *messageLength = 0;
+ /* One deadline for all of length, not timeoutMs per recv() */
+ deadlineUs = tm_deadline_us(timeoutMs);
 
  setsockopt((SOCKET)c->handle, SOL_SOCKET, SO_RCVTIMEO, (const char*)&dwTime, sizeof(dwTime));
 
  while (length > 0)
  {
+   if (0 != *messageLength)
+   {
+     /* A zero SO_RCVTIMEO would wait forever */
+     dwTime = tm_remaining_ms(deadlineUs);
+     if (0 == dwTime)
+     {
+       return TMR_ERROR_TIMEOUT;
+     }
+     setsockopt((SOCKET)c->handle, SOL_SOCKET, SO_RCVTIMEO, (const char*)&dwTime, sizeof(dwTime));
+   }
    readLength=0;
    readLength = recv((SOCKET)c->handle, message, length, 0);   
    if (readLength > 0)
@@ -47,6 +47,7 @@
 #endif /* WIN32 */
 
 #include "tm_reader.h"
+#include "tmr_utils.h"
 
 __declspec(dllexport) TMR_Status
 s_open(TMR_SR_SerialTransport *this)
@@ -133,9 +134,12 @@ timeoutMs)
  TMR_SR_SerialPortNativeContext *c;
  BOOL    readStatus;
  COMMTIMEOUTS timeOuts;
+ uint64_t deadlineUs;
 
  c = this->cookie;
  *messageLength=0;
+ /* One deadline for all of length, not timeoutMs per ReadFile() */
+ deadlineUs = tm_deadline_us(timeoutMs);
 
  GetCommTimeouts(c->handle, &timeOuts);
  timeOuts.ReadTotalTimeoutConstant = timeoutMs;
@@ -144,6 +148,15 @@ timeoutMs)
  ClearCommError(c->handle, &errorFlags, &comStat);
  while (length > 0)
  {
+   if (0 != *messageLength)
+   {
+     timeOuts.ReadTotalTimeoutConstant = tm_remaining_ms(deadlineUs);
+     if (0 == timeOuts.ReadTotalTimeoutConstant)
+     {
+       return TMR_ERROR_TIMEOUT;
+     }
+     SetCommTimeouts(c->handle, &timeOuts);
+   }
    readLength=0;
    readStatus = ReadFile(c->handle, message, length, &readLength, NULL);
    *messageLength += readLength;
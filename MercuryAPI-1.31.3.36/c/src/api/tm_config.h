@@ -69,6 +69,13 @@ extern "C" {
  */
 #define TMR_MAX_QUEUE_SLOTS 20
 
+/**
+ * The smallest queue the TMR_ASYNC_QUEUE_POLICY_STOP policy runs with.
+ * That policy throttles the background reader while fewer than half the
+ * slots are free, so a shorter queue would overflow on the first burst.
+ */
+#define TMR_ASYNC_QUEUE_STOP_MIN_DEPTH 8
+
 /** 
  * Number of bytes to allocate for embedded data return
  * in each TagReadData.
@@ -81,6 +88,87 @@ extern "C" {
  */
 #define TMR_MAX_PROBE_BAUDRATE_LENGTH 8
 
+/**
+ * Size of the read-ahead buffer used by the native POSIX serial and
+ * TCP transports. Each read() pulls in as much as is available (up to
+ * this many bytes) and later receiveBytes calls are served from
+ * memory, so a streamed tag costs one select/read pair instead of two.
+ * The buffer only holds what would otherwise still be queued in the
+ * kernel: flush does not empty it, opening the connection again does.
+ * Define as 0 to read straight into the caller's buffer.
+ */
+#ifndef TMR_SR_READAHEAD_SIZE
+#define TMR_SR_READAHEAD_SIZE 256
+#endif
+
+/**
+ * Wake-up preamble for modules that can sleep between commands. If
+ * nothing has been heard from the module for TMR_SR_PREAMBLE_IDLE_MS,
+ * the line is held busy with 0xFF for TMR_SR_PREAMBLE_MS at the
+ * current baud rate before the next command; where the bytes leave
+ * faster than that (TCP, USB), the host waits out the rest. A command
+ * that was sent without the preamble and times out is sent once more
+ * with it, and the preamble is then sent before every command for
+ * TMR_SR_PREAMBLE_BACKOFF_MS. That period doubles, up to
+ * TMR_SR_PREAMBLE_BACKOFF_MAX_MS, each time skipping the preamble
+ * fails again, and starts over once it succeeds.
+ */
+#ifndef TMR_SR_PREAMBLE_IDLE_MS
+#define TMR_SR_PREAMBLE_IDLE_MS 50
+#endif
+#ifndef TMR_SR_PREAMBLE_MS
+#define TMR_SR_PREAMBLE_MS 100
+#endif
+#ifndef TMR_SR_PREAMBLE_BACKOFF_MS
+#define TMR_SR_PREAMBLE_BACKOFF_MS 1000
+#endif
+#ifndef TMR_SR_PREAMBLE_BACKOFF_MAX_MS
+#define TMR_SR_PREAMBLE_BACKOFF_MAX_MS 60000
+#endif
+
+/**
+ * Settings commands of a TMR_paramSetMany() batch a serial reader
+ * sends ahead before waiting for the oldest response. 1 sends them
+ * one at a time, as TMR_paramSet() does.
+ */
+#ifndef TMR_SR_PIPELINE_DEPTH
+#define TMR_SR_PIPELINE_DEPTH 4
+#endif
+
+/**
+ * TCP serial transport. A connect that has not completed within
+ * TMR_SR_TCP_CONNECT_TIMEOUT_MS fails with TMR_ERROR_TIMEOUT instead
+ * of waiting out the kernel's SYN retries. Keepalive probes start
+ * after the connection has been idle for TMR_SR_TCP_KEEPALIVE_IDLE_S,
+ * and data left unacknowledged for TMR_SR_TCP_USER_TIMEOUT_MS fails
+ * the connection, where the platform supports them; 0 leaves the
+ * system default. TMR_SR_TCP_RCVBUF is the socket receive buffer,
+ * which holds a module's stream while the host is busy; 0 leaves the
+ * system default. A lost connection that is set up again, if asked
+ * to, is tried at most every TMR_SR_TCP_RECONNECT_MS.
+ */
+#ifndef TMR_SR_TCP_CONNECT_TIMEOUT_MS
+#define TMR_SR_TCP_CONNECT_TIMEOUT_MS 5000
+#endif
+#ifndef TMR_SR_TCP_KEEPALIVE_IDLE_S
+#define TMR_SR_TCP_KEEPALIVE_IDLE_S 10
+#endif
+#ifndef TMR_SR_TCP_KEEPALIVE_INTERVAL_S
+#define TMR_SR_TCP_KEEPALIVE_INTERVAL_S 2
+#endif
+#ifndef TMR_SR_TCP_KEEPALIVE_COUNT
+#define TMR_SR_TCP_KEEPALIVE_COUNT 3
+#endif
+#ifndef TMR_SR_TCP_USER_TIMEOUT_MS
+#define TMR_SR_TCP_USER_TIMEOUT_MS 15000
+#endif
+#ifndef TMR_SR_TCP_RCVBUF
+#define TMR_SR_TCP_RCVBUF (256 * 1024)
+#endif
+#ifndef TMR_SR_TCP_RECONNECT_MS
+#define TMR_SR_TCP_RECONNECT_MS 1000
+#endif
+
 /* The minimum and maximum values of AsyncOn and AsyncOff time. */
 #define TMR_MAX_VALUE 65535u
 #define TMR_MIN_VALUE 0u
@@ -99,6 +187,25 @@ extern "C" {
  */
 #define TMR_LLRP_KEEP_ALIVE_TIMEOUT 5000
 
+/**
+ * Decode each message from an LLRP reader into an arena of its own,
+ * so that a tag report costs a couple of allocations rather than
+ * several per tag, and TMR_LLRP_freeMessage() releases it in one go.
+ * Define as 0 to allocate every parameter separately.
+ */
+#ifndef TMR_LLRP_DECODE_ARENA
+#define TMR_LLRP_DECODE_ARENA 1
+#endif
+
+/**
+ * Keep RO_ACCESS_REPORTs that hold nothing but tag reads as received
+ * and decode them straight into TMR_TagReadData, bypassing LTKC.
+ * Define as 0 to have LTKC decode every message.
+ */
+#ifndef TMR_LLRP_FAST_REPORT_DECODE
+#define TMR_LLRP_FAST_REPORT_DECODE 1
+#endif
+
 /**
  * Define this to enable async read using single thread
 
@@ -136,7 +136,6 @@ TMR_create(TMR_Reader *reader, const char* deviceUri)
   pthread_cond_init(&reader->parserCond, NULL);
   pthread_cond_init(&reader->readCond, NULL);
   pthread_mutex_init(&reader->listenerLock, NULL);
-  pthread_mutex_init(&reader->queue_lock, NULL);
   reader->authReqListeners = NULL;
   reader->readExceptionListeners = NULL;
   reader->statsListeners = NULL;
@@ -144,6 +143,13 @@ TMR_create(TMR_Reader *reader, const char* deviceUri)
   reader->readState = TMR_READ_STATE_IDLE;
   reader->backgroundSetup = false;
   reader->parserSetup = false;
+  reader->batchReadListeners = NULL;
+  reader->tagQueue = NULL;
+  reader->tagQueueBuffers = NULL;
+  reader->tagQueueHighWater = 0;
+  reader->tagQueueDropped = 0;
+  reader->tagQueueDiscardRequests = 0;
+  reader->tagQueueDiscards = 0;
 #endif
   reader->readListeners = NULL;
   reader->dutyCycle = false;
@@ -300,6 +306,10 @@ TMR_reader_init_internal(struct TMR_Reader *reader)
   reader->connected = false;
   reader->pSupportsResetStats = NULL;
   reader->transportListeners = NULL;
+  reader->transportTraceRaw = false;
+  memset(&reader->metricsIo, 0, sizeof(reader->metricsIo));
+  memset(&reader->metricsParser, 0, sizeof(reader->metricsParser));
+  reader->metricsEpoch = 0;
   reader->readParams.onTime = 0;
 
 
@@ -313,6 +323,9 @@ TMR_reader_init_internal(struct TMR_Reader *reader)
 #ifdef TMR_ENABLE_BACKGROUND_READS
   reader->readParams.asyncOnTime = 250;  
   reader->readParams.asyncOffTime = 0;
+  reader->asyncQueueDepth = TMR_MAX_QUEUE_SLOTS;
+  reader->asyncQueuePolicy = TMR_ASYNC_QUEUE_POLICY_STOP;
+  reader->isBufferOverFlow = false;
 #if 0
   pthread_mutex_init(&reader->backgroundLock, NULL);
   pthread_mutex_init(&reader->parserLock, NULL);
@@ -320,7 +333,6 @@ TMR_reader_init_internal(struct TMR_Reader *reader)
   pthread_cond_init(&reader->parserCond, NULL);
   pthread_cond_init(&reader->readCond, NULL);
   pthread_mutex_init(&reader->listenerLock, NULL);
-  pthread_mutex_init(&reader->queue_lock, NULL);
   reader->readListeners = NULL;
   reader->authReqListeners = NULL;
   reader->readExceptionListeners = NULL;
@@ -333,8 +345,6 @@ TMR_reader_init_internal(struct TMR_Reader *reader)
   reader->backgroundEnabled = false;
   reader->trueAsyncflag = false;
   reader->parserEnabled = false;
-  reader->tagQueueHead = NULL;
-  reader->tagQueueTail = NULL;
   reader->isStatusResponse = false;  
   reader->statsFlag = TMR_READER_STATS_FLAG_NONE;
   reader->streamStats = TMR_SR_STATUS_NONE;
@@ -410,56 +420,207 @@ TMR_setSerialTransport(char* scheme, TMR_TransportNativeInit nativeInit)
   }
   return TMR_SUCCESS;
 }
+/**
+ * TMR_TRD_init() points the data lists at the record's own storage, so
+ * a record that has been moved or copied must be pointed back at it.
+ */
+static void
+TMR_relinkTagData(TMR_TagReadData *read)
+{
+#if TMR_MAX_EMBEDDED_DATA_LENGTH
+  read->data.list = read->_dataList;
+  read->epcMemData.list = read->_epcMemDataList;
+  read->tidMemData.list = read->_tidMemDataList;
+  read->userMemData.list = read->_userMemDataList;
+  read->reservedMemData.list = read->_reservedMemDataList;
+#endif
+}
+
 #ifdef TMR_ENABLE_API_SIDE_DEDUPLICATION
 
-static int
-TMR_findDupTag(TMR_Reader *reader,
-               TMR_TagReadData* newRead,
-               TMR_TagReadData oldReads[], int32_t oldLength,
-               bool uniqueByAntenna, bool uniqueByData, bool uniqueByProtocol)
+/**
+ * Open-addressing index over the reads collected by TMR_readIntoArray(),
+ * keyed on the EPC plus whichever uniqueBy* fields are enabled. Each
+ * slot holds the key's hash and its position in the results array.
+ */
+typedef struct TMR_DupTable
+{
+  uint32_t *hash;
+  int32_t *index;
+  uint32_t mask;
+  int32_t used;
+  bool uniqueByAntenna;
+  bool uniqueByData;
+  bool uniqueByProtocol;
+} TMR_DupTable;
+
+#define TMR_DUP_TABLE_EMPTY (-1)
+#define TMR_DUP_TABLE_MIN_SIZE 64
+
+/* FNV-1a over the fields that make a read unique */
+static uint32_t
+TMR_hashDupKey(TMR_DupTable *table, const TMR_TagReadData *read)
 {
+  uint32_t h = 2166136261u;
   int i;
 
-  for (i=0; i<oldLength; i++)
+#define TMR_DUP_HASH_BYTE(b) h = (h ^ (uint8_t)(b)) * 16777619u
+  TMR_DUP_HASH_BYTE(read->tag.epcByteCount);
+  for (i = 0; i < read->tag.epcByteCount; i++)
+  {
+    TMR_DUP_HASH_BYTE(read->tag.epc[i]);
+  }
+  if (table->uniqueByAntenna)
+  {
+    TMR_DUP_HASH_BYTE(read->antenna);
+  }
+  if (table->uniqueByData)
   {
-    TMR_TagReadData* oldRead = &oldReads[i];
-    TMR_TagData* oldTag = &oldRead->tag;
-    TMR_TagData* newTag = &newRead->tag;
+    for (i = 0; i < read->data.len; i++)
+    {
+      TMR_DUP_HASH_BYTE(read->data.list[i]);
+    }
+  }
+  if (table->uniqueByProtocol)
+  {
+    TMR_DUP_HASH_BYTE(read->tag.protocol);
+  }
+#undef TMR_DUP_HASH_BYTE
+  return h;
+}
 
-    if ((oldTag->epcByteCount != newTag->epcByteCount) ||
-        (0 != memcmp(oldTag->epc, newTag->epc,
-                     (oldTag->epcByteCount)*sizeof(uint8_t))))
+static bool
+TMR_isDupTag(TMR_DupTable *table,
+             const TMR_TagReadData *oldRead, const TMR_TagReadData *newRead)
+{
+  if ((oldRead->tag.epcByteCount != newRead->tag.epcByteCount) ||
+      (0 != memcmp(oldRead->tag.epc, newRead->tag.epc,
+                   (oldRead->tag.epcByteCount)*sizeof(uint8_t))))
+  {
+    return false;
+  }
+  if (table->uniqueByAntenna)
+  {
+    if (oldRead->antenna != newRead->antenna)
     {
-      continue;
+      return false;
     }
-    if (uniqueByAntenna)
+  }
+  if (table->uniqueByData)
+  {
+    if ((oldRead->data.len != newRead->data.len) ||
+        (0 != memcmp(oldRead->data.list, newRead->data.list,
+                     (oldRead->data.len)*sizeof(uint8_t))))
     {
-      if (oldRead->antenna != newRead->antenna)
-      {
-        continue;
-      }
+      return false;
     }
-    if (uniqueByData)
+  }
+  if (table->uniqueByProtocol)
+  {
+    if (oldRead->tag.protocol != newRead->tag.protocol)
     {
-      if ((oldRead->data.len != newRead->data.len) ||
-          (0 != memcmp(oldRead->data.list, newRead->data.list,
-                       (oldRead->data.len)*sizeof(uint8_t))))
-      {
-        continue;
-      }
+      return false;
     }
-    if (uniqueByProtocol)
+  }
+  /* No fields mismatched; this tag is a match */
+  return true;
+}
+
+static TMR_Status
+TMR_resizeDupTable(TMR_DupTable *table, uint32_t size)
+{
+  uint32_t *oldHash, oldSize, i, j;
+  int32_t *oldIndex;
+
+  oldHash = table->hash;
+  oldIndex = table->index;
+  oldSize = (NULL == oldHash) ? 0 : table->mask + 1;
+
+  table->hash = malloc(size * sizeof(*table->hash));
+  table->index = malloc(size * sizeof(*table->index));
+  if ((NULL == table->hash) || (NULL == table->index))
+  {
+    free(table->hash);
+    free(table->index);
+    table->hash = oldHash;
+    table->index = oldIndex;
+    return TMR_ERROR_OUT_OF_MEMORY;
+  }
+  table->mask = size - 1;
+  for (i = 0; i < size; i++)
+  {
+    table->index[i] = TMR_DUP_TABLE_EMPTY;
+  }
+
+  for (i = 0; i < oldSize; i++)
+  {
+    if (TMR_DUP_TABLE_EMPTY != oldIndex[i])
     {
-      if (oldRead->tag.protocol != newRead->tag.protocol)
-      {
-        continue;
-      }
+      for (j = oldHash[i] & table->mask;
+           TMR_DUP_TABLE_EMPTY != table->index[j];
+           j = (j + 1) & table->mask)
+        ;
+      table->hash[j] = oldHash[i];
+      table->index[j] = oldIndex[i];
+    }
+  }
+  free(oldHash);
+  free(oldIndex);
+  return TMR_SUCCESS;
+}
+
+static void
+TMR_freeDupTable(TMR_DupTable *table)
+{
+  free(table->hash);
+  free(table->index);
+  table->hash = NULL;
+  table->index = NULL;
+}
+
+/**
+ * Look newRead up among the first oldLength reads. Returns the index of
+ * the matching read, or -1 after recording newRead as read oldLength.
+ */
+static int
+TMR_findDupTag(TMR_DupTable *table,
+               TMR_TagReadData* newRead,
+               TMR_TagReadData oldReads[], int32_t oldLength)
+{
+  uint32_t h, i;
+
+  /* Keep the load factor at or below one half */
+  if (NULL == table->hash)
+  {
+    if (TMR_SUCCESS != TMR_resizeDupTable(table, TMR_DUP_TABLE_MIN_SIZE))
+    {
+      return -1;
+    }
+  }
+  else if ((uint32_t)(table->used + 1) * 2 > table->mask + 1)
+  {
+    if (TMR_SUCCESS != TMR_resizeDupTable(table, (table->mask + 1) * 2))
+    {
+      return -1;
+    }
+  }
+
+  h = TMR_hashDupKey(table, newRead);
+  for (i = h & table->mask;
+       TMR_DUP_TABLE_EMPTY != table->index[i];
+       i = (i + 1) & table->mask)
+  {
+    if ((table->hash[i] == h) &&
+        TMR_isDupTag(table, &oldReads[table->index[i]], newRead))
+    {
+      return table->index[i];
     }
-    /* No fields mismatched; this tag is a match */
-    break;
   }
 
-  return (i < oldLength) ? i : -1;
+  table->hash[i] = h;
+  table->index[i] = oldLength;
+  table->used++;
+  return -1;
 }
 
 static void
@@ -476,8 +637,8 @@ TMR_updateDupTag(TMR_Reader* reader,
       uint32_t saveCount = oldRead->readCount;
 
       memcpy(oldRead, newRead, sizeof(TMR_TagReadData));
-      /* TODO: TagReadData.data field not yet supported, pending a
-       * comprehensive strategy for dynamic memory allocation. */
+      /* newRead is scratch space for the next fetch, keep our own copy */
+      TMR_relinkTagData(oldRead);
 
       oldRead->readCount = saveCount;
     }
@@ -490,13 +651,14 @@ TMR_Status
 TMR_readIntoArray(struct TMR_Reader *reader, uint32_t timeoutMs,
                   int32_t *tagCount, TMR_TagReadData *result[])
 {
-  int32_t tagsRead, count, alloc;
+  int32_t tagsRead, count, alloc, i;
   uint32_t readTimeMs, elapsed = 0;
   uint32_t starttimeLow, starttimeHigh;
   TMR_TagReadData *results;
   TMR_Status ret;
 #ifdef TMR_ENABLE_API_SIDE_DEDUPLICATION
   bool uniqueByAntenna, uniqueByData, recordHighestRssi, uniqueByProtocol;
+  TMR_DupTable dupTable;
 #endif /* TMR_ENABLE_API_SIDE_DEDUPLICATION */
 
   readTimeMs = timeoutMs;
@@ -525,6 +687,13 @@ TMR_readIntoArray(struct TMR_Reader *reader, uint32_t timeoutMs,
     else if (TMR_SUCCESS != ret) { return ret; }
     recordHighestRssi = bval;
   }
+  dupTable.hash = NULL;
+  dupTable.index = NULL;
+  dupTable.used = 0;
+  dupTable.mask = 0;
+  dupTable.uniqueByAntenna = uniqueByAntenna;
+  dupTable.uniqueByData = uniqueByData;
+  dupTable.uniqueByProtocol = uniqueByProtocol;
 #endif /* TMR_ENABLE_API_SIDE_DEDUPLICATION */
 
   tagsRead = 0;
@@ -573,6 +742,10 @@ TMR_readIntoArray(struct TMR_Reader *reader, uint32_t timeoutMs,
         goto out;
       }
       results = newResults;
+      for (i = 0; i < tagsRead; i++)
+      {
+        TMR_relinkTagData(&results[i]);
+      }
     }
     while (TMR_SUCCESS == TMR_hasMoreTags(reader))
     {
@@ -587,6 +760,10 @@ TMR_readIntoArray(struct TMR_Reader *reader, uint32_t timeoutMs,
           goto out;
         }
         results = newResults;
+        for (i = 0; i < tagsRead; i++)
+        {
+          TMR_relinkTagData(&results[i]);
+        }
       }
       TMR_TRD_init(&results[tagsRead]);
       ret = TMR_getNextTag(reader, &results[tagsRead]);
@@ -604,8 +781,7 @@ TMR_readIntoArray(struct TMR_Reader *reader, uint32_t timeoutMs,
       if (true == reader->u.serialReader.enableReadFiltering)
       {
         TMR_TagReadData* last = &results[tagsRead];
-        int dupIndex = TMR_findDupTag(reader, last, results, tagsRead,
-                        uniqueByAntenna, uniqueByData, uniqueByProtocol);
+        int dupIndex = TMR_findDupTag(&dupTable, last, results, tagsRead);
         if (-1 == dupIndex)
           {
             tagsRead++;
@@ -626,6 +802,9 @@ TMR_readIntoArray(struct TMR_Reader *reader, uint32_t timeoutMs,
 
   }while (elapsed <= timeoutMs);
 out:
+#ifdef TMR_ENABLE_API_SIDE_DEDUPLICATION
+  TMR_freeDupTable(&dupTable);
+#endif /* TMR_ENABLE_API_SIDE_DEDUPLICATION */
   if (NULL != tagCount)
     *tagCount = tagsRead;
   *result = results;
@@ -939,6 +1118,51 @@ void checkForAvailableFeatures(struct TMR_Reader *reader)
   }
 }
 
+/**
+ * The /reader/metrics counters of one writer, cleared first if the
+ * metrics have been reset since that writer last updated them.  Only
+ * the thread owning the block may call this.
+ */
+TMR_ReaderMetrics *
+TMR__metrics(TMR_Reader *reader, TMR_MetricsCounters *counters)
+{
+  uint32_t epoch;
+
+  epoch = reader->metricsEpoch;
+  if (counters->epoch != epoch)
+  {
+    memset(&counters->m, 0, sizeof(counters->m));
+    counters->epoch = epoch;
+  }
+  return &counters->m;
+}
+
+/**
+ * Merge the I/O and parser counters.  A block that has not been
+ * updated since the last reset reads as zero.  The counters are not
+ * read atomically, so while reading they are only approximately in
+ * step with each other.
+ */
+static void
+get_metrics(TMR_Reader *reader, TMR_ReaderMetrics *metrics)
+{
+  static const TMR_ReaderMetrics none;
+  const TMR_ReaderMetrics *io, *parser;
+  uint32_t epoch;
+
+  epoch = reader->metricsEpoch;
+  io = (reader->metricsIo.epoch == epoch) ? &reader->metricsIo.m : &none;
+  parser = (reader->metricsParser.epoch == epoch) ? &reader->metricsParser.m : &none;
+
+  *metrics = *parser;
+  metrics->framesReceived = io->framesReceived;
+  metrics->crcErrors = io->crcErrors;
+  metrics->resyncBytes = io->resyncBytes;
+  metrics->bufferFullResubmits = io->bufferFullResubmits;
+  metrics->queueHighWater = io->queueHighWater;
+  metrics->queueDrops = io->queueDrops + parser->queueDrops;
+}
+
 TMR_Status
 TMR_paramSet(struct TMR_Reader *reader, TMR_Param key, const void *value)
 {
@@ -948,6 +1172,41 @@ TMR_paramSet(struct TMR_Reader *reader, TMR_Param key, const void *value)
 
   switch (key)
   {
+  case TMR_PARAM_TRANSPORT_TRACE_RAW:
+    reader->transportTraceRaw = *(bool *)value;
+    break;
+  case TMR_PARAM_READER_METRICS:
+    /* Any value resets the counters, see TMR__metrics() */
+    reader->metricsEpoch++;
+    break;
+#ifdef TMR_ENABLE_BACKGROUND_READS
+  case TMR_PARAM_READ_ASYNC_QUEUE_HIGHWATER:
+  case TMR_PARAM_READ_ASYNC_QUEUE_DROPS:
+    ret = TMR_ERROR_READONLY;
+    break;
+  case TMR_PARAM_READ_ASYNC_QUEUE_DEPTH:
+    /* Takes effect on the next TMR_startReading() */
+    if ((0 == *(uint32_t *)value) || (TMR_MAX_VALUE < *(uint32_t *)value))
+    {
+      return TMR_ERROR_INVALID_VALUE;
+    }
+    reader->asyncQueueDepth = *(uint32_t *)value;
+    break;
+  case TMR_PARAM_READ_ASYNC_QUEUE_POLICY:
+    switch (*(TMR_AsyncQueuePolicy *)value)
+    {
+    case TMR_ASYNC_QUEUE_POLICY_STOP:
+    case TMR_ASYNC_QUEUE_POLICY_BLOCK:
+    case TMR_ASYNC_QUEUE_POLICY_DROP_OLDEST:
+    case TMR_ASYNC_QUEUE_POLICY_DROP_NEWEST:
+    case TMR_ASYNC_QUEUE_POLICY_COALESCE_EPC:
+      reader->asyncQueuePolicy = *(TMR_AsyncQueuePolicy *)value;
+      break;
+    default:
+      ret = TMR_ERROR_INVALID_VALUE;
+    }
+    break;
+#endif
 #if defined(TMR_ENABLE_BACKGROUND_READS)|| defined(SINGLE_THREAD_ASYNC_READ)
   case TMR_PARAM_READ_ASYNCOFFTIME:
       {
@@ -1033,6 +1292,26 @@ TMR_paramGet(struct TMR_Reader *reader, TMR_Param key, void *value)
     *plan = *reader->readParams.readPlan;
     break;
   }
+  case TMR_PARAM_TRANSPORT_TRACE_RAW:
+    *(bool *)value = reader->transportTraceRaw;
+    break;
+  case TMR_PARAM_READER_METRICS:
+    get_metrics(reader, value);
+    break;
+#ifdef TMR_ENABLE_BACKGROUND_READS
+  case TMR_PARAM_READ_ASYNC_QUEUE_DEPTH:
+    *(uint32_t *)value = reader->asyncQueueDepth;
+    break;
+  case TMR_PARAM_READ_ASYNC_QUEUE_POLICY:
+    *(TMR_AsyncQueuePolicy *)value = reader->asyncQueuePolicy;
+    break;
+  case TMR_PARAM_READ_ASYNC_QUEUE_HIGHWATER:
+    *(uint32_t *)value = reader->tagQueueHighWater;
+    break;
+  case TMR_PARAM_READ_ASYNC_QUEUE_DROPS:
+    *(uint32_t *)value = reader->tagQueueDropped + reader->tagQueueDiscards;
+    break;
+#endif
 #if defined(TMR_ENABLE_BACKGROUND_READS)|| defined(SINGLE_THREAD_ASYNC_READ) 
   case TMR_PARAM_READ_ASYNCOFFTIME:
   {
@@ -1069,6 +1348,291 @@ LEVEL:
   return ret;
 }
 
+/**
+ * Check a batch entry as far as can be done without talking to the
+ * reader: the key must be known, not repeated earlier in the batch,
+ * and not already known to be unsupported.  A key the reader has not
+ * been asked about yet is left to its setter or getter.
+ */
+static TMR_Status
+checkParamOp(struct TMR_Reader *reader, const TMR_ParamOp *ops, uint32_t index)
+{
+  TMR_Param key;
+  uint32_t *confirmed, *present;
+  uint32_t i;
+
+  key = ops[index].key;
+  if ((key < TMR_PARAM_MIN) || (key > TMR_PARAM_MAX) || (NULL == ops[index].value))
+  {
+    return TMR_ERROR_INVALID;
+  }
+  for (i = 0; i < index; i++)
+  {
+    if (ops[i].key == key)
+    {
+      return TMR_ERROR_INVALID;
+    }
+  }
+
+  switch (reader->readerType)
+  {
+  case TMR_READER_TYPE_SERIAL:
+    confirmed = reader->u.serialReader.paramConfirmed;
+    present = reader->u.serialReader.paramPresent;
+    break;
+#ifdef TMR_ENABLE_LLRP_READER
+  case TMR_READER_TYPE_LLRP:
+    confirmed = reader->u.llrpReader.paramConfirmed;
+    present = reader->u.llrpReader.paramPresent;
+    break;
+#endif
+  default:
+    return TMR_SUCCESS;
+  }
+  if (BITGET(confirmed, key) && (0 == BITGET(present, key)))
+  {
+    return TMR_ERROR_NOT_FOUND;
+  }
+  return TMR_SUCCESS;
+}
+
+/**
+ * Check a value to set against the ranges that do not depend on the
+ * reader, and the power against the limits a serial reader has cached.
+ * Anything else is left to the setter.
+ */
+static TMR_Status
+checkParamValue(struct TMR_Reader *reader, TMR_Param key, const void *value)
+{
+  switch (key)
+  {
+  case TMR_PARAM_GEN2_SESSION:
+    if (TMR_GEN2_SESSION_MAX < (uint32_t)*(const TMR_GEN2_Session *)value)
+    {
+      return TMR_ERROR_ILLEGAL_VALUE;
+    }
+    break;
+
+  case TMR_PARAM_GEN2_TARGET:
+    if (TMR_GEN2_TARGET_MAX < (uint32_t)*(const TMR_GEN2_Target *)value)
+    {
+      return TMR_ERROR_ILLEGAL_VALUE;
+    }
+    break;
+
+  case TMR_PARAM_GEN2_TAGENCODING:
+    if (TMR_GEN2_MILLER_MAX < (uint32_t)*(const TMR_GEN2_TagEncoding *)value)
+    {
+      return TMR_ERROR_ILLEGAL_VALUE;
+    }
+    break;
+
+  case TMR_PARAM_GEN2_TARI:
+    if (TMR_GEN2_TARI_MAX < (uint32_t)*(const TMR_GEN2_Tari *)value)
+    {
+      return TMR_ERROR_ILLEGAL_VALUE;
+    }
+    break;
+
+  case TMR_PARAM_GEN2_BLF:
+    switch (*(const TMR_GEN2_LinkFrequency *)value)
+    {
+    case TMR_GEN2_LINKFREQUENCY_250KHZ:
+    case TMR_GEN2_LINKFREQUENCY_320KHZ:
+    case TMR_GEN2_LINKFREQUENCY_640KHZ:
+      break;
+    default:
+      return TMR_ERROR_ILLEGAL_VALUE;
+    }
+    break;
+
+  case TMR_PARAM_GEN2_Q:
+  {
+    const TMR_GEN2_Q *q = value;
+
+    if ((TMR_SR_GEN2_Q_MAX < (uint32_t)q->type) ||
+        ((TMR_SR_GEN2_Q_STATIC == q->type) && (15 < q->u.staticQ.initialQ)))
+    {
+      return TMR_ERROR_ILLEGAL_VALUE;
+    }
+    break;
+  }
+
+  case TMR_PARAM_RADIO_READPOWER:
+  case TMR_PARAM_RADIO_WRITEPOWER:
+  {
+    int32_t power = *(const int32_t *)value;
+
+    if ((32767 < power) || (-32768 > power))
+    {
+      return TMR_ERROR_ILLEGAL_VALUE;
+    }
+    if ((TMR_READER_TYPE_SERIAL == reader->readerType) &&
+        (true == reader->u.serialReader.paramCache.enable))
+    {
+      TMR_SR_SerialReader *sr = &reader->u.serialReader;
+
+      if ((BITGET(sr->paramCached, TMR_PARAM_RADIO_POWERMAX) && (sr->paramCache.powerMax < power)) ||
+          (BITGET(sr->paramCached, TMR_PARAM_RADIO_POWERMIN) && (sr->paramCache.powerMin > power)))
+      {
+        return TMR_ERROR_ILLEGAL_VALUE;
+      }
+    }
+    break;
+  }
+
+#ifdef TMR_ENABLE_BACKGROUND_READS
+  case TMR_PARAM_READ_ASYNC_QUEUE_DEPTH:
+    if ((0 == *(const uint32_t *)value) || (TMR_MAX_VALUE < *(const uint32_t *)value))
+    {
+      return TMR_ERROR_INVALID_VALUE;
+    }
+    break;
+
+  case TMR_PARAM_READ_ASYNC_QUEUE_POLICY:
+    if (TMR_ASYNC_QUEUE_POLICY_COALESCE_EPC < (uint32_t)*(const TMR_AsyncQueuePolicy *)value)
+    {
+      return TMR_ERROR_INVALID_VALUE;
+    }
+    break;
+#endif
+
+  default:
+    break;
+  }
+  return TMR_SUCCESS;
+}
+
+/** First entry of the batch that failed, or TMR_SUCCESS */
+static TMR_Status
+batchStatus(const TMR_ParamOp *ops, uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (TMR_SUCCESS != ops[i].status)
+    {
+      return ops[i].status;
+    }
+  }
+  return TMR_SUCCESS;
+}
+
+/** Index of the first entry of the batch that failed, or count */
+static uint32_t
+batchFailedIndex(const TMR_ParamOp *ops, uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (TMR_SUCCESS != ops[i].status)
+    {
+      break;
+    }
+  }
+  return i;
+}
+
+TMR_Status
+TMR_paramSetMany(struct TMR_Reader *reader, TMR_ParamOp *ops, uint32_t count,
+                 uint32_t *failedIndex)
+{
+  TMR_Status ret;
+  uint32_t i;
+  bool failed;
+
+  if ((NULL == reader) || ((NULL == ops) && (0 != count)))
+  {
+    return TMR_ERROR_INVALID;
+  }
+
+  /* Nothing is set unless every entry looks settable */
+  failed = false;
+  for (i = 0; i < count; i++)
+  {
+    ops[i].status = checkParamOp(reader, ops, i);
+    if (TMR_SUCCESS == ops[i].status)
+    {
+      ops[i].status = checkParamValue(reader, ops[i].key, ops[i].value);
+    }
+    failed |= (TMR_SUCCESS != ops[i].status);
+  }
+  if (failed)
+  {
+    ret = batchStatus(ops, count);
+    if (NULL != failedIndex)
+    {
+      *failedIndex = batchFailedIndex(ops, count);
+    }
+    for (i = 0; i < count; i++)
+    {
+      if (TMR_SUCCESS == ops[i].status)
+      {
+        ops[i].status = TMR_ERROR_BATCH_ABORTED;
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * The reader may only settle an entry later, in paramBatchFlush(),
+   * so an entry can turn out to have failed after the ones following
+   * it were sent; those keep their own outcome.
+   */
+  reader->batchOps = ops;
+  for (i = 0; i < count; i++)
+  {
+    reader->batchIndex = i;
+    ret = TMR_paramSet(reader, ops[i].key, ops[i].value);
+    if ((TMR_SUCCESS != ret) && (TMR_SUCCESS == ops[i].status))
+    {
+      ops[i].status = ret;
+    }
+    if (TMR_SUCCESS != batchStatus(ops, i + 1))
+    {
+      break;
+    }
+  }
+  if (NULL != reader->paramBatchFlush)
+  {
+    reader->paramBatchFlush(reader);
+  }
+  reader->batchOps = NULL;
+
+  if (NULL != failedIndex)
+  {
+    *failedIndex = batchFailedIndex(ops, count);
+  }
+  for (i++; i < count; i++)
+  {
+    ops[i].status = TMR_ERROR_BATCH_ABORTED;
+  }
+  return batchStatus(ops, count);
+}
+
+TMR_Status
+TMR_paramGetMany(struct TMR_Reader *reader, TMR_ParamOp *ops, uint32_t count)
+{
+  uint32_t i;
+
+  if ((NULL == reader) || ((NULL == ops) && (0 != count)))
+  {
+    return TMR_ERROR_INVALID;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    ops[i].status = checkParamOp(reader, ops, i);
+    if (TMR_SUCCESS == ops[i].status)
+    {
+      ops[i].status = TMR_paramGet(reader, ops[i].key, ops[i].value);
+    }
+  }
+  return batchStatus(ops, count);
+}
+
 
 TMR_Status
 TMR_addTransportListener(TMR_Reader *reader, TMR_TransportListenerBlock *b)
@@ -1168,6 +1732,51 @@ TMR_fileProvider(void *cookie, uint16_t *size, uint8_t *data)
   *size = (uint16_t) len;
   return true;
 }
+
+void
+TMR_rawTraceListener(bool tx, uint32_t dataLen, const uint8_t data[],
+                     uint32_t timeout, void *cookie)
+{
+  TMR_RawTrace *trace;
+  FILE *fp;
+  uint8_t hdr[16];
+  uint64_t usec;
+  uint8_t flags;
+  int i;
+
+  trace = cookie;
+  fp = trace->file;
+  flags = tx ? 0x01 : 0x00;
+  if ((0 == dataLen) && (NULL != data))
+  {
+    flags |= 0x02;
+    dataLen = (uint32_t)strlen((const char *)data);
+  }
+
+  usec = tmr_gettime_us();
+  if (false == trace->wallOffsetValid)
+  {
+    trace->wallOffsetUs = (int64_t)(tmr_gettime() * 1000) - (int64_t)usec;
+    trace->wallOffsetValid = true;
+  }
+  usec = (uint64_t)((int64_t)usec + trace->wallOffsetUs);
+  for (i = 0; i < 8; i++)
+  {
+    hdr[i] = (uint8_t)(usec >> (56 - (8 * i)));
+  }
+  hdr[8] = flags;
+  hdr[9] = hdr[10] = hdr[11] = 0;
+  hdr[12] = (uint8_t)(dataLen >> 24);
+  hdr[13] = (uint8_t)(dataLen >> 16);
+  hdr[14] = (uint8_t)(dataLen >> 8);
+  hdr[15] = (uint8_t)(dataLen >> 0);
+
+  fwrite(hdr, 1, sizeof(hdr), fp);
+  if (0 != dataLen)
+  {
+    fwrite(data, 1, dataLen, fp);
+  }
+}
 #endif
 
 /**
@@ -1193,6 +1802,7 @@ TMR_TRD_init(TMR_TagReadData *trd)
   trd->dspMicros = 0;
   trd->timestampLow = 0;
   trd->timestampHigh = 0;
+  trd->timestampMicros = 0;
 
 #if TMR_MAX_EMBEDDED_DATA_LENGTH
   trd->data.list = trd->_dataList;
@@ -99,6 +99,67 @@ bool isRegionConfiguration(struct TMR_Reader *reader);
 void checkForAvailableFeatures(struct TMR_Reader *reader);
 void checkForAvailableReaderFeatures(struct TMR_Reader *reader);
 
+/**
+ * What the background reader does with a streamed tag read when the
+ * queue to the parser thread is full, i.e. the read listeners are not
+ * keeping up.
+ */
+typedef enum TMR_AsyncQueuePolicy
+{
+  /**
+   * Report TMR_ERROR_BUFFER_OVERFLOW and stop the search until the queue
+   * has drained (default).  The queue holds at least
+   * TMR_ASYNC_QUEUE_STOP_MIN_DEPTH reads under this policy.
+   */
+  TMR_ASYNC_QUEUE_POLICY_STOP = 0,
+  /** Wait for the parser to free a slot */
+  TMR_ASYNC_QUEUE_POLICY_BLOCK = 1,
+  /** Discard the oldest tag read waiting in the queue */
+  TMR_ASYNC_QUEUE_POLICY_DROP_OLDEST = 2,
+  /** Discard the tag read that did not fit */
+  TMR_ASYNC_QUEUE_POLICY_DROP_NEWEST = 3,
+  /** Wait, merging queued reads of the same EPC into one notification */
+  TMR_ASYNC_QUEUE_POLICY_COALESCE_EPC = 4,
+} TMR_AsyncQueuePolicy;
+
+/** Buckets of TMR_ReaderMetrics.callbackHistogram */
+#define TMR_METRICS_HISTOGRAM_BUCKETS 16
+
+/**
+ * Host-side counters of the reader's receive path, read with
+ * /reader/metrics.  Setting /reader/metrics, to any value, resets them.
+ * They are counted since the reader was created or last reset.
+ */
+typedef struct TMR_ReaderMetrics
+{
+  /** Frames received from the reader, streamed tag reads included */
+  uint64_t framesReceived;
+  /** Serial frames dropped because their CRC did not match */
+  uint32_t crcErrors;
+  /** Bytes discarded while looking for the start of a serial frame */
+  uint32_t resyncBytes;
+  /** Searches resubmitted after the module's tag buffer filled up */
+  uint32_t bufferFullResubmits;
+  /** Most responses waiting for the parser thread at once */
+  uint32_t queueHighWater;
+  /** Tag reads dropped under /reader/read/asyncQueuePolicy */
+  uint32_t queueDrops;
+  /** Tag reads delivered to the read listeners */
+  uint64_t tagsNotified;
+  /** Time responses waited in the queue for the parser, microseconds */
+  uint64_t parserLagTotalUs;
+  uint32_t parserLagMaxUs;
+  /** Time spent in the read listeners, microseconds */
+  uint64_t callbackTotalUs;
+  uint32_t callbackMaxUs;
+  /**
+   * Read listener time per tag read: bucket 0 counts calls under 1 us,
+   * bucket i calls from 2^(i-1) up to 2^i us, and the last bucket
+   * everything longer.
+   */
+  uint32_t callbackHistogram[TMR_METRICS_HISTOGRAM_BUCKETS];
+} TMR_ReaderMetrics;
+
 typedef struct TMR_readParams
 {
 #if defined(TMR_ENABLE_BACKGROUND_READS)|| defined(SINGLE_THREAD_ASYNC_READ)
@@ -272,6 +333,40 @@ typedef struct TMR_ReadListenerBlock
   struct TMR_ReadListenerBlock *next;
 } TMR_ReadListenerBlock;
 
+/**
+ * Type of functions to be registered as batch read callbacks
+ * @param reader  Reader object
+ * @param trds  Array of tag reads, valid only for the duration of the call
+ * @param count  Number of tag reads in trds
+ * @param cookie  Arbitrary data structure to be passed to callback
+ */
+typedef void (*TMR_BatchReadListener)(TMR_Reader *reader, const TMR_TagReadData *trds,
+                                      uint32_t count, void *cookie);
+/**
+ * User-allocated structure containing the callback pointer and the
+ * value to pass to that callback. The batch storage is allocated by
+ * TMR_addBatchReadListener() and released by TMR_removeBatchReadListener().
+ */
+typedef struct TMR_BatchReadListenerBlock
+{
+  /** Pointer to callback function */
+  TMR_BatchReadListener listener;
+  /** Value to pass to callback function */
+  void *cookie;
+  /** @private */
+  uint32_t maxBatch;
+  /** @private */
+  uint32_t maxLatencyMs;
+  /** @private */
+  TMR_TagReadData *batch;
+  /** @private */
+  uint32_t count;
+  /** @private Time (tmr_gettime_us()) the pending batch must go out by */
+  uint64_t due;
+  /** @private */
+  struct TMR_BatchReadListenerBlock *next;
+} TMR_BatchReadListenerBlock;
+
 /** Type of functions to be registered as tagauth request callbacks 
  * @param reader  Reader object
  * @param trd  TagReadData object
@@ -380,9 +475,22 @@ typedef struct TMR_Queue_tagReads
   /* Object to hold tag results */
   TMR_TagReadData trd;
   bool isStatusResponse;
-  struct TMR_Queue_tagReads  *next;
+  /* Already merged into an earlier entry, skip the notification */
+  bool coalesced;
+  /* When the background reader queued it, for the parser lag metric */
+  uint64_t queuedUs;
 }TMR_Queue_tagReads;
 
+/**
+ * Private: should not be used by user level application.
+ * The /reader/metrics counters written by one thread, see TMR__metrics().
+ */
+typedef struct TMR_MetricsCounters
+{
+  uint32_t epoch;
+  TMR_ReaderMetrics m;
+}TMR_MetricsCounters;
+
 typedef TMR_SR_GEN2_QType TMR_GEN2_QType;
 typedef TMR_SR_GEN2_QStatic TMR_GEN2_QStatic;
 typedef TMR_SR_GEN2_Q TMR_GEN2_Q;
@@ -428,6 +536,20 @@ typedef struct TMR_LicenseOperation
  * to be in range.
  */
 
+/**
+ * @ingroup reader
+ * One parameter of a TMR_paramSetMany() or TMR_paramGetMany() batch.
+ */
+typedef struct TMR_ParamOp
+{
+  /** The parameter to set or get */
+  TMR_Param key;
+  /** Value to set, or where to put the value got, as for TMR_paramSet() and TMR_paramGet() */
+  void *value;
+  /** [out] Outcome for this parameter alone */
+  TMR_Status status;
+} TMR_ParamOp;
+
 /**
  * @ingroup reader
  * @struct TMR_Reader
@@ -510,9 +632,30 @@ struct TMR_Reader
   bool finishedReading;
 #ifdef TMR_ENABLE_BACKGROUND_READS
   enum TMR_ReadState readState;
-  unsigned int queue_depth;
+  /**
+   * Single-producer/single-consumer ring between the background reader
+   * (producer, advances tagQueueTail) and the parser (consumer, advances
+   * tagQueueHead).  One slot is always left empty to tell full from empty.
+   */
+  TMR_Queue_tagReads *tagQueue;
+  uint32_t tagQueueSlots;
+  /* Serial response buffers backing tagQueue[i].tagEntry.sMsg */
+  uint8_t *tagQueueBuffers;
+  volatile uint32_t tagQueueHead, tagQueueTail;
+  /* Set by a thread that is about to sleep on the matching semaphore */
+  volatile uint32_t parserIdle, readerBlocked;
+  /* Asks the parser to exit once the queue is empty */
+  volatile uint32_t parserExit;
+  /**
+   * Queue statistics.  Reads dropped by the background reader and
+   * discards it has asked the parser for are counted on the reader
+   * side, discards carried out on the parser side, so every counter
+   * has a single writer.
+   */
+  uint32_t tagQueueHighWater;
+  uint32_t tagQueueDropped;
+  volatile uint32_t tagQueueDiscardRequests, tagQueueDiscards;
   sem_t queue_slots, queue_length;
-  pthread_mutex_t queue_lock;
   pthread_mutex_t backgroundLock;
   pthread_mutex_t parserLock;
   pthread_mutex_t listenerLock;  
@@ -529,8 +672,6 @@ struct TMR_Reader
   TMR_StatsListenerBlock *statsListeners;
 #ifdef TMR_ENABLE_BACKGROUND_READS
   TMR_StatusListenerBlock *statusListeners;
-  TMR_Queue_tagReads *tagQueueTail;
-  TMR_Queue_tagReads *tagQueueHead;
 #endif
   TMR_Reader_StatsFlag statsFlag;
   TMR_SR_StatusType streamStats;
@@ -582,6 +723,39 @@ struct TMR_Reader
   TMR_Status (*cmdAutonomousReading)(struct TMR_Reader *reader, TMR_TagReadData *trd, TMR_Reader_StatsValues *stats);
 #endif
   TMR_Status (*cmdStopReading)(struct TMR_Reader *reader);
+
+#ifdef TMR_ENABLE_BACKGROUND_READS
+  /* /reader/read/asyncQueueDepth and /reader/read/asyncQueuePolicy */
+  uint32_t asyncQueueDepth;
+  TMR_AsyncQueuePolicy asyncQueuePolicy;
+  /**
+   * A full queue made the background reader stop the search, which
+   * has not been resubmitted yet.  Guarded by backgroundLock.
+   */
+  bool isBufferOverFlow;
+  TMR_BatchReadListenerBlock *batchReadListeners;
+#endif
+  /**
+   * The TMR_paramSetMany() batch being applied, and the entry of it
+   * being set, or NULL outside a batch.  Reader types may hold back
+   * the commands of a batch and settle them in paramBatchFlush().
+   */
+  TMR_ParamOp *batchOps;
+  uint32_t batchIndex;
+  TMR_Status (*paramBatchFlush)(struct TMR_Reader *reader);
+  /**
+   * Pass raw protocol frames to the transport listeners instead of a
+   * decoded text rendering (LLRP readers only; serial readers always
+   * pass raw bytes).
+   */
+  bool transportTraceRaw;
+  /**
+   * /reader/metrics.  The thread doing transport I/O and the parser
+   * thread each write only their own block.  A reset just bumps
+   * metricsEpoch, and each block clears itself on its next update.
+   */
+  TMR_MetricsCounters metricsIo, metricsParser;
+  volatile uint32_t metricsEpoch;
 };
 
 /**
@@ -932,6 +1106,48 @@ bool TMR_memoryProvider(void *cookie, uint16_t *size, uint8_t *data);
  */
 bool TMR_fileProvider(void *cookie, uint16_t *size, uint8_t *data);
 
+#ifdef TMR_ENABLE_STDIO
+/**
+ * The cookie of TMR_rawTraceListener(): the file a trace is written to,
+ * and the clock offset its timestamps are taken with.  Set file and
+ * zero the rest, e.g. TMR_RawTrace trace = {fp}; use one per reader.
+ */
+typedef struct TMR_RawTrace
+{
+  /** FILE * opened for binary writing */
+  void *file;
+  /** @private Wall clock minus tmr_gettime_us(), taken on the first message */
+  int64_t wallOffsetUs;
+  /** @private */
+  bool wallOffsetValid;
+} TMR_RawTrace;
+
+/**
+ * This function can be used as a transport listener to record a binary
+ * trace of the traffic with the reader. Set /reader/transportTraceRaw
+ * to true on LLRP readers so that frames are recorded as sent on the
+ * wire rather than as XML.
+ *
+ * Each message is written as a 16-byte header followed by the message
+ * bytes. All header fields are big-endian:
+ * @li bytes 0-7: host time in microseconds since the epoch. It is
+ *     taken from tmr_gettime_us(), with the wall clock sampled once
+ *     per trace for the offset, so a step of the wall clock does not
+ *     reorder a trace; the resolution is that of tmr_gettime_us()
+ * @li byte 8: flags; 0x01 transmitted by the host, 0x02 text (XML) payload
+ * @li bytes 9-11: reserved, zero
+ * @li bytes 12-15: payload length
+ *
+ * @param tx True for messages sent to the reader.
+ * @param dataLen Length of data, or 0 if data is a NUL-terminated string.
+ * @param data The message.
+ * @param timeout The timeout in effect for the message (not recorded).
+ * @param cookie The trace's TMR_RawTrace.
+ */
+void TMR_rawTraceListener(bool tx, uint32_t dataLen, const uint8_t data[],
+                          uint32_t timeout, void *cookie);
+#endif
+
 /**
  * @ingroup reader
  * Set the value of a reader parameter.
@@ -969,6 +1185,56 @@ TMR_Status TMR_paramSet(struct TMR_Reader *reader, TMR_Param key, const void *va
  */
 TMR_Status TMR_paramGet(struct TMR_Reader *reader, TMR_Param key, void *value);
 
+/**
+ * @ingroup reader
+ * Set several reader parameters at once.
+ *
+ * Every entry is checked first, without sending anything to the
+ * reader: a key that is out of range, given twice, already known to
+ * be unsupported, or without a value fails the whole batch before
+ * anything is set, and so does a value out of its range for the Gen2
+ * session, target, tag encoding, Tari, BLF and Q, the read and write
+ * power (against the limits the parameter cache holds, if it does),
+ * and the async queue depth and policy.  Other values, and keys the
+ * reader has not been asked about yet, are checked by their setter,
+ * as for TMR_paramSet(), when their turn comes.
+ *
+ * The parameters are then set in order, the reader's commands being
+ * pipelined (serial readers) or merged into as few SET_READER_CONFIG
+ * messages as possible (LLRP readers).  A setting the API keeps a
+ * copy of itself, such as read filtering, extended EPC or the
+ * statistics flags, is sent on its own and waits for its answer.
+ * Setting stops at the first failure.  The call is not transactional:
+ * the entries before the failure stay set and are not rolled back.
+ * The ones after it are not set, except for any already sent by the
+ * time the failure was reported, which keep their own status.
+ *
+ * @param reader The reader to operate on.
+ * @param ops The parameters, in the order they are to be set.  The
+ * status of each entry is set to its own outcome, with
+ * TMR_ERROR_BATCH_ABORTED for the entries not set because of another.
+ * @param count Number of entries in ops.
+ * @param failedIndex [out] Index of the first entry that failed, or
+ * count if none did.  May be NULL.
+ * @return TMR_SUCCESS, or the status of the first entry that failed.
+ */
+TMR_Status TMR_paramSetMany(struct TMR_Reader *reader, TMR_ParamOp *ops, uint32_t count,
+                            uint32_t *failedIndex);
+
+/**
+ * @ingroup reader
+ * Get several reader parameters at once, with the same key checks,
+ * and the same per-entry status, as TMR_paramSetMany().  Unlike setting,
+ * an entry that fails, whether in the checks or at the reader, does
+ * not keep the others from being got.
+ *
+ * @param reader The reader to operate on.
+ * @param ops The parameters, each value prepared as for TMR_paramGet().
+ * @param count Number of entries in ops.
+ * @return TMR_SUCCESS, or the status of the first entry that failed.
+ */
+TMR_Status TMR_paramGetMany(struct TMR_Reader *reader, TMR_ParamOp *ops, uint32_t count);
+
 /**
  * @ingroup reader
  * Reboot the reader
@@ -1192,6 +1458,39 @@ TMR_Status TMR_addAuthReqListener(struct TMR_Reader *reader,
 TMR_Status TMR_removeReadListener(struct TMR_Reader *reader,
                                   TMR_ReadListenerBlock *block);
 
+/**
+ * @ingroup reader
+ * Add a listener that receives background tag reads in batches rather
+ * than one call per tag. Each read is copied into the listener's batch,
+ * which is delivered once it holds maxBatch reads or maxLatencyMs has
+ * passed since its first read, whichever comes first. Without streaming
+ * the reads of a search only arrive at the end of its on time, and the
+ * latency counts from then. Reads still pending when TMR_stopReading()
+ * finishes are delivered before it returns.
+ *
+ * @param reader The reader to operate on.
+ * @param block A structure containing a pointer to the listener
+ * function and a user-supplied cookie value to pass to the function
+ * when called.
+ * @param maxBatch The largest number of reads passed in one call.
+ * @param maxLatencyMs How long a read may wait in a batch, 0 to wait
+ * for the batch to fill.
+ */
+TMR_Status TMR_addBatchReadListener(struct TMR_Reader *reader,
+                                    TMR_BatchReadListenerBlock *block,
+                                    uint32_t maxBatch, uint32_t maxLatencyMs);
+
+/**
+ * @ingroup reader
+ * Remove a batch read listener, delivering any reads still pending in
+ * its batch and releasing the batch storage.
+ *
+ * @param reader The reader to operate on.
+ * @param block The structure passed to TMR_addBatchReadListener().
+ */
+TMR_Status TMR_removeBatchReadListener(struct TMR_Reader *reader,
+                                       TMR_BatchReadListenerBlock *block);
+
 /**
  * @ingroup reader
  * Add a listener to the list of functions that will be called for
@@ -1349,8 +1648,10 @@ TMR_Status validateReadPlan(TMR_Reader *reader, TMR_ReadPlan *plan, TMR_AntennaM
 void TMR__notifyTransportListeners(TMR_Reader *reader, bool tx, 
                                    uint32_t dataLen, uint8_t *data,
                                    int timeout);
+TMR_ReaderMetrics *TMR__metrics(TMR_Reader *reader, TMR_MetricsCounters *counters);
 
 void notify_exception_listeners(TMR_Reader *reader, TMR_Status status);
+void notify_read_listeners(TMR_Reader *reader, TMR_TagReadData *trd);
 void cleanup_background_threads(TMR_Reader *reader);
 
 #ifdef TMR_ENABLE_SERIAL_READER_ONLY
@@ -40,6 +40,7 @@ TMR_Status restart_reading(struct TMR_Reader *reader);
 #include <time.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 #ifndef WIN32
 #include <sys/time.h>
@@ -54,7 +55,151 @@ TMR_Status restart_reading(struct TMR_Reader *reader);
 static void *do_background_reads(void *arg);
 static void *parse_tag_reads(void *arg);
 static void process_async_response(TMR_Reader *reader);
-bool isBufferOverFlow = false;
+static void flush_batch_read_listeners(TMR_Reader *reader, bool all);
+
+/**
+ * Ordering primitives for the tag queue indices.  The queue has exactly one
+ * producer and one consumer, so acquire/release on the head and tail indices
+ * is enough to hand a slot over.  The full fence orders a thread's idle flag
+ * against its final look at the indices before it sleeps.
+ */
+#if defined(__ATOMIC_ACQUIRE)
+#define QUEUE_LOAD(p)       __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define QUEUE_STORE(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define QUEUE_EXCHANGE(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define QUEUE_FENCE()       __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(WIN32)
+#define QUEUE_LOAD(p)       queue_load(p)
+#define QUEUE_STORE(p, v)   queue_store((p), (v))
+#define QUEUE_EXCHANGE(p, v) ((uint32_t)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+#define QUEUE_FENCE()       MemoryBarrier()
+
+static uint32_t
+queue_load(volatile uint32_t *p)
+{
+  uint32_t value = *p;
+  MemoryBarrier();
+  return value;
+}
+
+static void
+queue_store(volatile uint32_t *p, uint32_t value)
+{
+  MemoryBarrier();
+  *p = value;
+}
+#else
+#error "No atomic primitives available for the background read queue"
+#endif
+
+static uint32_t
+queue_next(TMR_Reader *reader, uint32_t index)
+{
+  index++;
+  return (index == reader->tagQueueSlots) ? 0 : index;
+}
+
+/* Number of entries waiting for the parser */
+static uint32_t
+queue_count(TMR_Reader *reader)
+{
+  uint32_t head, tail;
+
+  head = QUEUE_LOAD(&reader->tagQueueHead);
+  tail = QUEUE_LOAD(&reader->tagQueueTail);
+  return (tail + reader->tagQueueSlots - head) % reader->tagQueueSlots;
+}
+
+/* Number of entries the background reader can still post */
+static uint32_t
+queue_slotsFree(TMR_Reader *reader)
+{
+  return (reader->tagQueueSlots - 1) - queue_count(reader);
+}
+
+/**
+ * Depth of the queue for the next read: /reader/read/asyncQueueDepth,
+ * raised to TMR_ASYNC_QUEUE_STOP_MIN_DEPTH under the STOP policy.
+ */
+static uint32_t
+tag_queue_depth(TMR_Reader *reader)
+{
+  if ((TMR_ASYNC_QUEUE_POLICY_STOP == reader->asyncQueuePolicy) &&
+      (TMR_ASYNC_QUEUE_STOP_MIN_DEPTH > reader->asyncQueueDepth))
+  {
+    return TMR_ASYNC_QUEUE_STOP_MIN_DEPTH;
+  }
+  return reader->asyncQueueDepth;
+}
+
+/**
+ * Allocate the tag queue and, for serial readers, one response buffer
+ * per slot.  Everything the streaming path needs is carved out here, so
+ * steady-state reading makes no further heap allocations.
+ */
+static TMR_Status
+setup_tag_queue(TMR_Reader *reader, uint32_t depth)
+{
+  uint32_t i;
+
+  reader->tagQueueSlots = depth + 1;
+  reader->tagQueue = calloc(reader->tagQueueSlots, sizeof(TMR_Queue_tagReads));
+  if (NULL == reader->tagQueue)
+  {
+    return TMR_ERROR_OUT_OF_MEMORY;
+  }
+
+  if (TMR_READER_TYPE_SERIAL == reader->readerType)
+  {
+    reader->tagQueueBuffers = malloc(reader->tagQueueSlots * TMR_SR_MAX_PACKET_SIZE);
+    if (NULL == reader->tagQueueBuffers)
+    {
+      free(reader->tagQueue);
+      reader->tagQueue = NULL;
+      return TMR_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (i = 0; i < reader->tagQueueSlots; i++)
+    {
+      reader->tagQueue[i].tagEntry.sMsg = reader->tagQueueBuffers + (i * TMR_SR_MAX_PACKET_SIZE);
+    }
+  }
+
+  reader->tagQueueHead = 0;
+  reader->tagQueueTail = 0;
+  return TMR_SUCCESS;
+}
+
+static void
+free_tag_queue(TMR_Reader *reader)
+{
+  free(reader->tagQueueBuffers);
+  reader->tagQueueBuffers = NULL;
+  free(reader->tagQueue);
+  reader->tagQueue = NULL;
+}
+
+/**
+ * Let the parser drain the queue and exit, then release the queue so
+ * that the next TMR_startReading() can set it up with a new depth.
+ * Must be called without parserLock held.
+ */
+static void
+retire_parser(TMR_Reader *reader)
+{
+  QUEUE_STORE(&reader->parserExit, 1);
+  QUEUE_FENCE();
+  if (QUEUE_EXCHANGE(&reader->parserIdle, 0))
+  {
+    sem_post(&reader->queue_length);
+  }
+  pthread_join(reader->backgroundParser, NULL);
+
+  sem_destroy(&reader->queue_length);
+  sem_destroy(&reader->queue_slots);
+  free_tag_queue(reader);
+  reader->parserSetup = false;
+}
 #endif /* TMR_ENABLE_BACKGROUND_READS */
 
 extern bool isMultiSelectEnabled;
@@ -210,26 +355,44 @@ TMR_startReading(struct TMR_Reader *reader)
      * we still use pseudo-async mechanism for continuous read.
      * To achieve continuous reading, create a parser thread
      */
+    if ((true == reader->parserSetup) &&
+        (reader->tagQueueSlots != tag_queue_depth(reader) + 1))
+    {
+      /* The queue depth or policy changed since the queue was built */
+      retire_parser(reader);
+    }
+
     pthread_mutex_lock(&reader->parserLock);
     
     if (false == reader->parserSetup)
     {
+      /** Allocate the queue and its semaphores only for the first time.
+       *  These are used only in case of streaming, and the semaphores
+       *  are posted only when the other side is actually asleep.
+       */
+      if (TMR_SUCCESS != setup_tag_queue(reader, tag_queue_depth(reader)))
+      {
+        pthread_mutex_unlock(&reader->parserLock);
+        return TMR_ERROR_OUT_OF_MEMORY;
+      }
+      reader->parserIdle = 0;
+      reader->readerBlocked = 0;
+      reader->parserExit = 0;
+      sem_init(&reader->queue_length, 0, 0);
+      sem_init(&reader->queue_slots, 0, 0);
+
       ret = pthread_create(&reader->backgroundParser, NULL,
                        parse_tag_reads, reader);
       if (0 != ret)
       {
+        sem_destroy(&reader->queue_length);
+        sem_destroy(&reader->queue_slots);
+        free_tag_queue(reader);
         pthread_mutex_unlock(&reader->parserLock);
         return TMR_ERROR_NO_THREADS;
       }
       pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
       pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-      pthread_detach(reader->backgroundParser);
-    /** Initialize semaphores only for the first time
-     *  These semaphores are used only in case of streaming
-     */
-      reader->queue_depth = 0;
-      sem_init(&reader->queue_length, 0, 0);
-      sem_init(&reader->queue_slots, 0, TMR_MAX_QUEUE_SLOTS);
       reader->parserSetup = true;
     }
 
@@ -262,6 +425,7 @@ TMR_startReading(struct TMR_Reader *reader)
 
   reader->backgroundEnabled = true;
   reader->searchStatus = true;
+  reader->isBufferOverFlow = false;
 
 #ifdef TMR_ENABLE_SERIAL_READER    
   if (TMR_READER_TYPE_SERIAL == reader->readerType)
@@ -330,6 +494,7 @@ TMR_stopReading(struct TMR_Reader *reader)
   reader->cmdStopReading(reader);
 #else
 #ifdef TMR_ENABLE_BACKGROUND_READS
+  bool overflowed;
 
   /* Check if background setup is active */
   pthread_mutex_lock(&reader->backgroundLock);
@@ -352,8 +517,11 @@ TMR_stopReading(struct TMR_Reader *reader)
   /**
    * Else, read is in progress. Set
    * searchStatus to false;
+   * If a full queue has already stopped the search, the background
+   * reader sees searchStatus and finishes the read itself.
    **/
   reader->searchStatus = false;
+  overflowed = reader->isBufferOverFlow;
   pthread_mutex_unlock(&reader->backgroundLock);
 
   /**
@@ -372,7 +540,7 @@ TMR_stopReading(struct TMR_Reader *reader)
      * In case of true continuous reading, we need to send
      * stop reading message immediately.
        **/
-    if(!isBufferOverFlow)
+    if (false == overflowed)
     {
       reader->cmdStopReading(reader);
     }
@@ -407,6 +575,9 @@ TMR_stopReading(struct TMR_Reader *reader)
   }
   pthread_mutex_unlock(&reader->backgroundLock);
 
+  /* Every read has been through the listeners, hand over partial batches */
+  flush_batch_read_listeners(reader, true);
+
   /**
    * Reset continuous reading settings, so that
    * the subsequent startReading() call doesn't have
@@ -435,6 +606,163 @@ TMR_stopReading(struct TMR_Reader *reader)
   return TMR_SUCCESS;
 }
 
+#if !defined(SINGLE_THREAD_ASYNC_READ) && defined(TMR_ENABLE_BACKGROUND_READS)
+/* Account one delivery to the listeners that took us microseconds */
+static void
+metrics_callback(TMR_Reader *reader, uint64_t us)
+{
+  TMR_ReaderMetrics *metrics;
+  uint32_t bucket;
+
+  metrics = TMR__metrics(reader, &reader->metricsParser);
+  metrics->tagsNotified++;
+  metrics->callbackTotalUs += us;
+  if (us > metrics->callbackMaxUs)
+  {
+    metrics->callbackMaxUs = (uint32_t)us;
+  }
+  for (bucket = 0; (0 != (us >> bucket)) && (bucket < TMR_METRICS_HISTOGRAM_BUCKETS - 1); bucket++)
+    ;
+  metrics->callbackHistogram[bucket]++;
+}
+
+/* Copy a tag read, pointing the embedded data lists at the copy's own storage */
+static void
+copy_tag_read(TMR_TagReadData *dst, const TMR_TagReadData *src)
+{
+  *dst = *src;
+#if TMR_MAX_EMBEDDED_DATA_LENGTH
+  if (src->data.list == src->_dataList)
+  {
+    dst->data.list = dst->_dataList;
+  }
+  if (src->epcMemData.list == src->_epcMemDataList)
+  {
+    dst->epcMemData.list = dst->_epcMemDataList;
+  }
+  if (src->tidMemData.list == src->_tidMemDataList)
+  {
+    dst->tidMemData.list = dst->_tidMemDataList;
+  }
+  if (src->userMemData.list == src->_userMemDataList)
+  {
+    dst->userMemData.list = dst->_userMemDataList;
+  }
+  if (src->reservedMemData.list == src->_reservedMemDataList)
+  {
+    dst->reservedMemData.list = dst->_reservedMemDataList;
+  }
+#endif
+}
+
+/* Deliver a batch listener's pending reads. Called with listenerLock held */
+static void
+flush_batch(TMR_Reader *reader, TMR_BatchReadListenerBlock *brlb)
+{
+  if (0 < brlb->count)
+  {
+    brlb->listener(reader, brlb->batch, brlb->count, brlb->cookie);
+    brlb->count = 0;
+  }
+}
+
+/* Append a tag read to every batch listener. Called with listenerLock held */
+static void
+notify_batch_read_listeners(TMR_Reader *reader, TMR_TagReadData *trd)
+{
+  TMR_BatchReadListenerBlock *brlb;
+  uint64_t now = 0;
+
+  for (brlb = reader->batchReadListeners; NULL != brlb; brlb = brlb->next)
+  {
+    if ((0 != brlb->maxLatencyMs) && (0 == now))
+    {
+      now = tmr_gettime_us();
+    }
+    if (0 == brlb->count)
+    {
+      brlb->due = now + (uint64_t)brlb->maxLatencyMs * 1000;
+    }
+    copy_tag_read(&brlb->batch[brlb->count++], trd);
+
+    if ((brlb->maxBatch == brlb->count) ||
+        ((0 != brlb->maxLatencyMs) && (now >= brlb->due)))
+    {
+      flush_batch(reader, brlb);
+    }
+  }
+}
+
+/**
+ * Deliver the batches whose latency budget has run out, or every
+ * pending batch if all is true.
+ */
+static void
+flush_batch_read_listeners(TMR_Reader *reader, bool all)
+{
+  TMR_BatchReadListenerBlock *brlb;
+  uint64_t now;
+
+  now = tmr_gettime_us();
+  pthread_mutex_lock(&reader->listenerLock);
+  for (brlb = reader->batchReadListeners; NULL != brlb; brlb = brlb->next)
+  {
+    if ((true == all) || ((0 != brlb->maxLatencyMs) && (now >= brlb->due)))
+    {
+      flush_batch(reader, brlb);
+    }
+  }
+  pthread_mutex_unlock(&reader->listenerLock);
+}
+
+/* When the earliest pending batch is due (tmr_gettime_us()), 0 if none is */
+static uint64_t
+next_batch_due(TMR_Reader *reader)
+{
+  TMR_BatchReadListenerBlock *brlb;
+  uint64_t due = 0;
+
+  pthread_mutex_lock(&reader->listenerLock);
+  for (brlb = reader->batchReadListeners; NULL != brlb; brlb = brlb->next)
+  {
+    if ((0 < brlb->count) && (0 != brlb->maxLatencyMs) &&
+        ((0 == due) || (brlb->due < due)))
+    {
+      due = brlb->due;
+    }
+  }
+  pthread_mutex_unlock(&reader->listenerLock);
+  return due;
+}
+
+/**
+ * Sleep for sleepMs, delivering batches as they fall due.  For the
+ * pseudo-async loop, which has no parser thread to watch the batches.
+ */
+static void
+batch_sleep(TMR_Reader *reader, uint32_t sleepMs)
+{
+  uint64_t now, end, due;
+
+  now = tmr_gettime_us();
+  end = now + (uint64_t)sleepMs * 1000;
+  while (now < end)
+  {
+    due = next_batch_due(reader);
+    if ((0 == due) || (end < due))
+    {
+      due = end;
+    }
+    if (now < due)
+    {
+      tmr_sleep((uint32_t)((due - now + 999) / 1000));
+    }
+    flush_batch_read_listeners(reader, false);
+    now = tmr_gettime_us();
+  }
+}
+#endif
+
 void
 notify_read_listeners(TMR_Reader *reader, TMR_TagReadData *trd)
 {
@@ -444,6 +772,9 @@ notify_read_listeners(TMR_Reader *reader, TMR_TagReadData *trd)
   if (NULL != reader)
   {
 #if !defined(SINGLE_THREAD_ASYNC_READ) && defined(TMR_ENABLE_BACKGROUND_READS)
+    uint64_t start;
+
+    start = tmr_gettime_us();
     pthread_mutex_lock(&reader->listenerLock);
 #endif
 	rlb = reader->readListeners;
@@ -453,7 +784,12 @@ notify_read_listeners(TMR_Reader *reader, TMR_TagReadData *trd)
       rlb = rlb->next;
     }
 #if !defined(SINGLE_THREAD_ASYNC_READ) && defined(TMR_ENABLE_BACKGROUND_READS)
+    if (NULL != reader->batchReadListeners)
+    {
+      notify_batch_read_listeners(reader, trd);
+    }
     pthread_mutex_unlock(&reader->listenerLock);
+    metrics_callback(reader, tmr_gettime_us() - start);
 #endif
   }
 }
@@ -630,46 +966,189 @@ notify_exception_listeners(TMR_Reader *reader, TMR_Status status)
 }
 
 #ifdef TMR_ENABLE_BACKGROUND_READS
-TMR_Queue_tagReads *
-dequeue(TMR_Reader *reader)
+/**
+ * Sleep until the background reader posts, or until the earliest pending
+ * batch is due. Returns false if it woke up because a batch is due.
+ */
+static bool
+parser_sleep(TMR_Reader *reader)
 {
-  TMR_Queue_tagReads *tagRead = NULL;
-  pthread_mutex_lock(&reader->queue_lock);
-  if (NULL != reader->tagQueueHead)
+  struct timespec deadline;
+  uint64_t due, now;
+
+  due = next_batch_due(reader);
+  if (0 == due)
   {
-    /* Fetch the head always */
-    tagRead = reader->tagQueueHead;
-    reader->tagQueueHead = reader->tagQueueHead->next;
+    sem_wait(&reader->queue_length);
+    return true;
   }
-  reader->queue_depth --;
-  pthread_mutex_unlock(&reader->queue_lock);
-  return(tagRead);
+
+  /**
+   * sem_timedwait() takes a CLOCK_REALTIME deadline. Only the time left
+   * is taken from that clock, so a clock step can stretch or cut this
+   * one wait but not move the batch's due time.
+   */
+  now = tmr_gettime_us();
+  due = (due > now) ? (due - now) : 0;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  due += ((uint64_t)deadline.tv_sec * 1000000) + (deadline.tv_nsec / 1000);
+  deadline.tv_sec = (time_t)(due / 1000000);
+  deadline.tv_nsec = (long)(due % 1000000) * 1000;
+  if ((0 != sem_timedwait(&reader->queue_length, &deadline)) && (ETIMEDOUT == errno))
+  {
+    return false;
+  }
+  return true;
 }
 
+/**
+ * Return the oldest queued entry, sleeping until the background reader
+ * posts one.  The entry stays owned by the parser until release_head().
+ * Returns NULL once the queue is empty if retire_parser() was called.
+ */
+static TMR_Queue_tagReads *
+acquire_head(TMR_Reader *reader)
+{
+  uint32_t head;
+  bool batchDue;
 
-void 
-enqueue(TMR_Reader *reader, TMR_Queue_tagReads *tagRead)
+  head = reader->tagQueueHead;
+  while (head == QUEUE_LOAD(&reader->tagQueueTail))
+  {
+    if (QUEUE_LOAD(&reader->parserExit))
+    {
+      return NULL;
+    }
+    /**
+     * Advertise that we are about to sleep, then look once more so that a
+     * tag posted in between is not missed. Spurious posts only cost a loop.
+     */
+    QUEUE_EXCHANGE(&reader->parserIdle, 1);
+    batchDue = false;
+    if ((head == QUEUE_LOAD(&reader->tagQueueTail)) &&
+        (0 == QUEUE_LOAD(&reader->parserExit)))
+    {
+      batchDue = (false == parser_sleep(reader));
+    }
+    QUEUE_STORE(&reader->parserIdle, 0);
+    if (true == batchDue)
+    {
+      /* Nothing more arrived within a batch listener's latency budget */
+      flush_batch_read_listeners(reader, false);
+    }
+  }
+  return &reader->tagQueue[head];
+}
+
+/* Hand the head slot back to the background reader */
+static void
+release_head(TMR_Reader *reader)
 {
-  if (NULL == reader)
+  QUEUE_STORE(&reader->tagQueueHead, queue_next(reader, reader->tagQueueHead));
+  QUEUE_FENCE();
+  if (QUEUE_EXCHANGE(&reader->readerBlocked, 0))
   {
-    return;
+    sem_post(&reader->queue_slots);
+  }
+}
+
+/**
+ * Return the slot at the tail of the queue for the background reader to
+ * fill in, sleeping while the parser has every slot in use.
+ */
+static TMR_Queue_tagReads *
+acquire_tail(TMR_Reader *reader)
+{
+  uint32_t next;
+
+  next = queue_next(reader, reader->tagQueueTail);
+  while (next == QUEUE_LOAD(&reader->tagQueueHead))
+  {
+    QUEUE_EXCHANGE(&reader->readerBlocked, 1);
+    if (next == QUEUE_LOAD(&reader->tagQueueHead))
+    {
+      sem_wait(&reader->queue_slots);
+    }
+    QUEUE_STORE(&reader->readerBlocked, 0);
   }
-  pthread_mutex_lock(&reader->queue_lock);
-  if (NULL == reader->tagQueueHead)
+  return &reader->tagQueue[reader->tagQueueTail];
+}
+
+/* Publish the tail slot to the parser, waking it only if it is idle */
+static void
+publish_tail(TMR_Reader *reader)
+{
+  QUEUE_STORE(&reader->tagQueueTail, queue_next(reader, reader->tagQueueTail));
+  QUEUE_FENCE();
+  if (QUEUE_EXCHANGE(&reader->parserIdle, 0))
   {
-    /* first tag */
-    reader->tagQueueHead = tagRead;
-    reader->tagQueueHead->next = NULL;
-    reader->tagQueueTail = reader->tagQueueHead;
+    sem_post(&reader->queue_length);
   }
-  else
+}
+
+/**
+ * Merge the reads of the same EPC still waiting behind the head entry
+ * into it, so a parser that has fallen behind catches up with one
+ * notification per tag.  Every published entry belongs to the parser,
+ * so the entries can be marked without telling the background reader.
+ */
+static void
+coalesce_tag_reads(TMR_Reader *reader, TMR_Queue_tagReads *tagRead)
+{
+  TMR_TagReadData *trd, *other;
+  uint32_t i, tail;
+
+  trd = &tagRead->trd;
+  tail = QUEUE_LOAD(&reader->tagQueueTail);
+  for (i = queue_next(reader, reader->tagQueueHead); i != tail; i = queue_next(reader, i))
+  {
+    if ((true == reader->tagQueue[i].isStatusResponse) || (true == reader->tagQueue[i].coalesced))
+    {
+      continue;
+    }
+    other = &reader->tagQueue[i].trd;
+    if ((other->tag.protocol == trd->tag.protocol) &&
+        (other->tag.epcByteCount == trd->tag.epcByteCount) &&
+        (0 == memcmp(other->tag.epc, trd->tag.epc, trd->tag.epcByteCount)))
+    {
+      trd->readCount += other->readCount;
+      if (other->rssi > trd->rssi)
+      {
+        trd->rssi = other->rssi;
+      }
+      trd->timestampLow = other->timestampLow;
+      trd->timestampHigh = other->timestampHigh;
+      trd->timestampMicros = other->timestampMicros;
+      reader->tagQueue[i].coalesced = true;
+    }
+  }
+}
+
+/**
+ * Decide whether the tag read at the head of the queue reaches the read
+ * listeners, applying /reader/read/asyncQueuePolicy on the parser side.
+ */
+static bool
+skip_tag_read(TMR_Reader *reader, TMR_Queue_tagReads *tagRead)
+{
+  if (true == tagRead->coalesced)
+  {
+    return true;
+  }
+  if (QUEUE_LOAD(&reader->tagQueueDiscardRequests) != reader->tagQueueDiscards)
+  {
+    /* The background reader found the queue full, drop the oldest read */
+    QUEUE_STORE(&reader->tagQueueDiscards, reader->tagQueueDiscards + 1);
+    TMR__metrics(reader, &reader->metricsParser)->queueDrops++;
+    return true;
+  }
+  if ((TMR_ASYNC_QUEUE_POLICY_COALESCE_EPC == reader->asyncQueuePolicy) &&
+      (TMR_READER_TYPE_SERIAL == reader->readerType) &&
+      (0 == queue_slotsFree(reader)))
   {
-    reader->tagQueueTail->next = tagRead;
-    reader->tagQueueTail = tagRead;
-    tagRead->next = NULL;
+    coalesce_tag_reads(reader, tagRead);
   }
-  reader->queue_depth ++;
-  pthread_mutex_unlock(&reader->queue_lock);
+  return false;
 }
 
 static void *
@@ -693,19 +1172,28 @@ parse_tag_reads(void *arg)
     pthread_mutex_unlock(&reader->parserLock);
 
     /**
-     * Wait until queue_length is more than zero,
-     * i.e., Queue should have atleast one tagRead to process
+     * Wait until the queue has atleast one tagRead to process
      */
-    sem_wait(&reader->queue_length);
+    tagRead = acquire_head(reader);
 
-    if (NULL != reader->tagQueueHead)
+    if (NULL != tagRead)
     {
-      /**
-       * At this point there is a tagEntry in the queue
-       * dequeue it and parse it.
-       */          
-      tagRead = dequeue(reader);
-      if (false == tagRead->isStatusResponse)
+      TMR_ReaderMetrics *metrics;
+      uint64_t lag;
+
+      metrics = TMR__metrics(reader, &reader->metricsParser);
+      lag = tmr_gettime_us() - tagRead->queuedUs;
+      metrics->parserLagTotalUs += lag;
+      if (lag > metrics->parserLagMaxUs)
+      {
+        metrics->parserLagMaxUs = (uint32_t)lag;
+      }
+
+      if ((false == tagRead->isStatusResponse) && (true == skip_tag_read(reader, tagRead)))
+      {
+        /* Dropped, or already reported with an earlier read of the same EPC */
+      }
+      else if (false == tagRead->isStatusResponse)
       {
         /* Tag Buffer stream response */
 
@@ -725,9 +1213,25 @@ parse_tag_reads(void *arg)
           /* Else it is LLRP message, parse it */
           LLRP_tSRO_ACCESS_REPORT *pReport;
           LLRP_tSTagReportData *pTagReportData;
+          uint32_t offset;
 
           pReport = (LLRP_tSRO_ACCESS_REPORT *)tagRead->tagEntry.lMsg;
 
+          /* A plain report kept as received, see TMR_LLRP_isPlainTagReport() */
+          for (offset = TMR_LLRP_nextRawTagReport(&pReport->hdr, 0);
+               0 != offset;
+               offset = TMR_LLRP_nextRawTagReport(&pReport->hdr, offset))
+          {
+            TMR_TagReadData trd;
+            TMR_TRD_init(&trd);
+            if (TMR_SUCCESS == TMR_LLRP_parseMetadataFromFrame(reader, &trd, &pReport->hdr, offset))
+            {
+              trd.reader = reader;
+              notify_read_listeners(reader, &trd);
+            }
+          }
+
+          /* Any other report is decoded by LTKC */
           for(pTagReportData = pReport->listTagReportData;
               NULL != pTagReportData;
               pTagReportData = (LLRP_tSTagReportData *)pTagReportData->hdr.pNextSubParameter)
@@ -922,21 +1426,25 @@ parse_tag_reads(void *arg)
 #endif
       }
 
-      /* Free the memory */
-      if (TMR_READER_TYPE_SERIAL == reader->readerType)
-      {
-      	free(tagRead->tagEntry.sMsg);
-      }
+      /*
+       * Free the memory, serial responses live in the queue's own buffers.
+       * The whole report, however many tags it carried, sits in one
+       * decode arena and goes back in a single call.
+       */
 #ifdef TMR_ENABLE_LLRP_READER
-      else
+      if (TMR_READER_TYPE_LLRP == reader->readerType)
       {
       	TMR_LLRP_freeMessage(tagRead->tagEntry.lMsg);
       }
 #endif
-      free(tagRead);
 
-      /* Now, increment the queue_slots as we have removed one entry */
-      sem_post(&reader->queue_slots);
+      /* Now, hand the slot back as we have finished with this entry */
+      release_head(reader);
+    }
+    else
+    {
+      /* The queue is drained and retire_parser() is waiting for us */
+      break;
     }
   }
   return NULL;
@@ -947,20 +1455,28 @@ static void
 process_async_response(TMR_Reader *reader)
 {
   TMR_Queue_tagReads *tagRead;
+  TMR_ReaderMetrics *metrics;
   uint16_t flags = 0;
+  uint32_t count;
 
   if (NULL == reader)
   {
     return;
   }
-  /* Decrement Queue slots */
-  sem_wait(&reader->queue_slots);
+  /* Claim a free slot in the queue */
+  tagRead = acquire_tail(reader);
 
-  tagRead = (TMR_Queue_tagReads *) malloc(sizeof(TMR_Queue_tagReads));
   if (TMR_READER_TYPE_SERIAL == reader->readerType)
   {
-    tagRead->tagEntry.sMsg = (uint8_t *) malloc(TMR_SR_MAX_PACKET_SIZE); /* size of bufResponse */
-    memcpy(tagRead->tagEntry.sMsg, reader->u.serialReader.bufResponse, TMR_SR_MAX_PACKET_SIZE);
+    uint16_t msgLen;
+
+    /* Copy just the received frame: SOH, length, opcode, status, data and CRC */
+    msgLen = reader->u.serialReader.bufResponse[1] + 7;
+    if (TMR_SR_MAX_PACKET_SIZE < msgLen)
+    {
+      msgLen = TMR_SR_MAX_PACKET_SIZE;
+    }
+    memcpy(tagRead->tagEntry.sMsg, reader->u.serialReader.bufResponse, msgLen);
     tagRead->bufPointer = reader->u.serialReader.bufPointer;
   }
 #ifdef TMR_ENABLE_LLRP_READER
@@ -972,6 +1488,7 @@ process_async_response(TMR_Reader *reader)
 #endif
 
   tagRead->isStatusResponse = reader->isStatusResponse;
+  tagRead->coalesced = false;
   /**
    * Process the tag results here. The stats responses will be extracted
    * later by the parser thread.
@@ -996,10 +1513,20 @@ process_async_response(TMR_Reader *reader)
     }
   }
 
-  /* Enqueue the tagRead into Queue */
-  enqueue(reader, tagRead);
-  /* Increment queue_length */
-  sem_post(&reader->queue_length);
+  /* Hand the tagRead over to the parser */
+  tagRead->queuedUs = tmr_gettime_us();
+  publish_tail(reader);
+
+  count = queue_count(reader);
+  if (count > reader->tagQueueHighWater)
+  {
+    reader->tagQueueHighWater = count;
+  }
+  metrics = TMR__metrics(reader, &reader->metricsIo);
+  if (count > metrics->queueHighWater)
+  {
+    metrics->queueHighWater = count;
+  }
 
   if ((false == reader->isStatusResponse) && (TMR_READER_TYPE_SERIAL == reader->readerType))
   {
@@ -1007,6 +1534,53 @@ process_async_response(TMR_Reader *reader)
   }
 }
 
+/**
+ * Apply /reader/read/asyncQueuePolicy to a tag response arriving while
+ * the queue is full.  Returns true if the response was dropped and must
+ * not be posted.
+ */
+static bool
+handle_queue_full(TMR_Reader *reader)
+{
+  uint32_t pending;
+
+  switch (reader->asyncQueuePolicy)
+  {
+  case TMR_ASYNC_QUEUE_POLICY_DROP_NEWEST:
+    if (TMR_READER_TYPE_SERIAL == reader->readerType)
+    {
+      reader->u.serialReader.tagsRemainingInBuffer--;
+    }
+#ifdef TMR_ENABLE_LLRP_READER
+    else
+    {
+      TMR_LLRP_freeMessage(reader->u.llrpReader.bufResponse[0]);
+      reader->u.llrpReader.bufResponse[0] = NULL;
+    }
+#endif
+    reader->tagQueueDropped++;
+    TMR__metrics(reader, &reader->metricsIo)->queueDrops++;
+    return true;
+
+  case TMR_ASYNC_QUEUE_POLICY_DROP_OLDEST:
+    /**
+     * Only the parser may retire the head entry, so ask it to discard
+     * the oldest read instead of reporting it, then wait for its slot.
+     * Never ask for more discards than there are reads queued.
+     */
+    pending = reader->tagQueueDiscardRequests - QUEUE_LOAD(&reader->tagQueueDiscards);
+    if (pending < queue_count(reader))
+    {
+      QUEUE_STORE(&reader->tagQueueDiscardRequests, reader->tagQueueDiscardRequests + 1);
+    }
+    return false;
+
+  default:
+    /* Block, or let the parser coalesce while process_async_response() waits */
+    return false;
+  }
+}
+
 static void *
 do_background_reads(void *arg)
 {
@@ -1051,6 +1625,21 @@ do_background_reads(void *arg)
       TMR_paramGet(reader, TMR_PARAM_READ_ASYNCONTIME, &onTime);
     }
 
+    if ((true == reader->continuousReading) && (false == reader->trueAsyncflag) &&
+        (false == reader->searchStatus))
+    {
+      /**
+       * TMR_stopReading() came in before the search was resubmitted,
+       * e.g. after a queue overflow, and there is no search for it to
+       * stop. Finish the read here.
+       **/
+      reader->backgroundEnabled = false;
+      reader->readState = TMR_READ_STATE_DONE;
+      pthread_cond_broadcast(&reader->readCond);
+      pthread_mutex_unlock(&reader->backgroundLock);
+      continue;
+    }
+
     if (!reader->trueAsyncflag)
     {
       reader->fetchTagReads = true;
@@ -1146,53 +1735,66 @@ do_background_reads(void *arg)
         {
           /* Got a valid message, before posting it to queue
            * check whether we have slots free in the queue or
-           * not. Validate this only for Serial reader.
+           * not. With the default policy, validate this only
+           * for Serial reader.
            */
-          if (TMR_READER_TYPE_SERIAL == reader->readerType)
+          if ((TMR_ASYNC_QUEUE_POLICY_STOP == reader->asyncQueuePolicy) &&
+              (TMR_READER_TYPE_SERIAL == reader->readerType))
           {
-            int slotsFree = 0;
-            int semret;
-            /* Get the semaphore value */
-            semret = sem_getvalue(&reader->queue_slots, &slotsFree);
-            if (0 == semret)
+            uint32_t slotsFree, slotsLow;
+
+            slotsFree = queue_slotsFree(reader);
+            slotsLow = (reader->tagQueueSlots - 1) / 2;
+            if (10 < slotsLow)
+            {
+              slotsLow = 10;
+            }
+            if (slotsLow > slotsFree)
             {
-              if (10 > slotsFree)
+              tmr_sleep(20);
+              slotsFree = queue_slotsFree(reader);
+            }
+            if (0 >= slotsFree)
+            {
+              /* In a normal case we should not come here.
+               * we are here means there is no place to
+               * store the tags. May be the read listener
+               * is not fast enough.
+               * In this case stop the read and exit.
+               */
+              pthread_mutex_lock(&reader->backgroundLock);
+              if (true == reader->searchStatus)
               {
-                tmr_sleep(20);
+                reader->isBufferOverFlow = true;
               }
-              if (0 >= slotsFree)
+              pthread_mutex_unlock(&reader->backgroundLock);
+
+              if (true == reader->isBufferOverFlow)
               {
-                /* In a normal case we should not come here.
-                 * we are here means there is no place to
-                 * store the tags. May be the read listener
-                 * is not fast enough.
-                 * In this case stop the read and exit.
-                 */
-                if (true == reader->searchStatus)
+                ret = TMR_ERROR_BUFFER_OVERFLOW;
+                notify_exception_listeners(reader, ret);
+                ret = verifySearchStatus(reader);
+                /* Waiting till all slots are free */
+                while (0 < queue_count(reader))
                 {
-                  isBufferOverFlow = true;
-                  ret = TMR_ERROR_BUFFER_OVERFLOW;
-                  notify_exception_listeners(reader, ret);
-                  ret = verifySearchStatus(reader);
-                  /*isBufferOverFlow = false;
-                  pthread_mutex_lock(&reader->backgroundLock);
-                  reader->backgroundEnabled = false;
-                  reader->readState = TMR_READ_STATE_DONE;
-                  pthread_cond_broadcast(&reader->readCond);
-                  pthread_mutex_unlock(&reader->backgroundLock);
-                  reader->searchStatus = false;*/
-				  /* Waiting till all slots are free */
-				  while(slotsFree < TMR_MAX_QUEUE_SLOTS)
-				  {
-					  tmr_sleep(20);
-					  semret = sem_getvalue(&reader->queue_slots, &slotsFree);
-				  }
-				  reader->trueAsyncflag = false;
-                  break;
+                  tmr_sleep(20);
                 }
+
+                /* Resubmit the search */
+                pthread_mutex_lock(&reader->backgroundLock);
+                reader->isBufferOverFlow = false;
+                pthread_mutex_unlock(&reader->backgroundLock);
+                reader->trueAsyncflag = false;
+                break;
               }
             }
           }
+          else if ((false == reader->isStatusResponse) && (0 == queue_slotsFree(reader)) &&
+                   (true == handle_queue_full(reader)))
+          {
+            /* Dropped under /reader/read/asyncQueuePolicy, keep reading */
+            continue;
+          }
 
           /* There is place to store the response. Post it */
           process_async_response(reader);
@@ -1221,6 +1823,7 @@ do_background_reads(void *arg)
              * Stop read is not called. Resubmit the search immediately, without user interaction
              * Resetting the trueAsyncFlag will send the continuous read command again.
              */
+            TMR__metrics(reader, &reader->metricsIo)->bufferFullResubmits++;
 
             ret = TMR_hasMoreTags(reader);
             reader->trueAsyncflag = false;
@@ -1271,10 +1874,10 @@ do_background_reads(void *arg)
           }
           else if (TMR_ERROR_END_OF_READING == ret)
           {
-            while(0 < reader->queue_depth)
+            while(0 < queue_count(reader))
             {
               /**
-               * reader->queue_depth is greater than zero. i.e.,
+               * queue_count() is greater than zero. i.e.,
                * there are still some tags left in queue.
                * Give some time for the parser to parse all of them.
                * 5 ms sleep shouldn't cause much delay.
@@ -1316,7 +1919,6 @@ do_background_reads(void *arg)
       while (TMR_SUCCESS == TMR_hasMoreTags(reader))
       {
         TMR_TagReadData trd;
-        TMR_ReadListenerBlock *rlb;
 
         TMR_TRD_init(&trd);
 
@@ -1330,16 +1932,12 @@ do_background_reads(void *arg)
           break;
         }
 
-        pthread_mutex_lock(&reader->listenerLock);
-        rlb = reader->readListeners;
-        while (rlb)
-        { 
-          rlb->listener(reader, &trd, rlb->cookie);
-          rlb = rlb->next;
-        }
-        pthread_mutex_unlock(&reader->listenerLock);
+        notify_read_listeners(reader, &trd);
       }
 
+      /* No parser thread here, deliver the batches that are due */
+      flush_batch_read_listeners(reader, false);
+
       /* Calculate and accumulate time spent in fetching tags */
       now = tmr_gettime();
       difftime = now - end;
@@ -1353,7 +1951,7 @@ do_background_reads(void *arg)
         /* Wait for the asyncOffTime duration to pass */
         if(sleepTime > 0)
         {
-          tmr_sleep(sleepTime);
+          batch_sleep(reader, sleepTime);
         }
       }
       else
@@ -1429,6 +2027,75 @@ TMR_removeReadListener(TMR_Reader *reader, TMR_ReadListenerBlock *b)
   return TMR_SUCCESS;
 }
 
+TMR_Status
+TMR_addBatchReadListener(TMR_Reader *reader, TMR_BatchReadListenerBlock *b,
+                         uint32_t maxBatch, uint32_t maxLatencyMs)
+{
+  if ((NULL == reader) || (NULL == b) || (0 == maxBatch))
+  {
+    return TMR_ERROR_INVALID;
+  }
+  b->batch = malloc(maxBatch * sizeof(TMR_TagReadData));
+  if (NULL == b->batch)
+  {
+    return TMR_ERROR_OUT_OF_MEMORY;
+  }
+  b->maxBatch = maxBatch;
+  b->maxLatencyMs = maxLatencyMs;
+  b->count = 0;
+  b->due = 0;
+
+  if (0 != pthread_mutex_lock(&reader->listenerLock))
+  {
+    free(b->batch);
+    b->batch = NULL;
+    return TMR_ERROR_TRYAGAIN;
+  }
+  b->next = reader->batchReadListeners;
+  reader->batchReadListeners = b;
+  pthread_mutex_unlock(&reader->listenerLock);
+
+  return TMR_SUCCESS;
+}
+
+TMR_Status
+TMR_removeBatchReadListener(TMR_Reader *reader, TMR_BatchReadListenerBlock *b)
+{
+  TMR_BatchReadListenerBlock *block, **prev;
+
+  if (NULL == reader)
+  {
+    return TMR_ERROR_INVALID;
+  }
+  if (0 != pthread_mutex_lock(&reader->listenerLock))
+    return TMR_ERROR_TRYAGAIN;
+
+  prev = &reader->batchReadListeners;
+  block = reader->batchReadListeners;
+  while (NULL != block)
+  {
+    if (block == b)
+    {
+      *prev = block->next;
+      flush_batch(reader, block);
+      break;
+    }
+    prev = &block->next;
+    block = block->next;
+  }
+
+  pthread_mutex_unlock(&reader->listenerLock);
+
+  if (block == NULL)
+  {
+    return TMR_ERROR_INVALID;
+  }
+
+  free(b->batch);
+  b->batch = NULL;
+  return TMR_SUCCESS;
+}
+
 
 TMR_Status
 TMR_addAuthReqListener(TMR_Reader *reader, TMR_AuthReqListenerBlock *b)
@@ -1653,12 +2320,31 @@ cleanup_background_threads(TMR_Reader *reader)
     pthread_mutex_lock(&reader->parserLock);
     pthread_mutex_lock(&reader->listenerLock);
     reader->readListeners = NULL;
+    while (NULL != reader->batchReadListeners)
+    {
+      free(reader->batchReadListeners->batch);
+      reader->batchReadListeners->batch = NULL;
+      reader->batchReadListeners = reader->batchReadListeners->next;
+    }
     if (true == reader->parserSetup)
     {
       pthread_cancel(reader->backgroundParser);
     }
     pthread_mutex_unlock(&reader->listenerLock);
     pthread_mutex_unlock(&reader->parserLock);
+
+    if (true == reader->parserSetup)
+    {
+      /**
+       * Wait for the parser to exit before releasing the
+       * queue it may still be working on
+       **/
+      pthread_join(reader->backgroundParser, NULL);
+      sem_destroy(&reader->queue_length);
+      sem_destroy(&reader->queue_slots);
+      free_tag_queue(reader);
+      reader->parserSetup = false;
+    }
   }
 }
 
@@ -0,0 +1,57 @@
+#ifndef _TMR_CRC_H
+#define _TMR_CRC_H
+
+/**
+ *  @file tmr_crc.h
+ *  @brief Mercury API - serial message CRC
+ *
+ *  The standalone autoread package (autoread-x.y.z/c/src) does not link
+ *  against this API and carries its own copy of this file. Keep the two
+ *  byte-identical.
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifdef WINCE
+#include <stdint_win32.h>
+#else
+#include <stdint.h>
+#endif
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compute the CRC carried at the end of every serial message.
+ *
+ * @param u8Buf The message, starting at the length byte (the SOF byte is not covered)
+ * @param len The number of bytes to cover
+ */
+uint16_t tm_crc(const uint8_t *u8Buf, uint32_t len);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* _TMR_CRC_H */
@@ -46,6 +46,8 @@ extern "C" {
 #define TMR_LLRP_SYNC_MAX_ROSPECS 256  
 #define TMR_LLRP_MAX_RFMODE_ENTRIES 7
 #define TMR_LLRP_READER_DEFAULT_PORT 5084
+/* Batch entries whose settings can share one SET_READER_CONFIG */
+#define TMR_LLRP_BATCH_CONFIG_OPS 32
 
 /**
  * This structure is returned from cmdGetRFControl
@@ -175,6 +177,28 @@ typedef struct TMR_LLRP_LlrpReader
   llrp_u32_t                  roSpecId, accessSpecId;
   llrp_u16_t                  opSpecId;
 
+  /**
+   * ROSpec left installed and enabled on the reader by the last sync
+   * read, kept as its encoded ADD_ROSPEC frame. A later sync read whose
+   * ADD_ROSPEC encodes identically only sends START_ROSPEC.
+   */
+  bool roSpecCached;
+  llrp_u32_t cachedROSpecId;
+  uint8_t *cachedROSpec;
+  uint32_t cachedROSpecLength;
+  /** Set while TMR_LLRP_read builds a ROSpec that may be reused */
+  bool roSpecReuseAllowed;
+  /** Set by TMR_LLRP_cmdAddROSpec when the cached ROSpec matched */
+  bool roSpecReused;
+  /**
+   * The SET_READER_CONFIG messages of a TMR_paramSetMany() batch,
+   * merged into one until something else has to be sent, and the
+   * batch entries they were sent for.
+   */
+  LLRP_tSSET_READER_CONFIG *batchConfig;
+  uint32_t batchConfigOps[TMR_LLRP_BATCH_CONFIG_OPS];
+  uint8_t batchConfigOpCount;
+
   TMR_AntennaMapList *txRxMap;
   uint32_t transportTimeout;
   uint32_t commandTimeout;
@@ -210,13 +234,17 @@ typedef struct TMR_LLRP_LlrpReader
 
   /* Array of LLRP_tSMessage pointers holding the tag read responses */
   LLRP_tSMessage **bufResponse;
+  /* Number of slots in bufResponse, kept across reads */
+  uint32_t bufSize;
 
-  /* bufResponse read index */
-  uint8_t bufPointer;
-  uint8_t bufIndex;
+  /* bufResponse write and read index */
+  uint32_t bufPointer;
+  uint32_t bufIndex;
 
   /* Pointer to buffer holding the tag read data */
   LLRP_tSTagReportData *pTagReportData;
+  /* Or offset of the tag read data in a raw report, 0 if none */
+  uint32_t rawTagOffset;
 
   int searchTimeoutMs;
 
@@ -255,6 +283,13 @@ typedef struct TMR_LLRP_LlrpReader
   bool isResponsePending;
   /** To cancel the receiver thread */
   bool threadCancel;
+#if !defined(WIN32) && !defined(WINCE)
+  /**
+   * Self-pipe used to wake the receiver thread out of poll() when it
+   * is disabled or cancelled. Both ends are -1 when not open.
+   */
+  int receiverWake[2];
+#endif
   /* To hold the No.of Keep alives missed count*/
   uint8_t keepAliveAckMissCnt;
   TMMP_Reader_FeaturesFlag featureFlags;
@@ -279,6 +279,8 @@ isParamWritable(TMR_Param key)
   case TMR_PARAM_VERSION_SERIAL:
   case TMR_PARAM_ANTENNA_RETURNLOSS:
   case TMR_PARAM_CURRENTTIME:
+  case TMR_PARAM_READ_ASYNC_QUEUE_HIGHWATER:
+  case TMR_PARAM_READ_ASYNC_QUEUE_DROPS:
     /* Following parameters are not read only in Mercury API, but we decided
      * not to support them as part for LoadSaveConfiguration. Hence adding them as
      * read only parameters. */
@@ -286,6 +288,11 @@ isParamWritable(TMR_Param key)
   case TMR_PARAM_READER_STATS:
   case TMR_PARAM_USER_CONFIG:
   case TMR_PARAM_READER_STATISTICS:
+  case TMR_PARAM_READER_METRICS:
+  case TMR_PARAM_READER_TIMESTAMP_DRIFT:
+  case TMR_PARAM_PARAM_CACHE_HITS:
+  case TMR_PARAM_PARAM_CACHE_MISSES:
+  case TMR_PARAM_SESSION_RESUMED:
   case TMR_PARAM_REGION_LBT_ENABLE:
   case TMR_PARAM_REGION_LBT_THRESHOLD:
   case TMR_PARAM_REGION_DWELL_TIME:
@@ -310,6 +317,12 @@ isParamWritable(TMR_Param key)
   case TMR_PARAM_REGULATORY_ENABLE:
   case TMR_PARAM_REGION_MINIMUM_FREQUENCY:
   case TMR_PARAM_REGION_QUANTIZATION_STEP:
+  case TMR_PARAM_READ_ASYNC_QUEUE_DEPTH:
+  case TMR_PARAM_READ_ASYNC_QUEUE_POLICY:
+  case TMR_PARAM_TRANSPORT_TRACE_RAW:
+  case TMR_PARAM_PARAM_CACHE_ENABLE:
+  case TMR_PARAM_SESSION_FILE:
+  case TMR_PARAM_SESSION_RECORD:
     {
       ret = TMR_ERROR_READONLY;
       break;
@@ -133,6 +133,19 @@ static const char *paramNames[1 + TMR_PARAM_MAX] = {
   "/reader/regulatory/onTime", /* TMR_PARAM_REGULATORY_ONTIME */
   "/reader/regulatory/offTime", /* TMR_PARAM_REGULATORY_OFFTIME, */
   "/reader/regulatory/enable", /* TMR_PARAM_REGULATORY_ENABLE */
+  "/reader/read/asyncQueueDepth", /* TMR_PARAM_READ_ASYNC_QUEUE_DEPTH */
+  "/reader/read/asyncQueuePolicy", /* TMR_PARAM_READ_ASYNC_QUEUE_POLICY */
+  "/reader/read/asyncQueueHighWater", /* TMR_PARAM_READ_ASYNC_QUEUE_HIGHWATER */
+  "/reader/read/asyncQueueDrops", /* TMR_PARAM_READ_ASYNC_QUEUE_DROPS */
+  "/reader/transportTraceRaw", /* TMR_PARAM_TRANSPORT_TRACE_RAW */
+  "/reader/metrics", /* TMR_PARAM_READER_METRICS */
+  "/reader/timestampDrift", /* TMR_PARAM_READER_TIMESTAMP_DRIFT */
+  "/reader/paramCache/enable", /* TMR_PARAM_PARAM_CACHE_ENABLE */
+  "/reader/paramCache/hits", /* TMR_PARAM_PARAM_CACHE_HITS */
+  "/reader/paramCache/misses", /* TMR_PARAM_PARAM_CACHE_MISSES */
+  "/reader/session/file", /* TMR_PARAM_SESSION_FILE */
+  "/reader/session/record", /* TMR_PARAM_SESSION_RECORD */
+  "/reader/session/resumed", /* TMR_PARAM_SESSION_RESUMED */
 };
 
 
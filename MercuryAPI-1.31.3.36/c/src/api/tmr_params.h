@@ -239,6 +239,32 @@ typedef enum TMR_Param
   TMR_PARAM_REGULATORY_OFFTIME,
   /** "/reader/regulatory/enable", bool */
   TMR_PARAM_REGULATORY_ENABLE,
+  /** "/reader/read/asyncQueueDepth", uint32_t */
+  TMR_PARAM_READ_ASYNC_QUEUE_DEPTH,
+  /** "/reader/read/asyncQueuePolicy", TMR_AsyncQueuePolicy */
+  TMR_PARAM_READ_ASYNC_QUEUE_POLICY,
+  /** "/reader/read/asyncQueueHighWater", uint32_t */
+  TMR_PARAM_READ_ASYNC_QUEUE_HIGHWATER,
+  /** "/reader/read/asyncQueueDrops", uint32_t */
+  TMR_PARAM_READ_ASYNC_QUEUE_DROPS,
+  /** "/reader/transportTraceRaw", bool */
+  TMR_PARAM_TRANSPORT_TRACE_RAW,
+  /** "/reader/metrics", TMR_ReaderMetrics */
+  TMR_PARAM_READER_METRICS,
+  /** "/reader/timestampDrift", int32_t, parts per billion the host clock gains on the module's tag timestamps */
+  TMR_PARAM_READER_TIMESTAMP_DRIFT,
+  /** "/reader/paramCache/enable", bool */
+  TMR_PARAM_PARAM_CACHE_ENABLE,
+  /** "/reader/paramCache/hits", uint32_t */
+  TMR_PARAM_PARAM_CACHE_HITS,
+  /** "/reader/paramCache/misses", uint32_t */
+  TMR_PARAM_PARAM_CACHE_MISSES,
+  /** "/reader/session/file", TMR_String */
+  TMR_PARAM_SESSION_FILE,
+  /** "/reader/session/record", TMR_SR_SessionRecord */
+  TMR_PARAM_SESSION_RECORD,
+  /** "/reader/session/resumed", bool */
+  TMR_PARAM_SESSION_RESUMED,
   TMR_PARAM_END,
   TMR_PARAM_MAX = TMR_PARAM_END-1,
 
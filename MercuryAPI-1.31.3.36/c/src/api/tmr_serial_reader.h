@@ -211,6 +211,107 @@ typedef enum TMR_TransportType
   TMR_SR_MSG_SOURCE_UNKNOWN = 0x0004,
 }TMR_TransportType;
 
+/**
+ * Estimate of how fast the module's timestamp clock runs against the
+ * host's, from the tag frames of a continuous read. In every window the
+ * smallest difference between a frame's arrival and the module's own
+ * timestamp for it is kept; that minimum is the least delayed frame and
+ * follows the drift, while the larger differences are transport delay.
+ */
+typedef struct TMR_SR_ClockDrift
+{
+  /* Host time the correction is applied from */
+  uint64_t streamStartUs;
+  /* Start of the current window and its smallest arrival - timestamp */
+  uint64_t windowStartUs;
+  int64_t windowMin;
+  /* First complete window, the reference the drift is measured against */
+  bool refValid;
+  uint64_t refUs;
+  int64_t refResidual;
+  /* Rate the host clock gains on the module's, parts per billion */
+  int32_t ppb;
+} TMR_SR_ClockDrift;
+
+#define TMR_SR_PARAM_CACHE_STRING 64
+#define TMR_SR_PARAM_CACHE_LIST 32
+
+/**
+ * Settings commands of a parameter batch that have been sent but
+ * whose responses have not been read yet, oldest at head.
+ */
+typedef struct TMR_SR_Pipeline
+{
+  uint8_t head;
+  uint8_t count;
+  struct
+  {
+    uint8_t opcode;
+    /* Batch entry the command was sent for */
+    uint32_t op;
+    uint32_t timeoutMs;
+  } pending[TMR_SR_PIPELINE_DEPTH];
+} TMR_SR_Pipeline;
+
+/**
+ * Values of parameters that only change when the module reboots or
+ * the parameter (or one it depends on) is set, kept so that repeated
+ * gets don't each cost a round trip. Which ones are held is recorded
+ * in TMR_SR_SerialReader.paramCached.
+ */
+typedef struct TMR_SR_ParamCache
+{
+  /* Answer gets from here */
+  bool enable;
+  /* Gets answered from here, and cacheable gets sent to the module */
+  uint32_t hits;
+  uint32_t misses;
+  char serial[TMR_SR_PARAM_CACHE_STRING];
+  TMR_Region regions[TMR_SR_PARAM_CACHE_LIST];
+  uint8_t regionCount;
+  TMR_TagProtocol protocols[TMR_SR_PARAM_CACHE_LIST];
+  uint8_t protocolCount;
+  int16_t powerMax;
+  int16_t powerMin;
+  uint16_t productGroupId;
+  uint16_t productId;
+} TMR_SR_ParamCache;
+
+#define TMR_SR_SESSION_MAGIC 0x544D5331
+#define TMR_SR_SESSION_PATH 256
+
+/**
+ * What connecting learned about a module that does not change until
+ * its firmware does: the value of @c /reader/session/record, and the
+ * contents of @c /reader/session/file, which builds without
+ * TMR_ENABLE_STDIO do not have.
+ *
+ * A connect to the same URI starts probing at the recorded baud rate,
+ * and when the module reports the recorded version and serial number,
+ * takes the rest from here instead of querying it.  Treat it as
+ * opaque; it is only meaningful to the same build of the API.
+ */
+typedef struct TMR_SR_SessionRecord
+{
+  /** TMR_SR_SESSION_MAGIC if the record holds a session */
+  uint32_t magic;
+  /** sizeof(TMR_SR_SessionRecord), to reject records of other builds */
+  uint32_t size;
+  /** Reader URI the session was with */
+  char uri[TMR_MAX_READER_NAME_LENGTH];
+  /** Module serial number, empty if the module has none */
+  char serial[TMR_SR_PARAM_CACHE_STRING];
+  /** Rate the module last answered at */
+  uint32_t baudRate;
+  TMR_SR_VersionInfo versionInfo;
+  uint16_t productId;
+  TMR_TransportType transportType;
+  /** Antenna ports the module reported, and which had an antenna */
+  uint8_t portCount;
+  uint8_t ports[TMR_SR_MAX_ANTENNA_PORTS];
+  bool detected[TMR_SR_MAX_ANTENNA_PORTS];
+} TMR_SR_SessionRecord;
+
 /**
  * The serial reader structure.
  */
@@ -229,6 +330,8 @@ typedef struct TM_SR_SerialReader
 
   /* User-configurable values */
   uint32_t baudRate;
+  /* Rate the module last answered at, the first one the next probe tries */
+  uint32_t lastGoodBaudRate;
   TMR_AntennaMapList *txRxMap;
   TMR_AntennaMapList *defaultTxRxMap;
   TMR_GEN2_Password gen2AccessPassword;
@@ -245,6 +348,16 @@ typedef struct TM_SR_SerialReader
 
   /* Option to enable or disable the pre-amble */
   bool supportsPreamble;
+  /* Whether the last command went out without it */
+  bool preambleSkipped;
+  /* Idle time after which the module may be asleep, microseconds */
+  uint32_t preambleIdleUs;
+  /* Host monotonic time until which the preamble is sent regardless */
+  uint64_t preambleForcedUntilUs;
+  /* Length of the last such period, milliseconds; zero when none is due */
+  uint32_t preambleBackoffMs;
+  /* Host monotonic time the module last sent a frame, zero if unknown */
+  uint64_t lastExchangeUs;
 
   /* Cache extendedEPC setting */
   bool extendedEPC;
@@ -262,10 +375,31 @@ typedef struct TM_SR_SerialReader
    * stores whether each parameter is present or not.
    */
   uint32_t paramPresent[TMR_PARAMWORDS];
+  /* Large bitmask that stores whether each parameter's value is
+   * held in paramCache.
+   */
+  uint32_t paramCached[TMR_PARAMWORDS];
+  TMR_SR_ParamCache paramCache;
+  TMR_SR_Pipeline pipeline;
+
+  /* Session record, loaded before connecting and kept after */
+  TMR_SR_SessionRecord session;
+  /* Keep a record at all: a record or file has been set */
+  bool sessionEnable;
+  /* Whether the last boot took its discovery from the record */
+  bool sessionResumed;
+  char sessionFile[TMR_SR_SESSION_PATH];
 
   /* Temporary storage during a read and subsequent fetch of tags */
-  uint32_t readTimeLow, readTimeHigh, elapsedTime;
-  uint32_t lastSentTagTimestampHigh, lastSentTagTimestampLow;
+  /* Host monotonic time module timestamps count from, and of the last
+   * tag reported, in microseconds */
+  uint64_t timeBaseUs, lastSentTagUs;
+  /* Arrival of the tag frame being parsed, zero outside continuous reading */
+  uint64_t rxUs;
+  /* Wall clock minus monotonic clock when the read started */
+  int64_t wallOffsetUs;
+  uint32_t elapsedTime;
+  TMR_SR_ClockDrift clockDrift;
   uint32_t searchTimeoutMs;
   
   /* Number of tags reported by module read command.
@@ -106,6 +106,11 @@ struct TMR_SR_SerialTransport
    * message. If the operation takes longer than timeoutMs to receive
    * length bytes, TMR_ERROR_TIMEOUT should be returned.
    *
+   * timeoutMs bounds the whole call, however many reads it takes to
+   * collect length bytes. The caller works to a deadline of its own
+   * and passes only the time left until it, so a timeout must not be
+   * restarted as bytes trickle in.
+   *
    * @param this The TMR_SR_SerialTransport structure.
    * @param length The number of bytes to receive.
    * @param[out] messageLength The number of bytes received.
@@ -152,6 +157,20 @@ typedef struct TMR_SR_SerialPortNativeContext
   PLATFORM_HANDLE handle;
   /** The filesystem name of the serial device */
   char devicename[TMR_MAX_READER_NAME_LENGTH];
+#if TMR_SR_READAHEAD_SIZE > 0
+  /** Bytes read from the device but not yet returned by receiveBytes */
+  uint8_t rxBuf[TMR_SR_READAHEAD_SIZE];
+  /** Offset of the next unconsumed byte in rxBuf */
+  uint16_t rxPos;
+  /** Number of valid bytes in rxBuf */
+  uint16_t rxLen;
+#endif
+  /** TCP only: how long a connect may take, in milliseconds */
+  uint32_t connectTimeoutMs;
+  /** TCP only: set a lost connection up again */
+  bool reconnect;
+  /** TCP only: host time before which not to try that, microseconds */
+  uint64_t reconnectUs;
 } TMR_SR_SerialPortNativeContext;
 #endif
 
@@ -194,12 +213,76 @@ __declspec(dllexport)
 TMR_Status TMR_SR_SerialTransportNativeInit(TMR_SR_SerialTransport *transport,
                                             TMR_SR_SerialPortNativeContext *context,
                                             const char *device);
+/**
+ * Initialize a TMR_SR_SerialTransport structure that talks to a module
+ * behind a serial-to-TCP bridge. Register it with
+ * TMR_setSerialTransport(), e.g. as "tcp" for URIs like
+ * @c tcp://10.0.0.5:4001, optionally followed by settings:
+ *
+ *   timeout    How long connecting may take, in milliseconds
+ *              (TMR_SR_TCP_CONNECT_TIMEOUT_MS)
+ *   reconnect  1 to set a lost connection up again. The exchange
+ *              that found it lost fails, later ones and a continuous
+ *              read carry on over the new connection. Reconnecting
+ *              stays within each call's timeout. With 0, a lost
+ *              connection is closed and later exchanges fail (0)
+ *
+ * e.g. @c tcp://10.0.0.5:4001?timeout=2000&reconnect=1. The Windows
+ * transport ignores the settings.
+ *
+ * @param transport The TMR_SR_SerialTransport structure to initialize.
+ * @param context A TMR_SR_SerialPortNativeContext structure for the callbacks to use.
+ * @param device The host and port, and the settings after a '?'
+ */
 #if defined(WIN32) || defined(WINCE)
 __declspec(dllexport)
 #endif
 TMR_Status TMR_SR_SerialTransportTcpNativeInit(TMR_SR_SerialTransport *transport,
                                             TMR_SR_SerialPortNativeContext *context,
                                             const char *device);
+
+/**
+ * Initialize a TMR_SR_SerialTransport structure that talks to a module
+ * on a serial port and records every exchange, with its timing, to a
+ * capture file. Register it with TMR_setSerialTransport(), e.g. as
+ * "record" for URIs like @c record:///dev/ttyUSB0?/tmp/capture.trc
+ *
+ * @param transport The TMR_SR_SerialTransport structure to initialize.
+ * @param context A TMR_SR_SerialPortNativeContext structure for the serial port.
+ * @param device The serial device and the capture file, separated by '?'
+ */
+TMR_Status TMR_SR_SerialTransportRecordInit(TMR_SR_SerialTransport *transport,
+                                            TMR_SR_SerialPortNativeContext *context,
+                                            const char *device);
+
+/**
+ * Initialize a TMR_SR_SerialTransport structure that plays a capture
+ * made by TMR_SR_SerialTransportRecordInit() back in place of a module,
+ * at the recorded pace or, with the "fast" option, as fast as it is
+ * read. Register it with TMR_setSerialTransport(), e.g. as "replay"
+ * for URIs like @c replay:///tmp/capture.trc?fast
+ *
+ * @param transport The TMR_SR_SerialTransport structure to initialize.
+ * @param context Unused.
+ * @param device The capture file, optionally followed by "?fast"
+ */
+TMR_Status TMR_SR_SerialTransportReplayInit(TMR_SR_SerialTransport *transport,
+                                            TMR_SR_SerialPortNativeContext *context,
+                                            const char *device);
+
+/**
+ * Initialize a TMR_SR_SerialTransport structure that emulates an M6e
+ * module reading a synthetic tag population, for load testing without
+ * hardware. Register it with TMR_setSerialTransport(), e.g. as "sim"
+ * for URIs like @c sim:///?tags=5000&rate=50000
+ *
+ * @param transport The TMR_SR_SerialTransport structure to initialize.
+ * @param context Unused.
+ * @param device The simulator settings as "name=value" pairs after a '?'
+ */
+TMR_Status TMR_SR_SerialTransportSimInit(TMR_SR_SerialTransport *transport,
+                                         TMR_SR_SerialPortNativeContext *context,
+                                         const char *device);
 #endif /* TMR_ENABLE_SERIAL_TRANSPORT_NATIVE */
 
 #ifdef TMR_ENABLE_SERIAL_TRANSPORT_LLRP
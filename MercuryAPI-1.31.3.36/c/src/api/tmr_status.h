@@ -213,6 +213,7 @@ typedef uint32_t TMR_Status;
 #define TMR_ERROR_TIMESTAMP_NULL  TMR_ERROR_MISC(21)
 #define TMR_ERROR_METADATA_PROTOCOLMISSING     TMR_ERROR_MISC(22)
 #define TMR_ERROR_INVALID_VALUE  TMR_ERROR_MISC(23)
+#define TMR_ERROR_BATCH_ABORTED  TMR_ERROR_MISC(24)
 
 /* LLRP related errors */
 #define TMR_ERROR_LLRP_SPECIFIC(x)            TMR_STATUS_MAKE(TMR_ERROR_TYPE_LLRP, (x))
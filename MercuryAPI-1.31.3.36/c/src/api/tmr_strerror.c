@@ -275,6 +275,8 @@ TMR_strerr(TMR_Reader *reader, TMR_Status status)
     return "Timestamp cannot be null";
   case TMR_ERROR_METADATA_PROTOCOLMISSING:
     return "Invalid argument in /reader/metadata. TMR_TRD_METADATA_FLAG_PROTOCOL is a mandatory parameter.";
+  case TMR_ERROR_BATCH_ABORTED:
+    return "Not applied, another parameter of the batch failed";
 
   default:
     {
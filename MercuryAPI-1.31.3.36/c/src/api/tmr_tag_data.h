@@ -190,6 +190,19 @@ typedef struct TMR_TagReadData
 #endif 
   /** Reader instance, to keep track of tag reads */
   TMR_Reader *reader;
+  /**
+   * Time of the read on the host's monotonic clock, in microseconds
+   * (see tmr_gettime_us()). Never decreases within one read and, unlike
+   * timestampLow/High, is not affected by changes to the wall clock.
+   * Zero when the reader does not provide it.
+   *
+   * The unit is not the resolution. Serial modules timestamp tags in
+   * whole milliseconds from the start of the search, so for serial
+   * readers the value is the host's microsecond time base plus a
+   * millisecond count. Reads within the same millisecond share one
+   * value, apart from any clock-drift correction.
+   */
+  uint64_t timestampMicros;
 } TMR_TagReadData;
 
 TMR_Status TMR_TRD_init(TMR_TagReadData *trd);
@@ -152,6 +152,29 @@ tm_time_subtract(uint32_t end, uint32_t start)
     return (UINT32_MAX - start) + end;
 }
 
+/* Absolute deadline timeoutMs from now, on the tmr_gettime_us() clock */
+uint64_t
+tm_deadline_us(uint32_t timeoutMs)
+{
+  return tmr_gettime_us() + (uint64_t)timeoutMs * 1000;
+}
+
+/* Time left until deadlineUs, in milliseconds rounded up so that a
+ * wait is never cut short; zero once the deadline has passed.
+ */
+uint32_t
+tm_remaining_ms(uint64_t deadlineUs)
+{
+  uint64_t now;
+
+  now = tmr_gettime_us();
+  if (now >= deadlineUs)
+  {
+    return 0;
+  }
+  return (uint32_t)((deadlineUs - now + 999) / 1000);
+}
+
 /** Minimum number of bytes required to hold a given number of bits.
  *
  * @param bitCount  number of bits to hold
@@ -143,6 +143,8 @@ int tm_strcasecmp(const char *s1, const char *s2);
 
 void tm_gettime_consistent(uint32_t *high, uint32_t *low);
 uint32_t tm_time_subtract(uint32_t end, uint32_t start);
+uint64_t tm_deadline_us(uint32_t timeoutMs);
+uint32_t tm_remaining_ms(uint64_t deadlineUs);
 int tm_u8s_per_bits(int bitCount);
 void TMR_stringCopy(TMR_String *dest, const char *src, int len);
 uint64_t TMR_makeBitMask(int offset, int length);
@@ -0,0 +1,215 @@
+/**
+ *  @file bench.c
+ *  @brief Mercury API - shared helpers of the throughput benchmarks
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "tm_config.h"
+#include "bench.h"
+
+/*
+ * The benchmarks are linked with -Wl,--wrap=malloc,--wrap=calloc,
+ * --wrap=realloc, so every allocation the API and LTKC make goes
+ * through here and is counted. Allocations inside the C library
+ * itself are not seen.
+ */
+static volatile uint64_t allocations;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *
+__wrap_malloc(size_t size)
+{
+  __sync_fetch_and_add(&allocations, 1);
+  return __real_malloc(size);
+}
+
+void *
+__wrap_calloc(size_t count, size_t size)
+{
+  __sync_fetch_and_add(&allocations, 1);
+  return __real_calloc(count, size);
+}
+
+void *
+__wrap_realloc(void *ptr, size_t size)
+{
+  __sync_fetch_and_add(&allocations, 1);
+  return __real_realloc(ptr, size);
+}
+
+uint64_t
+bench_allocations(void)
+{
+  return __sync_fetch_and_add(&allocations, 0);
+}
+
+static uint64_t
+clockUs(clockid_t id)
+{
+  struct timespec ts;
+
+  clock_gettime(id, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+uint64_t
+bench_nowUs(void)
+{
+  return clockUs(CLOCK_MONOTONIC);
+}
+
+uint64_t
+bench_threadCpuUs(void)
+{
+  return clockUs(CLOCK_THREAD_CPUTIME_ID);
+}
+
+uint64_t
+bench_processCpuUs(void)
+{
+  struct rusage ru;
+
+  getrusage(RUSAGE_SELF, &ru);
+  return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000
+    + (uint64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+}
+
+int
+bench_initResult(BenchResult *result, const char *bench, uint32_t maxSamples)
+{
+  memset(result, 0, sizeof(*result));
+  result->bench = bench;
+  result->latencyMax = maxSamples;
+  result->latencyUs = malloc(maxSamples * sizeof(*result->latencyUs));
+  return (NULL == result->latencyUs) ? -1 : 0;
+}
+
+void
+bench_resetResult(BenchResult *result)
+{
+  result->scenario[0] = '\0';
+  result->settings[0] = '\0';
+  result->elapsedUs = 0;
+  result->tags = 0;
+  result->allocs = 0;
+  result->cpuUs = 0;
+  result->sourceCpuUs = 0;
+  result->latencyCount = 0;
+}
+
+void
+bench_addLatency(BenchResult *result, uint64_t us)
+{
+  if (result->latencyCount < result->latencyMax)
+  {
+    result->latencyUs[result->latencyCount++] = (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+  }
+}
+
+static int
+compareLatency(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+/** Nearest-rank percentile of the sorted latencies, in thousandths */
+static uint32_t
+percentile(const BenchResult *result, uint32_t permille)
+{
+  uint64_t rank;
+
+  if (0 == result->latencyCount)
+  {
+    return 0;
+  }
+  rank = ((uint64_t)result->latencyCount * permille + 999) / 1000;
+  if (0 == rank)
+  {
+    rank = 1;
+  }
+  return result->latencyUs[rank - 1];
+}
+
+static void
+printString(FILE *out, const char *s)
+{
+  fputc('"', out);
+  for (; '\0' != *s; s++)
+  {
+    if (('"' == *s) || ('\\' == *s))
+    {
+      fputc('\\', out);
+    }
+    fputc(*s, out);
+  }
+  fputc('"', out);
+}
+
+void
+bench_report(FILE *out, BenchResult *result)
+{
+  double tags, cpuUs;
+
+  qsort(result->latencyUs, result->latencyCount, sizeof(*result->latencyUs), compareLatency);
+  tags = (0 == result->tags) ? 1.0 : (double)result->tags;
+  cpuUs = (result->cpuUs > result->sourceCpuUs) ? (double)(result->cpuUs - result->sourceCpuUs) : 0.0;
+
+  fprintf(out, "{\"version\":");
+  printString(out, TMR_VERSION);
+  fprintf(out, ",\"bench\":");
+  printString(out, result->bench);
+  fprintf(out, ",\"scenario\":");
+  printString(out, result->scenario);
+  fprintf(out, ",\"settings\":");
+  printString(out, result->settings);
+  fprintf(out, ",\"seconds\":%.3f,\"tags\":%llu,\"tags_per_sec\":%.0f",
+          result->elapsedUs / 1e6, (unsigned long long)result->tags,
+          (0 == result->elapsedUs) ? 0.0 : result->tags * 1e6 / result->elapsedUs);
+  fprintf(out, ",\"latency_us\":{\"samples\":%u,\"p50\":%u,\"p99\":%u,\"p999\":%u,\"max\":%u}",
+          result->latencyCount, percentile(result, 500), percentile(result, 990),
+          percentile(result, 999),
+          (0 == result->latencyCount) ? 0 : result->latencyUs[result->latencyCount - 1]);
+  fprintf(out, ",\"allocs_per_tag\":%.3f,\"cpu_us_per_tag\":%.3f,\"source_cpu_us_per_tag\":%.3f}\n",
+          result->allocs / tags, cpuUs / tags, result->sourceCpuUs / tags);
+  fflush(out);
+}
+
+void
+bench_freeResult(BenchResult *result)
+{
+  free(result->latencyUs);
+  result->latencyUs = NULL;
+  result->latencyMax = 0;
+}
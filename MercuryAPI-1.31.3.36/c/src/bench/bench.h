@@ -0,0 +1,79 @@
+/**
+ *  @file bench.h
+ *  @brief Mercury API - shared helpers of the throughput benchmarks
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * One benchmark run. The benchmark fills in the counts and the
+ * per-tag latencies, bench_report() turns them into one JSON object
+ * per line on the output, so that results of two releases can be
+ * compared with a script.
+ */
+typedef struct BenchResult
+{
+  /** Which path was measured, "serial" or "llrp" */
+  const char *bench;
+  /** Short name of the scenario, unique within the benchmark */
+  char scenario[64];
+  /** Transport or report settings the scenario ran with */
+  char settings[256];
+  /** Wall clock time the tags were counted over, microseconds */
+  uint64_t elapsedUs;
+  /** Tags delivered to the read listener */
+  uint64_t tags;
+  /** Heap allocations made while reading */
+  uint64_t allocs;
+  /** CPU time of the process while reading, microseconds */
+  uint64_t cpuUs;
+  /** Part of cpuUs spent producing the input, not in the API */
+  uint64_t sourceCpuUs;
+  /** Frame receipt to listener callback, one entry per sampled tag */
+  uint32_t *latencyUs;
+  uint32_t latencyCount;
+  uint32_t latencyMax;
+} BenchResult;
+
+/* Clocks */
+uint64_t bench_nowUs(void);
+uint64_t bench_processCpuUs(void);
+uint64_t bench_threadCpuUs(void);
+
+/* Heap allocations since start, counted by the --wrap'd allocator */
+uint64_t bench_allocations(void);
+
+/* Result collection */
+int bench_initResult(BenchResult *result, const char *bench, uint32_t maxSamples);
+void bench_resetResult(BenchResult *result);
+void bench_addLatency(BenchResult *result, uint64_t us);
+void bench_report(FILE *out, BenchResult *result);
+void bench_freeResult(BenchResult *result);
+
+#endif /* _BENCH_H */
@@ -0,0 +1,224 @@
+/**
+ * Cross-check and benchmark of tm_crc(), the serial message CRC.
+ * The 256-entry table version must agree with the nibble-at-a-time
+ * version it replaced on every buffer tried; the program fails if it
+ * does not, before timing anything. Then both are timed on frames of
+ * typical and maximum length. Prints one JSON object per scenario, in
+ * which "tags" are frames.
+ * @file crcbench.c
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "tmr_crc.h"
+#include "bench.h"
+
+#define usage() {errx(1, "Usage: crcbench [-n buffers] [-o file]\n"\
+                         "Checks tm_crc() against the nibble implementation on -n\n"\
+                         "random buffers (default 1000000), then times both.\n");}
+
+/* Frames timed per scenario */
+#define FRAMES 2000000
+
+static BenchResult result;
+
+void errx(int exitval, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+
+  exit(exitval);
+}
+
+/*
+ * The implementation tm_crc() replaced, as it was in serial_reader_l3.c:
+ * two 16-entry lookups per byte.
+ */
+static uint16_t nibbletable[] =
+{
+  0x0000, 0x1021, 0x2042, 0x3063,
+  0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b,
+  0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+static uint16_t
+nibble_crc(const uint8_t *u8Buf, uint32_t len)
+{
+  uint16_t crc;
+  uint32_t i;
+
+  crc = 0xffff;
+
+  for (i = 0; i < len ; i++)
+  {
+    crc = ((crc << 4) | (u8Buf[i] >> 4))  ^ nibbletable[crc >> 12];
+    crc = ((crc << 4) | (u8Buf[i] & 0xf)) ^ nibbletable[crc >> 12];
+  }
+
+  return crc;
+}
+
+/* xorshift32, so that a failure can be reproduced */
+static uint32_t
+nextRandom(uint32_t *state)
+{
+  uint32_t x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static void
+crossCheck(uint32_t buffers)
+{
+  uint8_t buf[256];
+  uint32_t seed, n, i, len;
+
+  /* Every length a frame can have, all zeros and all ones */
+  for (len = 0; len < sizeof(buf); len++)
+  {
+    memset(buf, 0x00, len);
+    if (nibble_crc(buf, len) != tm_crc(buf, len))
+    {
+      errx(1, "tm_crc() differs on %u zero bytes\n", len);
+    }
+    memset(buf, 0xFF, len);
+    if (nibble_crc(buf, len) != tm_crc(buf, len))
+    {
+      errx(1, "tm_crc() differs on %u 0xFF bytes\n", len);
+    }
+  }
+
+  seed = 0x2545F491;
+  for (n = 0; n < buffers; n++)
+  {
+    len = nextRandom(&seed) % sizeof(buf);
+    for (i = 0; i < len; i++)
+    {
+      buf[i] = (uint8_t)nextRandom(&seed);
+    }
+    if (nibble_crc(buf, len) != tm_crc(buf, len))
+    {
+      errx(1, "tm_crc() differs on random buffer %u, %u bytes: %04x, expected %04x\n",
+           n, len, tm_crc(buf, len), nibble_crc(buf, len));
+    }
+  }
+  fprintf(stderr, "crcbench: %u random buffers and all lengths 0-255 agree\n", buffers);
+}
+
+static void
+runScenario(FILE *out, const char *name, uint16_t (*crc)(const uint8_t *, uint32_t),
+            uint32_t len)
+{
+  uint8_t buf[256];
+  uint64_t startUs, startCpuUs;
+  uint32_t seed, i;
+  volatile uint16_t sink;
+
+  bench_resetResult(&result);
+  snprintf(result.scenario, sizeof(result.scenario), "%s-%u", name, len);
+  snprintf(result.settings, sizeof(result.settings), "frames=%u&bytes=%u", FRAMES, len);
+
+  seed = 1;
+  for (i = 0; i < sizeof(buf); i++)
+  {
+    buf[i] = (uint8_t)nextRandom(&seed);
+  }
+  sink = 0;
+
+  startUs = bench_nowUs();
+  startCpuUs = bench_processCpuUs();
+  for (i = 0; i < FRAMES; i++)
+  {
+    buf[0] = (uint8_t)i;
+    sink ^= crc(buf, len);
+  }
+  result.elapsedUs = bench_nowUs() - startUs;
+  result.cpuUs = bench_processCpuUs() - startCpuUs;
+  result.tags = FRAMES;
+  (void)sink;
+
+  bench_report(out, &result);
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *out;
+  uint32_t buffers;
+  int i;
+
+  out = stdout;
+  buffers = 1000000;
+  for (i = 1; i < argc; i += 2)
+  {
+    if ((i + 1 >= argc) || ('-' != argv[i][0]))
+    {
+      usage();
+    }
+    if (0 == strcmp(argv[i], "-n"))
+    {
+      buffers = strtoul(argv[i + 1], NULL, 0);
+    }
+    else if (0 == strcmp(argv[i], "-o"))
+    {
+      out = fopen(argv[i + 1], "a");
+      if (NULL == out)
+      {
+        errx(1, "Can't open %s\n", argv[i + 1]);
+      }
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  crossCheck(buffers);
+
+  if (0 != bench_initResult(&result, "crc", 0))
+  {
+    errx(1, "Out of memory\n");
+  }
+  /* A streamed tag read is about 40 bytes; 255 is the longest frame */
+  runScenario(out, "crc-nibble", nibble_crc, 40);
+  runScenario(out, "crc-table", tm_crc, 40);
+  runScenario(out, "crc-nibble", nibble_crc, 255);
+  runScenario(out, "crc-table", tm_crc, 255);
+
+  bench_freeResult(&result);
+  if (stdout != out)
+  {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * Benchmark of API-side deduplication in TMR_readIntoArray(): repeated
+ * synchronous reads of a simulated field of distinct EPCs, 10000 by
+ * default, with read filtering on and off. The difference is the cost
+ * of the duplicate search, which a linear scan made quadratic in the
+ * tag count. Latencies are whole TMR_readIntoArray() calls.
+ * Prints one JSON object per scenario.
+ * @file dedupbench.c
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tm_reader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "bench.h"
+
+#define usage() {errx(1, "Usage: dedupbench [-n tags] [-r rounds] [-o file]\n"\
+                         "Reads a simulated field of -n distinct EPCs (default 10000)\n"\
+                         "with TMR_readIntoArray() -r times (default 20), with read\n"\
+                         "filtering on and off.\n");}
+
+/* Search time of each read; the simulator answers after it */
+#define READ_TIME_MS 10
+
+static BenchResult result;
+
+void errx(int exitval, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+
+  exit(exitval);
+}
+
+void checkerr(TMR_Reader* rp, TMR_Status ret, int exitval, const char *msg)
+{
+  if (TMR_SUCCESS != ret)
+  {
+    errx(exitval, "Error %s: %s\n", msg, TMR_strerr(rp, ret));
+  }
+}
+
+static void
+runScenario(FILE *out, TMR_Reader *rp, const char *uri, bool filter,
+            uint32_t tags, uint32_t rounds)
+{
+  TMR_Status ret;
+  TMR_TagReadData *results;
+  int32_t count;
+  uint64_t startUs, startAllocs, startCpuUs, callUs;
+  uint32_t i;
+
+  bench_resetResult(&result);
+  snprintf(result.scenario, sizeof(result.scenario), "dedup-%s-%u", filter ? "on" : "off", tags);
+  snprintf(result.settings, sizeof(result.settings), "%s", uri);
+
+  ret = TMR_paramSet(rp, TMR_PARAM_TAGREADDATA_ENABLEREADFILTER, &filter);
+  checkerr(rp, ret, 1, "setting read filtering");
+
+  startUs = bench_nowUs();
+  startAllocs = bench_allocations();
+  startCpuUs = bench_processCpuUs();
+  for (i = 0; i < rounds; i++)
+  {
+    callUs = bench_nowUs();
+    ret = TMR_readIntoArray(rp, READ_TIME_MS, &count, &results);
+    checkerr(rp, ret, 1, "reading");
+    bench_addLatency(&result, bench_nowUs() - callUs);
+    free(results);
+    if ((uint32_t)count != tags)
+    {
+      errx(1, "Read %d tags of %u\n", count, tags);
+    }
+    result.tags += count;
+  }
+  result.elapsedUs = bench_nowUs() - startUs;
+  result.allocs = bench_allocations() - startAllocs;
+  result.cpuUs = bench_processCpuUs() - startCpuUs;
+
+  bench_report(out, &result);
+}
+
+int main(int argc, char *argv[])
+{
+  TMR_Reader r, *rp;
+  TMR_Status ret;
+  TMR_Region region;
+  FILE *out;
+  uint32_t tags, rounds;
+  char uri[64], buf[64];
+  int i;
+
+  rp = &r;
+  out = stdout;
+  tags = 10000;
+  rounds = 20;
+  for (i = 1; i < argc; i += 2)
+  {
+    if ((i + 1 >= argc) || ('-' != argv[i][0]))
+    {
+      usage();
+    }
+    if (0 == strcmp(argv[i], "-n"))
+    {
+      tags = strtoul(argv[i + 1], NULL, 0);
+    }
+    else if (0 == strcmp(argv[i], "-r"))
+    {
+      rounds = strtoul(argv[i + 1], NULL, 0);
+    }
+    else if (0 == strcmp(argv[i], "-o"))
+    {
+      out = fopen(argv[i + 1], "a");
+      if (NULL == out)
+      {
+        errx(1, "Can't open %s\n", argv[i + 1]);
+      }
+    }
+    else
+    {
+      usage();
+    }
+  }
+  if ((0 == tags) || (0 == rounds))
+  {
+    usage();
+  }
+
+  /* rate=0 puts the whole field in the tag buffer on every read */
+  TMR_setSerialTransport("sim", TMR_SR_SerialTransportSimInit);
+  snprintf(uri, sizeof(uri), "sim:///?tags=%u&rate=0", tags);
+  /* TMR_create() splits the URI in place */
+  snprintf(buf, sizeof(buf), "%s", uri);
+  ret = TMR_create(rp, buf);
+  checkerr(rp, ret, 1, "creating reader");
+  ret = TMR_connect(rp);
+  checkerr(rp, ret, 1, "connecting reader");
+  region = TMR_REGION_NA;
+  ret = TMR_paramSet(rp, TMR_PARAM_REGION_ID, &region);
+  checkerr(rp, ret, 1, "setting region");
+
+  if (0 != bench_initResult(&result, "dedup", rounds))
+  {
+    errx(1, "Out of memory\n");
+  }
+  runScenario(out, rp, uri, false, tags, rounds);
+  runScenario(out, rp, uri, true, tags, rounds);
+
+  TMR_destroy(rp);
+  bench_freeResult(&result);
+  if (stdout != out)
+  {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,387 @@
+/**
+ * Benchmark of the LLRP reader's tag report path: RO_ACCESS_REPORT
+ * frames from a socket, through the LTKC connection and the report
+ * decoding the parser thread does, to a read listener. There is no
+ * simulated LLRP reader to connect to, so the reports come from a
+ * writer thread on the other end of a socket pair, and the connection
+ * is set up the way TMR_LLRP_connect() sets it up.
+ * Prints one JSON object per scenario.
+ * @file llrpbench.c
+ */
+
+#include <tm_reader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "llrp_reader_imp.h"
+#include "bench.h"
+
+#define usage() {errx(1, "Usage: llrpbench [-t seconds] [-o file]\n");}
+
+#define WARMUP_US 500000
+#define MAX_LATENCY_SAMPLES (16 * 1024 * 1024)
+#define MAX_FRAME (32u * 1024u)
+
+extern bool isPerAntennaEnabled;
+
+typedef struct Scenario
+{
+  const char *name;
+  /** Tags in every RO_ACCESS_REPORT */
+  int tags;
+  /** Keep plain reports raw, as TMR_LLRP_FAST_REPORT_DECODE does */
+  int raw;
+} Scenario;
+
+static TMR_Reader reader;
+static uint8_t frame[MAX_FRAME];
+static uint32_t frameLength;
+static int sockets[2];
+static volatile int running;
+static volatile int measuring;
+static volatile uint64_t tagCount;
+static volatile uint64_t sourceCpuUs;
+static uint64_t receiptUs;
+static int rawDecode;
+static BenchResult result;
+
+void errx(int exitval, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+
+  exit(exitval);
+}
+
+/**
+ * A report of count Gen2 tags with the metadata a reader sends by
+ * default: antenna, RSSI, channel, timestamp, seen count, PC, CRC,
+ * phase and protocol. The tag number is in the last four EPC bytes.
+ */
+static uint32_t
+buildReport(uint8_t *buf, uint32_t size, int count)
+{
+  LLRP_tSRO_ACCESS_REPORT *report;
+  LLRP_tSFrameEncoder *encoder;
+  uint32_t length;
+  int i;
+
+  report = LLRP_RO_ACCESS_REPORT_construct();
+  for (i = 0; i < count; i++)
+  {
+    LLRP_tSTagReportData *trd = LLRP_TagReportData_construct();
+    LLRP_tSEPC_96 *epc = LLRP_EPC_96_construct();
+    LLRP_tSAntennaID *antenna = LLRP_AntennaID_construct();
+    LLRP_tSPeakRSSI *rssi = LLRP_PeakRSSI_construct();
+    LLRP_tSChannelIndex *channel = LLRP_ChannelIndex_construct();
+    LLRP_tSLastSeenTimestampUTC *timestamp = LLRP_LastSeenTimestampUTC_construct();
+    LLRP_tSTagSeenCount *seen = LLRP_TagSeenCount_construct();
+    LLRP_tSROSpecID *roSpec = LLRP_ROSpecID_construct();
+    LLRP_tSC1G2_PC *pc = LLRP_C1G2_PC_construct();
+    LLRP_tSC1G2_CRC *crc = LLRP_C1G2_CRC_construct();
+    LLRP_tSThingMagicRFPhase *phase = LLRP_ThingMagicRFPhase_construct();
+    LLRP_tSThingMagicCustomProtocolID *protocol = LLRP_ThingMagicCustomProtocolID_construct();
+
+    memset(epc->EPC.aValue, 0, 12);
+    epc->EPC.aValue[0] = 0xE2;
+    epc->EPC.aValue[10] = (uint8_t)(i >> 8);
+    epc->EPC.aValue[11] = (uint8_t)i;
+    LLRP_TagReportData_setEPCParameter(trd, &epc->hdr);
+    LLRP_AntennaID_setAntennaID(antenna, 1 + i % 4);
+    LLRP_TagReportData_setAntennaID(trd, antenna);
+    LLRP_PeakRSSI_setPeakRSSI(rssi, -40 - i % 30);
+    LLRP_TagReportData_setPeakRSSI(trd, rssi);
+    LLRP_ChannelIndex_setChannelIndex(channel, 1 + i % 50);
+    LLRP_TagReportData_setChannelIndex(trd, channel);
+    LLRP_LastSeenTimestampUTC_setMicroseconds(timestamp, 1700000000000000ull + 1000ull * i);
+    LLRP_TagReportData_setLastSeenTimestampUTC(trd, timestamp);
+    LLRP_TagSeenCount_setTagCount(seen, 1);
+    LLRP_TagReportData_setTagSeenCount(trd, seen);
+    LLRP_ROSpecID_setROSpecID(roSpec, 1);
+    LLRP_TagReportData_setROSpecID(trd, roSpec);
+    LLRP_C1G2_PC_setPC_Bits(pc, 0x3000);
+    LLRP_TagReportData_addAirProtocolTagData(trd, &pc->hdr);
+    LLRP_C1G2_CRC_setCRC(crc, 0x1234);
+    LLRP_TagReportData_addAirProtocolTagData(trd, &crc->hdr);
+    LLRP_ThingMagicRFPhase_setPhase(phase, i % 180);
+    LLRP_TagReportData_addCustom(trd, &phase->hdr);
+    LLRP_ThingMagicCustomProtocolID_setProtocolId(protocol, LLRP_ThingMagicCustomProtocol_Gen2);
+    LLRP_TagReportData_addCustom(trd, &protocol->hdr);
+    LLRP_RO_ACCESS_REPORT_addTagReportData(report, trd);
+  }
+
+  encoder = LLRP_FrameEncoder_construct(buf, size);
+  LLRP_Encoder_encodeElement(&encoder->encoderHdr, &report->hdr.elementHdr);
+  length = (LLRP_RC_OK == encoder->encoderHdr.ErrorDetails.eResultCode) ? encoder->iNext : 0;
+  LLRP_Encoder_destruct(&encoder->encoderHdr);
+  LLRP_Element_destruct(&report->hdr.elementHdr);
+  return length;
+}
+
+/** Reader state the report decoding depends on, as after connecting */
+static void
+setupReader(void)
+{
+  static uint32_t frequencies[50];
+  int i;
+
+  memset(&reader, 0, sizeof(reader));
+  reader.readerType = TMR_READER_TYPE_LLRP;
+  for (i = 0; i < 50; i++)
+  {
+    frequencies[i] = 902750 + 500 * i;
+  }
+  reader.u.llrpReader.capabilities.freqTable.list = frequencies;
+  reader.u.llrpReader.capabilities.freqTable.len = 50;
+  strcpy(reader.u.llrpReader.capabilities.softwareVersion, "5.3.2.97");
+  reader.u.llrpReader.readPlanProtocol[1].rospecProtocol = TMR_TAG_PROTOCOL_GEN2;
+  reader.u.llrpReader.metadata = TMR_TRD_METADATA_FLAG_ALL & ~TMR_TRD_METADATA_FLAG_DATA;
+  isPerAntennaEnabled = true;
+}
+
+/** Timestamp every frame as it completes, before it is decoded */
+static int
+receiptFilter(void *context, const unsigned char *pFrame, unsigned int nFrame)
+{
+  receiptUs = bench_nowUs();
+  return rawDecode ? TMR_LLRP_isPlainTagReport(context, pFrame, nFrame) : 0;
+}
+
+static void
+callback(TMR_Reader *rp, const TMR_TagReadData *t, void *cookie)
+{
+  __atomic_add_fetch(&tagCount, 1, __ATOMIC_RELAXED);
+  if (measuring)
+  {
+    bench_addLatency(&result, bench_nowUs() - receiptUs);
+  }
+}
+
+/** The work parse_tag_reads() does for an LLRP report */
+static void
+parseReport(LLRP_tSMessage *pMsg)
+{
+  LLRP_tSRO_ACCESS_REPORT *pReport;
+  LLRP_tSTagReportData *pTagReportData;
+  uint32_t offset;
+
+  pReport = (LLRP_tSRO_ACCESS_REPORT *)pMsg;
+  for (offset = TMR_LLRP_nextRawTagReport(&pReport->hdr, 0);
+       0 != offset;
+       offset = TMR_LLRP_nextRawTagReport(&pReport->hdr, offset))
+  {
+    TMR_TagReadData trd;
+    TMR_TRD_init(&trd);
+    if (TMR_SUCCESS == TMR_LLRP_parseMetadataFromFrame(&reader, &trd, &pReport->hdr, offset))
+    {
+      trd.reader = &reader;
+      callback(&reader, &trd, NULL);
+    }
+  }
+  for (pTagReportData = pReport->listTagReportData;
+       NULL != pTagReportData;
+       pTagReportData = (LLRP_tSTagReportData *)pTagReportData->hdr.pNextSubParameter)
+  {
+    TMR_TagReadData trd;
+    TMR_TRD_init(&trd);
+    if (TMR_SUCCESS == TMR_LLRP_parseMetadataFromMessage(&reader, &trd, pTagReportData))
+    {
+      trd.reader = &reader;
+      callback(&reader, &trd, NULL);
+    }
+  }
+}
+
+/** The reader's side of the socket: send the report over and over */
+static void *
+writeReports(void *arg)
+{
+  uint64_t cpu;
+  uint32_t offset;
+  ssize_t n;
+
+  while (running)
+  {
+    cpu = bench_threadCpuUs();
+    for (offset = 0; offset < frameLength; offset += n)
+    {
+      n = write(sockets[1], frame + offset, frameLength - offset);
+      if (n <= 0)
+      {
+        return NULL;
+      }
+    }
+    sourceCpuUs += bench_threadCpuUs() - cpu;
+  }
+  shutdown(sockets[1], SHUT_WR);
+  return NULL;
+}
+
+/** The API's side of the socket, the background receiver's loop */
+static void *
+receiveReports(void *arg)
+{
+  LLRP_tSConnection *pConn = arg;
+  LLRP_tSMessage *pMsg;
+
+  while (running)
+  {
+    pMsg = LLRP_Conn_recvMessage(pConn, 100);
+    if (NULL != pMsg)
+    {
+      parseReport(pMsg);
+      TMR_LLRP_freeMessage(pMsg);
+    }
+  }
+  return NULL;
+}
+
+typedef struct Snapshot
+{
+  uint64_t us, tags, allocs, cpuUs, sourceCpuUs;
+} Snapshot;
+
+static void
+snapshot(Snapshot *s)
+{
+  s->us = bench_nowUs();
+  s->tags = __atomic_load_n(&tagCount, __ATOMIC_RELAXED);
+  s->allocs = bench_allocations();
+  s->cpuUs = bench_processCpuUs();
+  s->sourceCpuUs = sourceCpuUs;
+}
+
+static void
+runScenario(FILE *out, const Scenario *scenario, uint32_t seconds)
+{
+  LLRP_tSConnection *pConn;
+  pthread_t writer, receiver;
+  Snapshot start, stop;
+  char drain[4096];
+
+  bench_resetResult(&result);
+  snprintf(result.scenario, sizeof(result.scenario), "%s", scenario->name);
+  snprintf(result.settings, sizeof(result.settings), "tags/report=%d&decode=%s",
+           scenario->tags, scenario->raw ? "raw" : "ltkc");
+  tagCount = 0;
+  sourceCpuUs = 0;
+  measuring = 0;
+  rawDecode = scenario->raw;
+
+  frameLength = buildReport(frame, sizeof(frame), scenario->tags);
+  if (0 == frameLength)
+  {
+    errx(1, "Error encoding a report of %d tags\n", scenario->tags);
+  }
+  if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sockets))
+  {
+    errx(1, "Error creating a socket pair\n");
+  }
+
+  pConn = LLRP_Conn_construct(reader.u.llrpReader.pTypeRegistry, MAX_FRAME);
+  if (NULL == pConn)
+  {
+    errx(1, "Error constructing the connection\n");
+  }
+  pConn->fd = sockets[0];
+  LLRP_Conn_setDecodeArena(pConn, TMR_LLRP_DECODE_ARENA);
+  LLRP_Conn_setRawFrameFilter(pConn, receiptFilter, NULL);
+
+  running = 1;
+  pthread_create(&writer, NULL, writeReports, NULL);
+  pthread_create(&receiver, NULL, receiveReports, pConn);
+
+  usleep(WARMUP_US);
+  snapshot(&start);
+  measuring = 1;
+  sleep(seconds);
+  measuring = 0;
+  snapshot(&stop);
+
+  running = 0;
+  /* Unblock the writer if the socket buffer is full */
+  while (read(sockets[0], drain, sizeof(drain)) > 0)
+    ;
+  pthread_join(writer, NULL);
+  pthread_join(receiver, NULL);
+  pConn->fd = -1;
+  LLRP_Conn_destruct(pConn);
+  close(sockets[0]);
+  close(sockets[1]);
+
+  result.elapsedUs = stop.us - start.us;
+  result.tags = stop.tags - start.tags;
+  result.allocs = stop.allocs - start.allocs;
+  result.cpuUs = stop.cpuUs - start.cpuUs;
+  result.sourceCpuUs = stop.sourceCpuUs - start.sourceCpuUs;
+  bench_report(out, &result);
+}
+
+int main(int argc, char *argv[])
+{
+  static const Scenario scenarios[] = {
+    {"report-1", 1, TMR_LLRP_FAST_REPORT_DECODE},
+    {"report-10", 10, TMR_LLRP_FAST_REPORT_DECODE},
+    {"report-100", 100, TMR_LLRP_FAST_REPORT_DECODE},
+    {"report-10-ltkc", 10, 0},
+  };
+  FILE *out;
+  uint32_t seconds;
+  int i;
+
+  out = stdout;
+  seconds = 5;
+  for (i = 1; i < argc; i += 2)
+  {
+    if (i + 1 >= argc)
+    {
+      usage();
+    }
+    if (0 == strcmp(argv[i], "-t"))
+    {
+      seconds = atoi(argv[i + 1]);
+    }
+    else if (0 == strcmp(argv[i], "-o"))
+    {
+      out = fopen(argv[i + 1], "a");
+      if (NULL == out)
+      {
+        errx(1, "Can't open %s\n", argv[i + 1]);
+      }
+    }
+    else
+    {
+      usage();
+    }
+  }
+  if (0 == seconds)
+  {
+    usage();
+  }
+
+  setupReader();
+  reader.u.llrpReader.pTypeRegistry = LLRP_getTheTypeRegistry();
+  LLRP_enrollTmTypesIntoRegistry(reader.u.llrpReader.pTypeRegistry);
+  if (0 != bench_initResult(&result, "llrp", MAX_LATENCY_SAMPLES))
+  {
+    errx(1, "Out of memory\n");
+  }
+
+  for (i = 0; i < (int)(sizeof(scenarios) / sizeof(scenarios[0])); i++)
+  {
+    runScenario(out, &scenarios[i], seconds);
+  }
+
+  bench_freeResult(&result);
+  if (stdout != out)
+  {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,379 @@
+/**
+ * Benchmark of the hand-over between the background reader and the
+ * parser thread on its own, without a transport: the linked list the
+ * async tag queue used to be, with a malloc'd entry and response copy
+ * per tag under a mutex and two counting semaphores, against the
+ * preallocated single-producer/single-consumer ring that replaced it,
+ * which posts a semaphore only when the other side is asleep.
+ * Prints one JSON object per scenario.
+ * @file queuebench.c
+ */
+
+/*
+ * Copyright (c) 2009 ThingMagic, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tm_reader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "bench.h"
+
+#define usage() {errx(1, "Usage: queuebench [-n entries] [-s slots] [-o file]\n"\
+                         "Hands entries from a producer to a consumer thread through\n"\
+                         "the old linked list and through the ring, -s slots deep\n"\
+                         "(default TMR_MAX_QUEUE_SLOTS).\n");}
+
+#define LOAD(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define EXCHANGE(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define FENCE()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+typedef struct ListEntry
+{
+  TMR_Queue_tagReads tagRead;
+  struct ListEntry *next;
+} ListEntry;
+
+/* Queue state of both disciplines; only one runs at a time */
+static struct
+{
+  uint32_t entries, slots;
+  sem_t length, free;
+  /* Linked list */
+  pthread_mutex_t lock;
+  ListEntry *head, *tail;
+  /* Ring */
+  TMR_Queue_tagReads *ring;
+  uint8_t *buffers;
+  volatile uint32_t ringHead, ringTail;
+  volatile uint32_t consumerIdle, producerBlocked;
+} q;
+
+/* What the background reader copies out of bufResponse for each tag */
+static uint8_t response[TMR_SR_MAX_PACKET_SIZE];
+static BenchResult result;
+
+void errx(int exitval, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+
+  exit(exitval);
+}
+
+/* Fill in an entry the way process_async_response() does */
+static void
+produce(TMR_Queue_tagReads *tagRead, uint32_t sequence)
+{
+  memcpy(tagRead->tagEntry.sMsg, response, TMR_SR_MAX_PACKET_SIZE);
+  memcpy(tagRead->tagEntry.sMsg + 8, &sequence, sizeof(sequence));
+  tagRead->bufPointer = 10;
+  tagRead->isStatusResponse = false;
+  TMR_TRD_init(&tagRead->trd);
+  tagRead->queuedUs = bench_nowUs();
+}
+
+/* Take an entry over, checking that it is the one expected next */
+static void
+consume(TMR_Queue_tagReads *tagRead, uint32_t sequence)
+{
+  uint32_t got;
+
+  memcpy(&got, tagRead->tagEntry.sMsg + 8, sizeof(got));
+  if (got != sequence)
+  {
+    errx(1, "Entry %u arrived as %u\n", sequence, got);
+  }
+  bench_addLatency(&result, bench_nowUs() - tagRead->queuedUs);
+}
+
+static void *
+listConsumer(void *arg)
+{
+  ListEntry *entry;
+  uint32_t i;
+
+  for (i = 0; i < q.entries; i++)
+  {
+    sem_wait(&q.length);
+    pthread_mutex_lock(&q.lock);
+    entry = q.head;
+    q.head = entry->next;
+    pthread_mutex_unlock(&q.lock);
+
+    consume(&entry->tagRead, i);
+    free(entry->tagRead.tagEntry.sMsg);
+    free(entry);
+    sem_post(&q.free);
+  }
+  return NULL;
+}
+
+static void
+listProducer(void)
+{
+  ListEntry *entry;
+  uint32_t i;
+
+  for (i = 0; i < q.entries; i++)
+  {
+    sem_wait(&q.free);
+    entry = malloc(sizeof(*entry));
+    if (NULL == entry)
+    {
+      errx(1, "Out of memory\n");
+    }
+    entry->tagRead.tagEntry.sMsg = malloc(TMR_SR_MAX_PACKET_SIZE);
+    if (NULL == entry->tagRead.tagEntry.sMsg)
+    {
+      errx(1, "Out of memory\n");
+    }
+    produce(&entry->tagRead, i);
+
+    pthread_mutex_lock(&q.lock);
+    entry->next = NULL;
+    if (NULL == q.head)
+    {
+      q.head = entry;
+    }
+    else
+    {
+      q.tail->next = entry;
+    }
+    q.tail = entry;
+    pthread_mutex_unlock(&q.lock);
+    sem_post(&q.length);
+  }
+}
+
+static void
+listSetup(void)
+{
+  pthread_mutex_init(&q.lock, NULL);
+  q.head = q.tail = NULL;
+  sem_init(&q.length, 0, 0);
+  sem_init(&q.free, 0, q.slots);
+}
+
+static void
+listTeardown(void)
+{
+  pthread_mutex_destroy(&q.lock);
+  sem_destroy(&q.length);
+  sem_destroy(&q.free);
+}
+
+static uint32_t
+ringNext(uint32_t index)
+{
+  index++;
+  return (index == q.slots + 1) ? 0 : index;
+}
+
+/* Same protocol as acquire_head()/release_head() in tm_reader_async.c */
+static void *
+ringConsumer(void *arg)
+{
+  uint32_t i, head;
+
+  for (i = 0; i < q.entries; i++)
+  {
+    head = q.ringHead;
+    while (head == LOAD(&q.ringTail))
+    {
+      EXCHANGE(&q.consumerIdle, 1);
+      if (head == LOAD(&q.ringTail))
+      {
+        sem_wait(&q.length);
+      }
+      STORE(&q.consumerIdle, 0);
+    }
+
+    consume(&q.ring[head], i);
+
+    STORE(&q.ringHead, ringNext(head));
+    FENCE();
+    if (EXCHANGE(&q.producerBlocked, 0))
+    {
+      sem_post(&q.free);
+    }
+  }
+  return NULL;
+}
+
+/* Same protocol as acquire_tail()/publish_tail() in tm_reader_async.c */
+static void
+ringProducer(void)
+{
+  uint32_t i, tail, next;
+
+  for (i = 0; i < q.entries; i++)
+  {
+    tail = q.ringTail;
+    next = ringNext(tail);
+    while (next == LOAD(&q.ringHead))
+    {
+      EXCHANGE(&q.producerBlocked, 1);
+      if (next == LOAD(&q.ringHead))
+      {
+        sem_wait(&q.free);
+      }
+      STORE(&q.producerBlocked, 0);
+    }
+
+    produce(&q.ring[tail], i);
+
+    STORE(&q.ringTail, next);
+    FENCE();
+    if (EXCHANGE(&q.consumerIdle, 0))
+    {
+      sem_post(&q.length);
+    }
+  }
+}
+
+static void
+ringSetup(void)
+{
+  uint32_t i;
+
+  q.ring = calloc(q.slots + 1, sizeof(*q.ring));
+  q.buffers = malloc((q.slots + 1) * TMR_SR_MAX_PACKET_SIZE);
+  if ((NULL == q.ring) || (NULL == q.buffers))
+  {
+    errx(1, "Out of memory\n");
+  }
+  for (i = 0; i <= q.slots; i++)
+  {
+    q.ring[i].tagEntry.sMsg = q.buffers + (i * TMR_SR_MAX_PACKET_SIZE);
+  }
+  q.ringHead = q.ringTail = 0;
+  q.consumerIdle = q.producerBlocked = 0;
+  sem_init(&q.length, 0, 0);
+  sem_init(&q.free, 0, 0);
+}
+
+static void
+ringTeardown(void)
+{
+  sem_destroy(&q.length);
+  sem_destroy(&q.free);
+  free(q.buffers);
+  free(q.ring);
+}
+
+static void
+runScenario(FILE *out, const char *name, void (*setup)(void),
+            void *(*consumer)(void *), void (*producer)(void), void (*teardown)(void))
+{
+  pthread_t thread;
+  uint64_t startUs, startAllocs, startCpuUs;
+
+  bench_resetResult(&result);
+  snprintf(result.scenario, sizeof(result.scenario), "%s", name);
+  snprintf(result.settings, sizeof(result.settings), "entries=%u&slots=%u", q.entries, q.slots);
+
+  setup();
+  startUs = bench_nowUs();
+  startAllocs = bench_allocations();
+  startCpuUs = bench_processCpuUs();
+  if (0 != pthread_create(&thread, NULL, consumer, NULL))
+  {
+    errx(1, "Can't create the consumer thread\n");
+  }
+  producer();
+  pthread_join(thread, NULL);
+  result.elapsedUs = bench_nowUs() - startUs;
+  result.allocs = bench_allocations() - startAllocs;
+  result.cpuUs = bench_processCpuUs() - startCpuUs;
+  result.tags = q.entries;
+  teardown();
+
+  bench_report(out, &result);
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *out;
+  int i;
+
+  out = stdout;
+  q.entries = 2000000;
+  q.slots = TMR_MAX_QUEUE_SLOTS;
+  for (i = 1; i < argc; i += 2)
+  {
+    if ((i + 1 >= argc) || ('-' != argv[i][0]))
+    {
+      usage();
+    }
+    if (0 == strcmp(argv[i], "-n"))
+    {
+      q.entries = strtoul(argv[i + 1], NULL, 0);
+    }
+    else if (0 == strcmp(argv[i], "-s"))
+    {
+      q.slots = strtoul(argv[i + 1], NULL, 0);
+    }
+    else if (0 == strcmp(argv[i], "-o"))
+    {
+      out = fopen(argv[i + 1], "a");
+      if (NULL == out)
+      {
+        errx(1, "Can't open %s\n", argv[i + 1]);
+      }
+    }
+    else
+    {
+      usage();
+    }
+  }
+  if ((0 == q.entries) || (0 == q.slots))
+  {
+    usage();
+  }
+
+  /* A streamed tag read: FF LEN 22 0000 10 ... */
+  memset(response, 0, sizeof(response));
+  response[0] = 0xFF;
+  response[1] = 0x1C;
+  response[2] = 0x22;
+  response[5] = 0x10;
+
+  if (0 != bench_initResult(&result, "queue", q.entries))
+  {
+    errx(1, "Out of memory\n");
+  }
+  runScenario(out, "queue-list", listSetup, listConsumer, listProducer, listTeardown);
+  runScenario(out, "queue-ring", ringSetup, ringConsumer, ringProducer, ringTeardown);
+
+  bench_freeResult(&result);
+  if (stdout != out)
+  {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,444 @@
+/**
+ * Benchmark of the serial reader's continuous reading path: streamed
+ * tag frames from a simulated or replayed module, through the
+ * background receiver and parser threads, to the read listener.
+ * Prints one JSON object per scenario, and fails if the steady state
+ * allocated memory. Then stops and starts reading again a few times,
+ * timing the stops, and fails if any cycle reports an error.
+ * @file serialbench.c
+ */
+
+#include <tm_reader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+
+#define usage() {errx(1, "Usage: serialbench [-t seconds] [-o file] [-b baud[,baud...]] [uri ...]\n"\
+                         "Without a URI, runs the simulator at 10000, 50000 and unlimited tags/sec.\n"\
+                         "With -b, runs every URI at each baud rate; without a URI, a simulator\n"\
+                         "whose streaming is limited by the baud rate.\n"\
+                         "Supported URIs are sim:///?settings, replay:///path/to/recording\n"\
+                         "and tmr:///dev/ttyUSB0 (or any other serial device)\n");}
+#define MAX_BAUD_RATES 16
+
+/* Frame receipts not yet matched by the listener, oldest first */
+#define RECEIPTS 65536
+#define WARMUP_US 500000
+#define MAX_LATENCY_SAMPLES (16 * 1024 * 1024)
+/* Start/stop cycles after the timed run, and how long each one reads */
+#define RESTART_CYCLES 10
+#define RESTART_READ_US 200000
+
+typedef struct Receipt
+{
+  uint32_t tag;
+  uint64_t us;
+} Receipt;
+
+static TMR_Status (*innerReceiveBytes)(TMR_SR_SerialTransport *this, uint32_t length,
+                                       uint32_t* messageLength, uint8_t* message,
+                                       const uint32_t timeoutMs);
+static Receipt receipts[RECEIPTS];
+static uint32_t receiptHead, receiptTail;
+static uint8_t frame[TMR_SR_MAX_PACKET_SIZE];
+static uint32_t frameLength;
+static volatile uint64_t sourceCpuUs;
+static volatile uint64_t tagCount;
+static volatile int measuring;
+static volatile uint32_t exceptionCount;
+static BenchResult result;
+
+void errx(int exitval, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+
+  exit(exitval);
+}
+
+void checkerr(TMR_Reader* rp, TMR_Status ret, int exitval, const char *msg)
+{
+  if (TMR_SUCCESS != ret)
+  {
+    errx(exitval, "Error %s: %s\n", msg, TMR_strerr(rp, ret));
+  }
+}
+
+/**
+ * Tag number of a complete streamed read, FF LEN 22 0000 10 ... 01
+ * <metadata> <PC> <EPC> <tag CRC> <CRC>: the last four EPC bytes,
+ * which is where the simulator puts it.
+ */
+static void
+noteFrame(uint64_t now)
+{
+  uint32_t head, end;
+
+  end = frameLength;
+  if ((0x22 != frame[2]) || (0x10 != frame[5]) || (end < 18))
+  {
+    return;
+  }
+  head = __atomic_load_n(&receiptHead, __ATOMIC_RELAXED);
+  if (head - __atomic_load_n(&receiptTail, __ATOMIC_ACQUIRE) == RECEIPTS)
+  {
+    return;
+  }
+  receipts[head % RECEIPTS].tag = ((uint32_t)frame[end - 8] << 24) | ((uint32_t)frame[end - 7] << 16)
+    | ((uint32_t)frame[end - 6] << 8) | frame[end - 5];
+  receipts[head % RECEIPTS].us = now;
+  __atomic_store_n(&receiptHead, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Receive through the wrapped transport, timestamping every tag frame
+ * as its last byte arrives. The CPU time the transport itself takes,
+ * simulating or replaying, is kept apart from the API's.
+ */
+static TMR_Status
+timedReceiveBytes(TMR_SR_SerialTransport *this, uint32_t length,
+                  uint32_t* messageLength, uint8_t* message, const uint32_t timeoutMs)
+{
+  TMR_Status ret;
+  uint64_t cpu, now;
+  uint32_t i;
+
+  cpu = bench_threadCpuUs();
+  ret = innerReceiveBytes(this, length, messageLength, message, timeoutMs);
+  sourceCpuUs += bench_threadCpuUs() - cpu;
+
+  now = bench_nowUs();
+  for (i = 0; i < *messageLength; i++)
+  {
+    if ((0 == frameLength) && (0xFF != message[i]))
+    {
+      continue;
+    }
+    frame[frameLength++] = message[i];
+    if ((frameLength >= 2) && (frameLength == (uint32_t)frame[1] + 7))
+    {
+      noteFrame(now);
+      frameLength = 0;
+    }
+  }
+  return ret;
+}
+
+static TMR_Status
+wrapTransport(TMR_SR_SerialTransport *transport, TMR_Status ret)
+{
+  if (TMR_SUCCESS == ret)
+  {
+    innerReceiveBytes = transport->receiveBytes;
+    transport->receiveBytes = timedReceiveBytes;
+  }
+  frameLength = 0;
+  return ret;
+}
+
+static TMR_Status
+simInit(TMR_SR_SerialTransport *transport, TMR_SR_SerialPortNativeContext *context, const char *device)
+{
+  return wrapTransport(transport, TMR_SR_SerialTransportSimInit(transport, context, device));
+}
+
+static TMR_Status
+replayInit(TMR_SR_SerialTransport *transport, TMR_SR_SerialPortNativeContext *context, const char *device)
+{
+  return wrapTransport(transport, TMR_SR_SerialTransportReplayInit(transport, context, device));
+}
+
+/** Match the read with the oldest receipt of the same tag */
+static void
+callback(TMR_Reader *reader, const TMR_TagReadData *t, void *cookie)
+{
+  const uint8_t *epc;
+  uint32_t tag, tail;
+  uint64_t now;
+
+  now = bench_nowUs();
+  __atomic_add_fetch(&tagCount, 1, __ATOMIC_RELAXED);
+  if (t->tag.epcByteCount < 4)
+  {
+    return;
+  }
+
+  epc = &t->tag.epc[t->tag.epcByteCount - 4];
+  tag = ((uint32_t)epc[0] << 24) | ((uint32_t)epc[1] << 16) | ((uint32_t)epc[2] << 8) | epc[3];
+  tail = __atomic_load_n(&receiptTail, __ATOMIC_RELAXED);
+  while (tail != __atomic_load_n(&receiptHead, __ATOMIC_ACQUIRE))
+  {
+    Receipt *r = &receipts[tail % RECEIPTS];
+
+    tail++;
+    if (r->tag == tag)
+    {
+      if (measuring)
+      {
+        bench_addLatency(&result, now - r->us);
+      }
+      break;
+    }
+  }
+  __atomic_store_n(&receiptTail, tail, __ATOMIC_RELEASE);
+}
+
+static void
+exceptionCallback(TMR_Reader *reader, TMR_Status error, void *cookie)
+{
+  __atomic_add_fetch(&exceptionCount, 1, __ATOMIC_RELAXED);
+  fprintf(stderr, "Error:%s\n", TMR_strerr(reader, error));
+}
+
+typedef struct Snapshot
+{
+  uint64_t us, tags, allocs, cpuUs, sourceCpuUs;
+} Snapshot;
+
+static void
+snapshot(Snapshot *s)
+{
+  s->us = bench_nowUs();
+  s->tags = __atomic_load_n(&tagCount, __ATOMIC_RELAXED);
+  s->allocs = bench_allocations();
+  s->cpuUs = bench_processCpuUs();
+  s->sourceCpuUs = sourceCpuUs;
+}
+
+/**
+ * Start and stop reading RESTART_CYCLES times, as "<scenario>-restart"
+ * with the TMR_stopReading() times as latencies. Nothing the module
+ * sends for one cycle may end up in the next.
+ */
+static void
+runRestarts(FILE *out, TMR_Reader *rp)
+{
+  TMR_Status ret;
+  uint64_t startUs, startTags, callUs;
+  uint32_t i;
+  char name[sizeof(result.scenario)];
+  char settings[sizeof(result.settings)];
+
+  snprintf(name, sizeof(name), "%s", result.scenario);
+  snprintf(settings, sizeof(settings), "%s", result.settings);
+  bench_resetResult(&result);
+  snprintf(result.scenario, sizeof(result.scenario), "%.55s-restart", name);
+  snprintf(result.settings, sizeof(result.settings), "%s", settings);
+  exceptionCount = 0;
+  startUs = bench_nowUs();
+  startTags = __atomic_load_n(&tagCount, __ATOMIC_RELAXED);
+  for (i = 0; i < RESTART_CYCLES; i++)
+  {
+    ret = TMR_startReading(rp);
+    checkerr(rp, ret, 1, "restarting reading");
+    usleep(RESTART_READ_US);
+    callUs = bench_nowUs();
+    ret = TMR_stopReading(rp);
+    checkerr(rp, ret, 1, "stopping reading");
+    bench_addLatency(&result, bench_nowUs() - callUs);
+  }
+  result.elapsedUs = bench_nowUs() - startUs;
+  result.tags = __atomic_load_n(&tagCount, __ATOMIC_RELAXED) - startTags;
+  bench_report(out, &result);
+
+  if (0 != exceptionCount)
+  {
+    errx(1, "%s: %u read exceptions in %u start/stop cycles\n",
+         result.scenario, exceptionCount, RESTART_CYCLES);
+  }
+}
+
+static void
+runScenario(FILE *out, const char *name, const char *uri, uint32_t baud, uint32_t seconds)
+{
+  TMR_Reader r, *rp;
+  TMR_Status ret;
+  TMR_Region region;
+  TMR_ReadListenerBlock rlb;
+  TMR_ReadExceptionListenerBlock reb;
+  Snapshot start, stop;
+  char buf[256];
+
+  rp = &r;
+  bench_resetResult(&result);
+  if (0 != baud)
+  {
+    snprintf(result.scenario, sizeof(result.scenario), "%s@%u", name, baud);
+  }
+  else
+  {
+    snprintf(result.scenario, sizeof(result.scenario), "%s", name);
+  }
+  snprintf(result.settings, sizeof(result.settings), "%s", uri);
+  receiptHead = receiptTail = 0;
+  tagCount = 0;
+  measuring = 0;
+
+  /* TMR_create() splits the URI in place */
+  snprintf(buf, sizeof(buf), "%s", uri);
+  ret = TMR_create(rp, buf);
+  checkerr(rp, ret, 1, "creating reader");
+  if (0 != baud)
+  {
+    /* Probed first, then kept for the whole run */
+    ret = TMR_paramSet(rp, TMR_PARAM_BAUDRATE, &baud);
+    checkerr(rp, ret, 1, "setting baud rate");
+  }
+  ret = TMR_connect(rp);
+  checkerr(rp, ret, 1, "connecting reader");
+
+  region = TMR_REGION_NA;
+  ret = TMR_paramSet(rp, TMR_PARAM_REGION_ID, &region);
+  checkerr(rp, ret, 1, "setting region");
+
+  rlb.listener = callback;
+  rlb.cookie = NULL;
+  reb.listener = exceptionCallback;
+  reb.cookie = NULL;
+  ret = TMR_addReadListener(rp, &rlb);
+  checkerr(rp, ret, 1, "adding read listener");
+  ret = TMR_addReadExceptionListener(rp, &reb);
+  checkerr(rp, ret, 1, "adding exception listener");
+
+  ret = TMR_startReading(rp);
+  checkerr(rp, ret, 1, "starting reading");
+
+  /* Let the threads and queues reach their steady state first */
+  usleep(WARMUP_US);
+  snapshot(&start);
+  measuring = 1;
+  sleep(seconds);
+  measuring = 0;
+  snapshot(&stop);
+
+  ret = TMR_stopReading(rp);
+  checkerr(rp, ret, 1, "stopping reading");
+
+  result.elapsedUs = stop.us - start.us;
+  result.tags = stop.tags - start.tags;
+  result.allocs = stop.allocs - start.allocs;
+  result.cpuUs = stop.cpuUs - start.cpuUs;
+  result.sourceCpuUs = stop.sourceCpuUs - start.sourceCpuUs;
+  bench_report(out, &result);
+
+  /* Once reading has started, the tag path must not touch the heap */
+  if (0 != result.allocs)
+  {
+    errx(1, "%s: %llu heap allocations while reading\n",
+         result.scenario, (unsigned long long)result.allocs);
+  }
+
+  /* A recording only holds the one run */
+  if (0 != strncmp(uri, "replay:", 7))
+  {
+    runRestarts(out, rp);
+  }
+  TMR_destroy(rp);
+}
+
+int main(int argc, char *argv[])
+{
+  static const char *defaults[][2] = {
+    {"sim-10k", "sim:///?tags=1000&rate=10000"},
+    {"sim-50k", "sim:///?tags=1000&rate=50000"},
+    {"sim-max", "sim:///?tags=1000&rate=0"},
+  };
+  static const char *wire[] = {"sim-wire", "sim:///?tags=1000&rate=0&wire=1"};
+  FILE *out;
+  uint32_t seconds;
+  uint32_t bauds[MAX_BAUD_RATES];
+  int i, j, first, baudCount;
+  char *p;
+
+  out = stdout;
+  seconds = 5;
+  baudCount = 0;
+  for (i = 1; (i < argc) && ('-' == argv[i][0]); i += 2)
+  {
+    if (i + 1 >= argc)
+    {
+      usage();
+    }
+    if (0 == strcmp(argv[i], "-t"))
+    {
+      seconds = atoi(argv[i + 1]);
+    }
+    else if (0 == strcmp(argv[i], "-b"))
+    {
+      for (p = argv[i + 1]; '\0' != *p; p += (',' == *p))
+      {
+        if (MAX_BAUD_RATES == baudCount)
+        {
+          usage();
+        }
+        bauds[baudCount] = strtoul(p, &p, 10);
+        if ((0 == bauds[baudCount++]) || (('\0' != *p) && (',' != *p)))
+        {
+          usage();
+        }
+      }
+    }
+    else if (0 == strcmp(argv[i], "-o"))
+    {
+      out = fopen(argv[i + 1], "a");
+      if (NULL == out)
+      {
+        errx(1, "Can't open %s\n", argv[i + 1]);
+      }
+    }
+    else
+    {
+      usage();
+    }
+  }
+  if (0 == seconds)
+  {
+    usage();
+  }
+
+  TMR_setSerialTransport("sim", simInit);
+  TMR_setSerialTransport("replay", replayInit);
+  if (0 != bench_initResult(&result, "serial", MAX_LATENCY_SAMPLES))
+  {
+    errx(1, "Out of memory\n");
+  }
+
+  if (0 == baudCount)
+  {
+    bauds[baudCount++] = 0;
+  }
+  first = i;
+  for (j = 0; j < baudCount; j++)
+  {
+    if (first < argc)
+    {
+      for (i = first; i < argc; i++)
+      {
+        runScenario(out, argv[i], argv[i], bauds[j], seconds);
+      }
+    }
+    else if (0 != bauds[j])
+    {
+      runScenario(out, wire[0], wire[1], bauds[j], seconds);
+    }
+    else
+    {
+      for (i = 0; i < (int)(sizeof(defaults) / sizeof(defaults[0])); i++)
+      {
+        runScenario(out, defaults[i][0], defaults[i][1], 0, seconds);
+      }
+    }
+  }
+
+  bench_freeResult(&result);
+  if (stdout != out)
+  {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * Sample program that serves the module simulator on a pseudo-terminal,
+ * so that any application can load-test against it with a plain
+ * tmr:///dev/pts/N URI instead of registering the "sim" transport.
+ * @file simulator.c
+ */
+
+#define _XOPEN_SOURCE 600
+#include <tm_reader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#define usage() {errx(1, "Please provide the simulator settings, such as:\n"\
+                         "\"?tags=1000&rate=50000&epc=12&rssi=-60&rssidev=6\"\n");}
+
+void errx(int exitval, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+
+  exit(exitval);
+}
+
+int main(int argc, char *argv[])
+{
+  TMR_SR_SerialTransport sim;
+  TMR_Status ret;
+  struct pollfd pfd;
+  uint8_t buf[TMR_SR_MAX_PACKET_SIZE];
+  uint32_t len;
+  ssize_t n;
+  int master;
+
+  if (argc > 2)
+  {
+    usage();
+  }
+
+  ret = TMR_SR_SerialTransportSimInit(&sim, NULL, (argc > 1) ? argv[1] : "");
+  if (TMR_SUCCESS != ret)
+  {
+    usage();
+  }
+  sim.open(&sim);
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if ((master < 0) || (0 != grantpt(master)) || (0 != unlockpt(master)))
+  {
+    errx(1, "Error opening a pseudo-terminal\n");
+  }
+  printf("Simulated module on tmr://%s\n", ptsname(master));
+  fflush(stdout);
+
+  pfd.fd = master;
+  pfd.events = POLLIN;
+  while (1)
+  {
+    /* Commands from the application */
+    if (poll(&pfd, 1, 0) > 0)
+    {
+      if (pfd.revents & POLLIN)
+      {
+        n = read(master, buf, sizeof(buf));
+        if (n > 0)
+        {
+          sim.sendBytes(&sim, (uint32_t)n, buf, 0);
+        }
+      }
+      else if (pfd.revents & POLLHUP)
+      {
+        /* Application went away; start over for the next one */
+        sim.open(&sim);
+        usleep(10000);
+        continue;
+      }
+    }
+
+    /* Responses and streamed tag reads, waiting at most 1 ms */
+    sim.receiveBytes(&sim, sizeof(buf), &len, buf, 1);
+    if ((len > 0) && (write(master, buf, len) < 0))
+    {
+      sim.open(&sim);
+    }
+  }
+
+  return 0;
+}
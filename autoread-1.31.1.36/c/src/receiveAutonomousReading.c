@@ -4,6 +4,7 @@
  */
 #include "receive_autonomous_reading.h"
 #include "tmr_tag_data.h"
+#include "tmr_crc.h"
 #ifndef WIN32
 #include <unistd.h>
 #endif
@@ -77,23 +78,6 @@ TMR_bytesToHex(const uint8_t *bytes, uint32_t size, char *hex)
 }
 
 
-static uint16_t
-tm_crc(uint8_t *u8Buf, uint8_t len)
-{
-  uint16_t crc;
-  int i;
-
-  crc = 0xffff;
-
-  for (i = 0; i < len ; i++)
-  {
-    crc = ((crc << 4) | (u8Buf[i] >> 4))  ^ crctable[crc >> 12];
-    crc = ((crc << 4) | (u8Buf[i] & 0xf)) ^ crctable[crc >> 12];
-  }
-
-  return crc;
-}
-
 /** Minimum number of bytes required to hold a given number of bits.
  *
  * @param bitCount  number of bits to hold
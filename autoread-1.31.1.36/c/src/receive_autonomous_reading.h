@@ -62,18 +62,6 @@ typedef struct AutonomousReading
   pthread_t autonomousBackgroundReader;
 }AutonomousReading;
 
-/*
- * ThingMagic-mutated CRC used for messages.
- * Notably, not a CCITT CRC-16, though it looks close.
- */
-uint16_t crctable[] = 
-{
-  0x0000, 0x1021, 0x2042, 0x3063,
-  0x4084, 0x50a5, 0x60c6, 0x70e7,
-  0x8108, 0x9129, 0xa14a, 0xb16b,
-  0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
-};
-
 /**
  *  Reader Stats Flag Enum
  */